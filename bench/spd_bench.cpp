@@ -0,0 +1,514 @@
+// Benchmark do pipeline de logging: buffers, formatadores e escritores.
+//
+// Uso: spd_bench [mensagens_por_producer] [max_threads]
+//
+// Cada seção roda sem pausas entre logs (ao contrário do demo em main.cpp)
+// e imprime vazão, latência de enfileiramento (p50/p99/p999) e alocações
+// por mensagem, contadas com alloc_counter.hpp.
+
+#define SPD_ALLOC_COUNTER_IMPLEMENTATION
+#include "alloc_counter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer.hpp"
+#include "lock_free_buffer.hpp"
+#include "sharded_buffer.hpp"
+#include "file_writer.hpp"
+#include "compressed_file_writer.hpp"
+#include "commit_file_writer.hpp"
+#include "binary_file_writer.hpp"
+#ifndef _WIN32
+#include "async_file_writer.hpp"
+#include "mapped_file_writer.hpp"
+#endif
+#include "formatter.hpp"
+#include "logger.hpp"
+#include "utils.hpp"
+
+namespace {
+    typedef std::chrono::steady_clock bench_clock;
+
+    /// Parâmetros comuns a todas as seções
+    struct BenchConfig {
+        size_t messages_per_producer;
+        size_t max_threads;
+    };
+
+    /// Percentis de latência em nanossegundos
+    struct LatencySummary {
+        double p50;
+        double p99;
+        double p999;
+    };
+
+    LatencySummary summarize(std::vector<uint32_t>& samples) {
+        LatencySummary summary = {0, 0, 0};
+        if (samples.empty()) {
+            return summary;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        summary.p50 = samples[samples.size() * 50 / 100];
+        summary.p99 = samples[samples.size() * 99 / 100];
+        summary.p999 = samples[std::min(samples.size() - 1, samples.size() * 999 / 1000)];
+        return summary;
+    }
+
+    double seconds_since(bench_clock::time_point start) {
+        return std::chrono::duration<double>(bench_clock::now() - start).count();
+    }
+
+    /// Buffer que descarta os registros, para medir só a formatação
+    template<typename T>
+    struct NullBuffer {
+        typedef T value_type;
+
+        bool push(T&&) { return true; }
+        bool push(const T&) { return true; }
+    };
+
+    /// Fábricas dos buffers comparados na seção de buffers
+    struct MutexBufferFactory {
+        typedef MessageBuffer type;
+        static const char* name() { return "MessageBuffer"; }
+        static type* create(size_t producers) { (void)producers; return new type(1024); }
+    };
+
+    struct LockFreeBufferFactory {
+        typedef LockFreeMessageBuffer type;
+        static const char* name() { return "LockFreeMessageBuffer"; }
+        static type* create(size_t producers) { (void)producers; return new type(1024); }
+    };
+
+    struct ShardedBufferFactory {
+        typedef ShardedMessageBuffer type;
+        static const char* name() { return "ShardedMessageBuffer"; }
+        static type* create(size_t producers) { return new type(producers, 1024 / producers + 1); }
+    };
+
+    /**
+     * @brief Mede um buffer com N producers e M consumers em velocidade máxima
+     */
+    template<typename Factory>
+    void bench_buffer(const BenchConfig& config, size_t producers, size_t consumers) {
+        typedef typename Factory::type Buffer;
+
+        std::unique_ptr<Buffer> buffer(Factory::create(producers));
+        const std::string message(utils::info_messages[0]);
+
+        std::vector<std::vector<uint32_t> > latencies(producers);
+        std::vector<std::thread> threads;
+        std::atomic<size_t> consumed(0);
+        std::atomic<size_t> ready(0);
+        std::atomic<bool> go(false);
+
+        // Cada thread soma as alocações feitas apenas dentro do seu laço
+        std::atomic<unsigned long long> allocations(0);
+
+        for (size_t c = 0; c < consumers; ++c) {
+            threads.push_back(std::thread([&]() {
+                std::vector<std::string> batch;
+                batch.reserve(64);
+
+                unsigned long long before = alloc_counter::this_thread();
+                while (buffer->pop_batch(batch, 64) > 0) {
+                    consumed.fetch_add(batch.size(), std::memory_order_relaxed);
+                }
+                allocations.fetch_add(alloc_counter::this_thread() - before);
+            }));
+        }
+
+        for (size_t p = 0; p < producers; ++p) {
+            latencies[p].reserve(config.messages_per_producer);
+            threads.push_back(std::thread([&, p]() {
+                std::vector<uint32_t>& samples = latencies[p];
+                ready.fetch_add(1);
+                while (!go.load()) {
+                    std::this_thread::yield();
+                }
+
+                unsigned long long allocations_before = alloc_counter::this_thread();
+                for (size_t i = 0; i < config.messages_per_producer; ++i) {
+                    bench_clock::time_point before = bench_clock::now();
+                    buffer->push(message);
+                    samples.push_back(static_cast<uint32_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - before).count()));
+                }
+                allocations.fetch_add(alloc_counter::this_thread() - allocations_before);
+            }));
+        }
+
+        while (ready.load() < producers) {
+            std::this_thread::yield();
+        }
+
+        bench_clock::time_point start = bench_clock::now();
+        go.store(true);
+
+        size_t total = producers * config.messages_per_producer;
+        for (size_t i = consumers; i < threads.size(); ++i) {
+            threads[i].join();
+        }
+        while (consumed.load() < total) {
+            std::this_thread::yield();
+        }
+        double elapsed = seconds_since(start);
+
+        buffer->shutdown();
+        for (size_t i = 0; i < consumers; ++i) {
+            threads[i].join();
+        }
+
+        std::vector<uint32_t> samples;
+        samples.reserve(total);
+        for (size_t p = 0; p < producers; ++p) {
+            samples.insert(samples.end(), latencies[p].begin(), latencies[p].end());
+        }
+        LatencySummary summary = summarize(samples);
+
+        std::printf("%-24s %3zu %3zu %14.0f %10.0f %10.0f %10.0f %10.2f\n",
+                    Factory::name(), producers, consumers, total / elapsed,
+                    summary.p50, summary.p99, summary.p999,
+                    static_cast<double>(allocations.load()) / static_cast<double>(total));
+    }
+
+    template<typename Factory>
+    void bench_buffer_matrix(const BenchConfig& config) {
+        for (size_t producers = 1; producers <= config.max_threads; producers *= 2) {
+            for (size_t consumers = 1; consumers <= 2 && consumers <= config.max_threads; ++consumers) {
+                bench_buffer<Factory>(config, producers, consumers);
+            }
+        }
+    }
+
+    /**
+     * @brief Mede apenas o custo do Logger (formatação e construção do registro)
+     * @param templated Envia a mensagem como template do MessageCatalog (emit_template)
+     */
+    template<typename Record, typename Formatter>
+    void bench_logger(const BenchConfig& config, const char* name, LogLevel level = LogLevel::WARNING,
+                      bool templated = false) {
+        NullBuffer<Record> buffer;
+        Logger<NullBuffer<Record>, Formatter> logger;
+        const std::string message(utils::warning_messages[0]);
+        const MessageId message_id = MessageCatalog::shared().intern(message);
+        auto emit = [&]() {
+            if (templated) {
+                logger.emit_template(message_id, level, 1, buffer);
+            } else {
+                logger.emit(message, level, 1, buffer);
+            }
+        };
+
+        // Aquece caches de timestamp e o slab
+        for (size_t i = 0; i < 1000; ++i) {
+            emit();
+        }
+
+        unsigned long long allocations_before = alloc_counter::this_thread();
+        bench_clock::time_point start = bench_clock::now();
+
+        for (size_t i = 0; i < config.messages_per_producer; ++i) {
+            emit();
+        }
+
+        double elapsed = seconds_since(start);
+        unsigned long long allocations = alloc_counter::this_thread() - allocations_before;
+
+        std::string sample;
+        if (log_filter::enabled(level)) {
+            Formatter::format(sample, std::chrono::system_clock::now(), level, 1, message.data(), message.size());
+        }
+
+        std::printf("%-40s %12.1f %10.2f %10zu\n", name,
+                    elapsed * 1e9 / static_cast<double>(config.messages_per_producer),
+                    static_cast<double>(allocations) / static_cast<double>(config.messages_per_producer),
+                    sample.size());
+    }
+
+    /**
+     * @brief Mede Logger + MessageBuffer com vários producers, com ou sem agrupamento por thread
+     */
+    void bench_staging(const BenchConfig& config, const char* name, const StagingPolicy& staging, size_t producers) {
+        MessageBuffer buffer(1024);
+        Logger<MessageBuffer, JsonLinesFormatter> logger(staging);
+        const std::string message(utils::warning_messages[0]);
+        std::atomic<size_t> consumed(0);
+
+        std::thread consumer([&]() {
+            std::vector<std::string> batch;
+            while (buffer.pop_batch(batch, 64) > 0) {
+                consumed.fetch_add(batch.size(), std::memory_order_relaxed);
+            }
+        });
+
+        bench_clock::time_point start = bench_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.push_back(std::thread([&, p]() {
+                for (size_t i = 0; i < config.messages_per_producer; ++i) {
+                    logger.emit(message, LogLevel::WARNING, static_cast<int>(p), buffer);
+                }
+                logger.flush(buffer);
+            }));
+        }
+        for (size_t i = 0; i < threads.size(); ++i) {
+            threads[i].join();
+        }
+
+        size_t total = producers * config.messages_per_producer;
+        while (consumed.load() < total) {
+            std::this_thread::yield();
+        }
+        double elapsed = seconds_since(start);
+
+        buffer.shutdown();
+        consumer.join();
+
+        std::printf("%-40s %3zu %14.0f\n", name, producers, total / elapsed);
+    }
+
+    /**
+     * @brief Mede a vazão de um escritor com lotes já formatados
+     */
+    template<typename Writer>
+    void bench_writer(const BenchConfig& config, const char* name, Writer& writer) {
+        std::vector<std::string> batch(64);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const char* message = utils::info_messages[i % 5];
+            JsonLinesFormatter::format(batch[i], std::chrono::system_clock::now(), LogLevel::INFO, 1,
+                                       message, std::strlen(message));
+        }
+
+        size_t batch_bytes = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch_bytes += batch[i].size();
+        }
+
+        size_t batches = config.messages_per_producer / batch.size() + 1;
+        bench_clock::time_point start = bench_clock::now();
+        for (size_t i = 0; i < batches; ++i) {
+            writer.append_batch(batch);
+        }
+        writer.flush();
+        double elapsed = seconds_since(start);
+
+        double records = static_cast<double>(batches * batch.size());
+        std::printf("%-40s %14.0f %10.1f\n", name, records / elapsed,
+                    static_cast<double>(batches * batch_bytes) / elapsed / (1024.0 * 1024.0));
+    }
+
+    const char* const WRITER_OUTPUT = "spd_bench_output.jsonl";   ///< Arquivo temporário da seção de escritores
+
+    void bench_file_writer(const BenchConfig& config, const char* name, const FlushPolicy& policy) {
+        std::remove(WRITER_OUTPUT);
+        {
+            FileWriter writer(WRITER_OUTPUT, policy);
+            bench_writer(config, name, writer);
+        }
+        std::remove(WRITER_OUTPUT);
+    }
+
+    void bench_compressed_writer(const BenchConfig& config, const char* name, const FlushPolicy& policy) {
+        std::remove(WRITER_OUTPUT);
+        std::string index = std::string(WRITER_OUTPUT) + ".idx";
+        {
+            CompressedFileWriter writer(WRITER_OUTPUT, policy);
+            bench_writer(config, name, writer);
+            std::printf("%-40s %14s %9.1fx\n", "  (taxa de compressão)", "",
+                        static_cast<double>(writer.uncompressed_bytes()) / static_cast<double>(writer.compressed_bytes()));
+        }
+        std::remove(WRITER_OUTPUT);
+        std::remove(index.c_str());
+    }
+
+    /**
+     * @brief Vazão do BinaryFileWriter com lotes de LogEvent (nenhuma formatação em texto)
+     * @param templates Eventos de template do MessageCatalog (só o id vai para o frame)
+     */
+    void bench_binary_writer(const BenchConfig& config, const char* name, const FlushPolicy& policy, bool templates) {
+        std::vector<LogEvent> batch(64);
+        size_t text_bytes = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const char* message = utils::info_messages[i % 5];
+            batch[i].time = std::chrono::system_clock::now();
+            batch[i].producer_id = 1;
+            if (templates) {
+                batch[i].set_template(MessageCatalog::shared().intern(message), nullptr, 0);
+            } else {
+                batch[i].set_static_message(message, std::strlen(message));
+            }
+
+            std::string text;
+            JsonLinesFormatter::format(text, batch[i].time, batch[i].level, 1, message, std::strlen(message));
+            text_bytes += text.size();
+        }
+
+        std::remove(WRITER_OUTPUT);
+        {
+            BinaryFileWriter writer(WRITER_OUTPUT, policy);
+            size_t batches = config.messages_per_producer / batch.size() + 1;
+            bench_clock::time_point start = bench_clock::now();
+            for (size_t i = 0; i < batches; ++i) {
+                writer.append_batch(batch);
+            }
+            writer.flush();
+            double elapsed = seconds_since(start);
+
+            double records = static_cast<double>(batches * batch.size());
+            std::printf("%-40s %14.0f %10.1f\n", name, records / elapsed,
+                        static_cast<double>(writer.bytes_written()) / elapsed / (1024.0 * 1024.0));
+            std::printf("%-40s %14s %9.1fx\n", "  (tamanho JSONL / binário)", "",
+                        static_cast<double>(batches * text_bytes) / static_cast<double>(writer.bytes_written()));
+        }
+        std::remove(WRITER_OUTPUT);
+    }
+
+    /**
+     * @brief Vazão de threads gravando lotes ao mesmo tempo no mesmo escritor (como vários consumers)
+     */
+    template<typename Writer>
+    void bench_concurrent_writer(const BenchConfig& config, const char* name, Writer& writer, size_t threads) {
+        std::vector<std::string> batch(64);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const char* message = utils::info_messages[i % 5];
+            JsonLinesFormatter::format(batch[i], std::chrono::system_clock::now(), LogLevel::INFO, 1,
+                                       message, std::strlen(message));
+        }
+
+        size_t batches = config.messages_per_producer / batch.size() + 1;
+        bench_clock::time_point start = bench_clock::now();
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&writer, &batch, batches]() {
+                for (size_t i = 0; i < batches; ++i) {
+                    writer.append_batch(batch);
+                }
+            });
+        }
+        for (size_t t = 0; t < workers.size(); ++t) {
+            workers[t].join();
+        }
+        writer.flush();
+        double elapsed = seconds_since(start);
+
+        std::printf("%-40s %3zu %14.0f\n", name, threads, static_cast<double>(threads * batches * batch.size()) / elapsed);
+    }
+
+    void bench_shared_writers(const BenchConfig& config, size_t threads) {
+        std::remove(WRITER_OUTPUT);
+        {
+            FileWriter writer(WRITER_OUTPUT, FlushPolicy::every_bytes(1024 * 1024));
+            bench_concurrent_writer(config, "FileWriter every_bytes(1 MiB)", writer, threads);
+        }
+        std::remove(WRITER_OUTPUT);
+        {
+            CommitFileWriter writer(WRITER_OUTPUT);
+            bench_concurrent_writer(config, "CommitFileWriter", writer, threads);
+        }
+        std::remove(WRITER_OUTPUT);
+        {
+            CommitFileWriter writer(WRITER_OUTPUT,
+                CommitOptions::defaults().with_max_delay(std::chrono::milliseconds(5))
+                                         .with_timestamp_order(std::chrono::milliseconds(20)));
+            bench_concurrent_writer(config, "CommitFileWriter + timestamp_order", writer, threads);
+        }
+        std::remove(WRITER_OUTPUT);
+    }
+
+#ifndef _WIN32
+    void bench_async_writer(const BenchConfig& config, const char* name, const FlushPolicy& policy,
+                            const AsyncWriteOptions& options) {
+        std::remove(WRITER_OUTPUT);
+        {
+            AsyncFileWriter writer(WRITER_OUTPUT, policy, options);
+            bench_writer(config, name, writer);
+        }
+        std::remove(WRITER_OUTPUT);
+    }
+
+    void bench_mapped_writer(const BenchConfig& config, const char* name, const FlushPolicy& policy) {
+        std::remove(WRITER_OUTPUT);
+        {
+            MappedFileWriter writer(WRITER_OUTPUT, policy);
+            bench_writer(config, name, writer);
+        }
+        std::remove(WRITER_OUTPUT);
+    }
+#endif
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    config.messages_per_producer = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    config.max_threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    if (config.messages_per_producer == 0 || config.max_threads == 0) {
+        std::fprintf(stderr, "uso: %s [mensagens_por_producer] [max_threads]\n", argv[0]);
+        return 1;
+    }
+
+    std::printf("=== Buffers (%zu mensagens por producer) ===\n", config.messages_per_producer);
+    std::printf("%-24s %3s %3s %14s %10s %10s %10s %10s\n",
+                "buffer", "P", "C", "msgs/s", "p50 ns", "p99 ns", "p999 ns", "allocs/msg");
+    bench_buffer_matrix<MutexBufferFactory>(config);
+    bench_buffer_matrix<LockFreeBufferFactory>(config);
+    bench_buffer_matrix<ShardedBufferFactory>(config);
+
+    std::printf("\n=== Logger (uma thread) ===\n");
+    std::printf("%-40s %12s %10s %10s\n", "registro / formatador", "ns/log", "allocs/log", "bytes");
+    bench_logger<std::string, PrettyJsonFormatter>(config, "std::string / PrettyJson");
+    bench_logger<std::string, JsonLinesFormatter>(config, "std::string / JsonLines");
+    bench_logger<std::string, LogfmtFormatter>(config, "std::string / Logfmt");
+    bench_logger<std::string, BinaryFormatter>(config, "std::string / Binary");
+    bench_logger<SlabRecord, JsonLinesFormatter>(config, "SlabRecord / JsonLines");
+    bench_logger<LogEvent, JsonLinesFormatter>(config, "LogEvent (formatação adiada)");
+    bench_logger<std::string, JsonLinesFormatter>(config, "std::string / JsonLines (template)", LogLevel::WARNING, true);
+    bench_logger<LogEvent, JsonLinesFormatter>(config, "LogEvent (template)", LogLevel::WARNING, true);
+
+    LogLevel previous_level = log_filter::runtime_min_level();
+    log_filter::set_runtime_min_level(LogLevel::ERROR);
+    bench_logger<std::string, JsonLinesFormatter>(config, "WARNING filtrado em execução", LogLevel::WARNING);
+    log_filter::set_runtime_min_level(previous_level);
+
+    std::printf("\n=== Logger + MessageBuffer (1 consumer) ===\n");
+    std::printf("%-40s %3s %14s\n", "agrupamento", "P", "msgs/s");
+    for (size_t producers = 1; producers <= config.max_threads; producers *= 2) {
+        bench_staging(config, "sem agrupamento", StagingPolicy::disabled(), producers);
+        bench_staging(config, "batch(32)", StagingPolicy::batch(32), producers);
+    }
+
+    std::printf("\n=== Escritores (lotes de 64 registros JSONL) ===\n");
+    std::printf("%-40s %14s %10s\n", "escritor / política de flush", "registros/s", "MiB/s");
+    bench_file_writer(config, "every_record", FlushPolicy::every_record());
+    bench_file_writer(config, "every_bytes(1 MiB)", FlushPolicy::every_bytes(1024 * 1024));
+    bench_file_writer(config, "on_severity(ERROR) + 100 ms", FlushPolicy::on_severity().with_interval(std::chrono::milliseconds(100)));
+    if (compression::available()) {
+        bench_compressed_writer(config, "gzip frames every_bytes(1 MiB)", FlushPolicy::every_bytes(1024 * 1024));
+    }
+    bench_binary_writer(config, "binário (LogEvent) every_bytes(1 MiB)", FlushPolicy::every_bytes(1024 * 1024), false);
+    bench_binary_writer(config, "binário (template) every_bytes(1 MiB)", FlushPolicy::every_bytes(1024 * 1024), true);
+#ifndef _WIN32
+    bench_async_writer(config, "async every_bytes(1 MiB)", FlushPolicy::every_bytes(1024 * 1024),
+                       AsyncWriteOptions::defaults());
+    bench_async_writer(config, "async every_bytes(1 MiB) + O_DIRECT", FlushPolicy::every_bytes(1024 * 1024),
+                       AsyncWriteOptions::defaults().with_direct_io());
+    bench_mapped_writer(config, "mmap every_bytes(1 MiB)", FlushPolicy::every_bytes(1024 * 1024));
+#endif
+
+    std::printf("\n=== Escritor compartilhado (lotes de 64 registros por thread) ===\n");
+    std::printf("%-40s %3s %14s\n", "escritor", "C", "registros/s");
+    for (size_t threads = 1; threads <= config.max_threads; threads *= 2) {
+        bench_shared_writers(config, threads);
+    }
+
+    return 0;
+}
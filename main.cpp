@@ -11,41 +11,65 @@
 #include <iostream>
 #include <string>
 
-#include "file_writer.hpp"
+#include "indexed_file_writer.hpp"
+#include "console_writer.hpp"
+#include "tee_writer.hpp"
 #include "buffer.hpp"
+#include "memory_budget.hpp"
 #include "producer.hpp"
-#include "consumer.hpp"
+#include "consumer_pool.hpp"
+#include "metrics.hpp"
+#include "drain.hpp"
+#include "emergency_flush.hpp"
+
+typedef TeeWriter<IndexedFileWriter, ConsoleWriter> DemoWriter;    ///< Arquivo + terminal
 
 int main() {
-    MessageBuffer messageBuffer(3);
-    FileWriter fileWriter("logs.json");
+    // SIGTERM/SIGINT encerram pela drenagem abaixo; falhas gravam o que estiver nas regiões de emergência
+    emergency::install_handlers();
+
+    // Limitado pela memória: até 64 KiB entre buffer, lotes dos consumers e console
+    MemoryBudget memory(64 * 1024);
+    MessageBuffer messageBuffer(1024, OverflowPolicy::block(), &memory);
+    // Erros vão direto para o disco; o restante pode esperar até 100 ms.
+    // O índice "logs.jsonl.lidx" permite consultas com spd_query
+    IndexedFileWriter fileWriter("logs.jsonl",
+        FlushPolicy::on_severity(LogLevel::ERROR).with_interval(std::chrono::milliseconds(100)));
+    // Terminal alimentado pelos consumers, em segundo plano e com no máximo 20 registros/s
+    ConsoleWriter consoleWriter(ConsoleOptions::defaults().with_rate_limit(20));
+    DemoWriter demoWriter(fileWriter, consoleWriter);
+
+    MetricsRegistry metrics;
 
     // Instanciando producers e consumers
-    Producer<MessageBuffer> producerOne(messageBuffer, 1);
-    Producer<MessageBuffer> producerTwo(messageBuffer, 2);
+    Producer<MessageBuffer, JsonLinesFormatter> producerOne(messageBuffer, 1, StagingPolicy::disabled(), &metrics);
+    Producer<MessageBuffer, JsonLinesFormatter> producerTwo(messageBuffer, 2, StagingPolicy::disabled(), &metrics);
 
-    Consumer<MessageBuffer, FileWriter> consumerOne(messageBuffer, fileWriter, 6);
-    Consumer<MessageBuffer, FileWriter> consumerTwo(messageBuffer, fileWriter, 7);
+    // De 1 a 4 consumers, conforme a ocupação do buffer
+    ConsumerPool<MessageBuffer, DemoWriter> consumers(messageBuffer, demoWriter, PoolOptions::adaptive(1, 4), 6, &metrics);
 
     // Iniciando producers e consumers
     producerOne.start();
     producerTwo.start();
-    consumerOne.start();
-    consumerTwo.start();
+    consumers.start();
 
-    // Deixa sistema rodar por 10 segundos
-    std::this_thread::sleep_for(std::chrono::seconds(10));
+    // Deixa sistema rodar por 10 segundos, ou até SIGTERM/SIGINT
+    bool signaled = emergency::wait_for_shutdown(std::chrono::seconds(10));
 
-    std::cout << "\n=== Iniciando Shutdown ===" << std::endl;
-
-    messageBuffer.shutdown();
+    std::cout << "\n=== Iniciando Shutdown" << (signaled ? " (sinal recebido)" : "") << " ===" << std::endl;
 
+    // Producers param primeiro; os consumers gravam o que restou no buffer em até 2 segundos
     producerOne.stop();
     producerTwo.stop();
-    consumerOne.stop();
-    consumerTwo.stop();
 
-    fileWriter.flush();
+    std::vector<ConsumerPool<MessageBuffer, DemoWriter>*> pools(1, &consumers);
+    DrainReport report = drain_pipeline(messageBuffer, pools, demoWriter, std::chrono::seconds(2));
+
+    std::cout << "Drenagem: " << report.records_drained << " registros gravados, "
+              << report.records_left << " restantes, " << report.elapsed.count() << " ms" << std::endl;
+
+    std::cout << "\n=== Métricas ===\n" << metrics::prometheus_text(metrics.snapshot())
+              << metrics::prometheus_text(memory);
 
     std::cout << "=== Sistema Finalizado ===" << std::endl;
 
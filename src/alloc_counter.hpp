@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @brief Contador de alocações dinâmicas do processo
+ *
+ * Permite verificar que um trecho (ex: o caminho quente de Logger) não
+ * chama malloc. A contagem só acontece se, em exatamente uma unidade de
+ * compilação, o header for incluído com SPD_ALLOC_COUNTER_IMPLEMENTATION
+ * definido, o que substitui os operadores new/delete globais:
+ * @code
+ * #define SPD_ALLOC_COUNTER_IMPLEMENTATION
+ * #include "alloc_counter.hpp"
+ *
+ * unsigned long long before = alloc_counter::this_thread();
+ * logger.emit(message, LogLevel::INFO, 1, buffer);
+ * unsigned long long allocations = alloc_counter::this_thread() - before;
+ * @endcode
+ */
+namespace alloc_counter {
+    /// Total de alocações em todas as threads
+    inline std::atomic<unsigned long long>& global_count() {
+        static std::atomic<unsigned long long> count(0);
+        return count;
+    }
+
+    /// Alocações feitas pela thread atual
+    inline unsigned long long& thread_count() {
+        static thread_local unsigned long long count = 0;
+        return count;
+    }
+
+    /// Registra uma alocação (chamado pelo operator new substituído)
+    inline void record() {
+        global_count().fetch_add(1, std::memory_order_relaxed);
+        ++thread_count();
+    }
+
+    /// Obtém o total de alocações do processo desde o início
+    inline unsigned long long total() {
+        return global_count().load(std::memory_order_relaxed);
+    }
+
+    /// Obtém o total de alocações da thread atual desde o início
+    inline unsigned long long this_thread() {
+        return thread_count();
+    }
+}
+
+#ifdef SPD_ALLOC_COUNTER_IMPLEMENTATION
+
+// new/delete substituídos usam malloc/free de propósito
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    alloc_counter::record();
+
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    alloc_counter::record();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+#endif
@@ -0,0 +1,842 @@
+#pragma once
+
+#include <mutex>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <stdexcept>
+#include <iostream>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(SPD_HAVE_LIBURING)
+#include <liburing.h>
+#endif
+
+#include "log_level.hpp"
+#include "record.hpp"
+#include "flush_policy.hpp"
+
+/**
+ * @brief Configuração do AsyncFileWriter
+ *
+ * Criada com defaults() e ajustada com os métodos with_*():
+ * @code
+ * AsyncWriteOptions::defaults().with_block_size(4 << 20).with_direct_io();
+ * @endcode
+ */
+class AsyncWriteOptions {
+public:
+    static const size_t ALIGNMENT = 4096;   ///< Alinhamento de memória, offset e tamanho exigido pelo O_DIRECT
+
+    static AsyncWriteOptions defaults() {
+        return AsyncWriteOptions();
+    }
+
+    /**
+     * @brief Define o tamanho de cada bloco
+     * @param bytes Múltiplo de ALIGNMENT
+     * @throws std::invalid_argument se bytes não for múltiplo positivo de ALIGNMENT
+     */
+    AsyncWriteOptions with_block_size(size_t bytes) const {
+        if (bytes == 0 || bytes % ALIGNMENT != 0) {
+            throw std::invalid_argument("Tamanho de bloco deve ser múltiplo positivo de 4096");
+        }
+        AsyncWriteOptions options(*this);
+        options.block_bytes = bytes;
+        return options;
+    }
+
+    /**
+     * @brief Define quantos blocos podem existir ao mesmo tempo (enchendo ou em escrita)
+     * @param count Pelo menos 2 (um enchendo enquanto outro é gravado)
+     * @throws std::invalid_argument se count for menor que 2
+     */
+    AsyncWriteOptions with_max_blocks(size_t count) const {
+        if (count < 2) {
+            throw std::invalid_argument("São necessários pelo menos 2 blocos");
+        }
+        AsyncWriteOptions options(*this);
+        options.block_limit = count;
+        return options;
+    }
+
+    /**
+     * @brief Define o número de threads de escrita do backend sem io_uring
+     * @throws std::invalid_argument se count for 0
+     */
+    AsyncWriteOptions with_io_threads(size_t count) const {
+        if (count == 0) {
+            throw std::invalid_argument("É necessária pelo menos uma thread de escrita");
+        }
+        AsyncWriteOptions options(*this);
+        options.thread_count = count;
+        return options;
+    }
+
+    /**
+     * @brief Abre o arquivo com O_DIRECT, sem passar pelo page cache
+     */
+    AsyncWriteOptions with_direct_io(bool enabled = true) const {
+        AsyncWriteOptions options(*this);
+        options.direct = enabled;
+        return options;
+    }
+
+    /**
+     * @brief Desliga o io_uring mesmo quando disponível (usa o pool de threads)
+     */
+    AsyncWriteOptions without_io_uring() const {
+        AsyncWriteOptions options(*this);
+        options.uring = false;
+        return options;
+    }
+
+    size_t block_size() const { return block_bytes; }
+    size_t max_blocks() const { return block_limit; }
+    size_t io_threads() const { return thread_count; }
+    bool direct_io() const { return direct; }
+    bool io_uring() const { return uring; }
+
+private:
+    size_t block_bytes;     ///< Tamanho de cada bloco
+    size_t block_limit;     ///< Máximo de blocos alocados
+    size_t thread_count;    ///< Threads do backend de pool
+    bool direct;            ///< Usa O_DIRECT
+    bool uring;             ///< Tenta usar io_uring
+
+    AsyncWriteOptions()
+        : block_bytes(1024 * 1024),
+          block_limit(8),
+          thread_count(2),
+          direct(false),
+          uring(true) {}
+};
+
+/**
+ * @brief Escritor de arquivo com I/O assíncrono e blocos alinhados
+ *
+ * Mesma interface do FileWriter (append, append_batch, flush, close), mas
+ * os consumers apenas copiam os registros para um bloco alinhado à página;
+ * quando o bloco enche (ou a política de flush pede), ele é entregue ao
+ * backend de I/O e um bloco livre passa a receber os próximos registros.
+ * Blocos voltam para reuso quando a escrita termina.
+ *
+ * Backends:
+ * - io_uring (Linux, compilado com SPD_HAVE_LIBURING): o próprio consumer
+ *   submete a escrita e uma thread colhe as conclusões;
+ * - pool de threads com pwrite(): usado quando io_uring não está
+ *   disponível ou falha ao inicializar.
+ *
+ * Aqui "flush" pela política significa entregar o bloco parcial ao backend
+ * sem esperar; apenas flush() e close() aguardam as escritas terminarem.
+ * Um consumer só espera se todos os max_blocks blocos estiverem em escrita.
+ * Por isso o padrão entrega o bloco quando ele enche ou a cada 100 ms:
+ * com FlushPolicy::every_record() cada append() ou lote vira uma escrita
+ * de um bloco quase vazio, os blocos se esgotam e os consumers passam a
+ * esperar o disco. every_record() é a opção lenta, para quando cada
+ * registro deve sair da memória do processo assim que é aceito.
+ *
+ * Com O_DIRECT, blocos cheios são gravados diretamente; no flush de um
+ * bloco parcial pela política, só a parte alinhada é entregue e o restante
+ * é copiado para o início do próximo bloco, que começa no offset alinhado.
+ * Esse restante só vai pelo descritor comum em flush() e close(), depois
+ * que as escritas em andamento terminam e com os consumers bloqueados, e o
+ * próximo bloco o regrava com os mesmos bytes. Assim uma página nunca
+ * recebe ao mesmo tempo uma escrita comum e uma com O_DIRECT.
+ * Se o sistema de arquivos não aceitar O_DIRECT, o modo comum é usado.
+ *
+ * Disponível apenas em sistemas POSIX.
+ */
+class AsyncFileWriter {
+public:
+    /**
+     * @brief Abre o arquivo e inicia o backend de escrita
+     * @param filename Nome do arquivo de log (registros são acrescentados ao final)
+     * @param policy Quando entregar o bloco parcial ao backend (padrão: a cada 100 ms)
+     * @param options Tamanho e quantidade de blocos, backend e O_DIRECT
+     * @throws std::runtime_error se não conseguir abrir o arquivo
+     */
+    explicit AsyncFileWriter(const std::string& filename,
+                             const FlushPolicy& policy = FlushPolicy::every_interval(std::chrono::milliseconds(100)),
+                             const AsyncWriteOptions& options = AsyncWriteOptions::defaults())
+        : filename(filename),
+          flush_policy(policy),
+          options(options),
+          fd(-1),
+          direct_fd(-1),
+          current(nullptr),
+          next_offset(0),
+          submitted_end(0),
+          allocated_blocks(0),
+          in_flight(0),
+          failed(false),
+          stop_io(false),
+          uring_active(false),
+          stop_timer(false),
+          accepting(false) {
+        fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Não foi possível abrir o arquivo de log: " + filename);
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Não foi possível obter o tamanho do arquivo de log: " + filename);
+        }
+        uint64_t file_size = static_cast<uint64_t>(info.st_size);
+
+        if (options.direct_io()) {
+            open_direct();
+        }
+
+        start_backend();
+        accepting = true;
+
+        current = acquire_block();
+        submitted_end = file_size;
+        if (direct_fd >= 0) {
+            // Recomeça no último offset alinhado, preservando a cauda já gravada
+            size_t carry = static_cast<size_t>(file_size % AsyncWriteOptions::ALIGNMENT);
+            current->offset = file_size - carry;
+            current->used = carry;
+            next_offset = file_size;
+            if (carry > 0 && ::pread(fd, current->data, carry, static_cast<off_t>(current->offset)) != static_cast<ssize_t>(carry)) {
+                close();
+                throw std::runtime_error("Não foi possível ler o final do arquivo de log: " + filename);
+            }
+        } else {
+            current->offset = file_size;
+            next_offset = file_size;
+        }
+
+        if (flush_policy.interval().count() > 0) {
+            flush_thread = std::thread(&AsyncFileWriter::flush_routine, this);
+        }
+
+        std::cout << "AsyncFileWriter criado para arquivo: " << filename
+                  << " (backend: " << backend_name() << (direct_fd >= 0 ? ", O_DIRECT" : "") << ")" << std::endl;
+    }
+
+    ~AsyncFileWriter() {
+        try {
+            close();
+        } catch (const std::exception&) {
+            // Destrutor não propaga falhas de escrita
+        }
+    }
+
+    /**
+     * @brief Adiciona registro formatado ao arquivo de log
+     * @param record Registro completo, já com seu terminador
+     * @throws std::runtime_error se o arquivo foi fechado ou uma escrita anterior falhou
+     */
+    void append(const std::string& record) {
+        LogLevel level = flush_policy.uses_severity() ? level_from_text(record) : LogLevel::INFO;
+        append(record, level);
+    }
+
+    /**
+     * @brief Adiciona registro formatado cujo nível já é conhecido
+     * @param record Registro completo, já com seu terminador
+     * @param level Nível do registro, usado pela política de flush por severidade
+     */
+    void append(const std::string& record, LogLevel level) {
+        std::lock_guard<std::mutex> lock(fill_mutex);
+        write_locked(record.data(), record.size(), level);
+    }
+
+    /**
+     * @brief Adiciona um lote de registros ao arquivo de log
+     * @tparam Record Tipo do registro, acessado via append_record() e record_level()
+     * @param records Registros a serem escritos, na ordem do vetor
+     *
+     * Os registros são formatados fora da seção crítica; sob o lock há
+     * apenas a cópia para o bloco atual e, se ele encher, a submissão.
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        static thread_local std::string block;
+        block.clear();
+
+        LogLevel max_level = LogLevel::INFO;
+        for (size_t i = 0; i < records.size(); ++i) {
+            append_record(block, records[i]);
+
+            if (flush_policy.uses_severity()) {
+                LogLevel level = record_level(records[i]);
+                if (level > max_level) {
+                    max_level = level;
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(fill_mutex);
+        write_locked(block.data(), block.size(), max_level);
+    }
+
+    /**
+     * @brief Verifica se o arquivo está aberto e operacional
+     */
+    bool is_open() const {
+        std::lock_guard<std::mutex> lock(fill_mutex);
+        return accepting;
+    }
+
+    /**
+     * @brief Obtém o nome do arquivo associado a esta instância
+     */
+    const std::string& get_filename() const {
+        return filename;
+    }
+
+    /**
+     * @brief Obtém a política de flush configurada
+     */
+    const FlushPolicy& get_flush_policy() const {
+        return flush_policy;
+    }
+
+    /**
+     * @brief Indica se o O_DIRECT está em uso
+     */
+    bool uses_direct_io() const {
+        return direct_fd >= 0;
+    }
+
+    /**
+     * @brief Nome do backend em uso ("io_uring" ou "thread_pool")
+     */
+    const char* backend_name() const {
+        return uring_active ? "io_uring" : "thread_pool";
+    }
+
+    /**
+     * @brief Submete o bloco parcial e aguarda todas as escritas terminarem
+     * @throws std::runtime_error se alguma escrita falhou
+     *
+     * Os consumers esperam durante o flush: com O_DIRECT a cauda não
+     * alinhada só pode ser gravada depois das escritas em andamento.
+     */
+    void flush() {
+        {
+            std::lock_guard<std::mutex> lock(fill_mutex);
+            if (!accepting) {
+                return;
+            }
+            submit_current();
+            wait_idle();
+            write_tail();
+        }
+
+        throw_if_failed();
+    }
+
+    /**
+     * @brief Grava o que estiver pendente e fecha o arquivo
+     *
+     * Após a chamada, tentativas de escrita irão falhar com exceção.
+     * @throws std::runtime_error se alguma escrita falhou
+     */
+    void close() {
+        stop_flush_thread();
+
+        {
+            std::lock_guard<std::mutex> lock(fill_mutex);
+            if (!accepting) {
+                return;
+            }
+            submit_current();
+            wait_idle();
+            write_tail();
+            accepting = false;
+        }
+
+        stop_backend();
+
+        if (direct_fd >= 0) {
+            ::close(direct_fd);
+            direct_fd = -1;
+        }
+        ::close(fd);
+        fd = -1;
+
+        std::cout << "Arquivo de log fechado: " << filename << std::endl;
+        throw_if_failed();
+    }
+
+private:
+    /// Bloco alinhado à página com o destino de sua escrita
+    struct Block {
+        char* data;             ///< Memória alinhada a ALIGNMENT
+        size_t used;            ///< Bytes válidos
+        uint64_t offset;        ///< Offset do arquivo onde data[0] será gravado
+        size_t aligned_size;    ///< Prefixo gravado pelo descritor O_DIRECT (0 no modo comum)
+
+#if defined(SPD_HAVE_LIBURING)
+        /// Uma das (até duas) escritas do bloco em andamento no io_uring
+        struct Request {
+            Block* block;
+            int fd;
+            size_t begin;       ///< Primeiro byte ainda não gravado
+            size_t end;         ///< Fim do trecho
+        };
+        Request requests[2];
+        unsigned pending_requests;
+#endif
+
+        explicit Block(size_t size) : data(nullptr), used(0), offset(0), aligned_size(0) {
+            void* memory = nullptr;
+            if (posix_memalign(&memory, AsyncWriteOptions::ALIGNMENT, size) != 0) {
+                throw std::bad_alloc();
+            }
+            data = static_cast<char*>(memory);
+        }
+
+        ~Block() {
+            std::free(data);
+        }
+
+        Block(const Block&) = delete;
+        Block& operator=(const Block&) = delete;
+    };
+
+    std::string filename;                       ///< Nome do arquivo associado
+    const FlushPolicy flush_policy;             ///< Quando entregar o bloco parcial
+    const AsyncWriteOptions options;            ///< Configuração de blocos e backend
+
+    int fd;                                     ///< Descritor comum (e único, sem O_DIRECT)
+    int direct_fd;                              ///< Descritor O_DIRECT, ou -1
+
+    mutable std::mutex fill_mutex;              ///< Protege current, offsets e accepting
+    Block* current;                             ///< Bloco recebendo registros
+    uint64_t next_offset;                       ///< Offset do próximo byte a ser acrescentado
+    uint64_t submitted_end;                     ///< Fim do trecho já entregue ao backend
+
+    std::mutex pool_mutex;                      ///< Protege blocos livres e contagem em escrita
+    std::condition_variable pool_cv;            ///< Sinaliza bloco devolvido
+    std::vector<std::unique_ptr<Block> > blocks;   ///< Todos os blocos alocados
+    std::vector<Block*> free_blocks;            ///< Blocos prontos para reuso
+    size_t allocated_blocks;                    ///< Tamanho de blocks
+    size_t in_flight;                           ///< Blocos entregues e ainda não concluídos
+    bool failed;                                ///< Alguma escrita falhou
+    std::string failure;                        ///< Descrição da primeira falha
+
+    std::mutex queue_mutex;                     ///< Fila do pool de threads
+    std::condition_variable queue_cv;           ///< Acorda as threads de escrita
+    std::deque<Block*> queue;                   ///< Blocos aguardando escrita
+    std::vector<std::thread> io_threads;        ///< Threads do pool ou de conclusões do io_uring
+    bool stop_io;                               ///< Sinaliza fim do backend
+
+    bool uring_active;                          ///< io_uring inicializado com sucesso
+#if defined(SPD_HAVE_LIBURING)
+    struct io_uring ring;                       ///< Anel de submissão e conclusão
+    std::mutex ring_mutex;                      ///< Serializa o acesso à fila de submissão
+#endif
+
+    std::thread flush_thread;                   ///< Thread do flush periódico (se configurado)
+    std::mutex timer_mutex;                     ///< Protege stop_timer
+    std::condition_variable timer_cv;           ///< Acorda a thread de flush para encerrar
+    bool stop_timer;                            ///< Sinaliza fim da thread de flush
+
+    bool accepting;                             ///< Aceita novas escritas
+
+    void open_direct() {
+#if defined(O_DIRECT)
+        direct_fd = ::open(filename.c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC);
+#endif
+        if (direct_fd < 0) {
+            std::cout << "O_DIRECT indisponível para " << filename << ", usando escrita comum" << std::endl;
+        }
+    }
+
+    /**
+     * @brief Copia dados para os blocos, submetendo os que encherem (chamado com fill_mutex)
+     */
+    void write_locked(const char* data, size_t size, LogLevel level) {
+        if (!accepting) {
+            throw std::runtime_error("Arquivo de log foi fechado inesperadamente");
+        }
+        throw_if_failed();
+
+        size_t block_size = options.block_size();
+        while (size > 0) {
+            size_t chunk = std::min(size, block_size - current->used);
+            std::memcpy(current->data + current->used, data, chunk);
+            current->used += chunk;
+            next_offset += chunk;
+            data += chunk;
+            size -= chunk;
+
+            if (current->used == block_size) {
+                submit_current();
+            }
+        }
+
+        if (flush_policy.should_flush(static_cast<size_t>(next_offset - submitted_end), level)) {
+            submit_current();
+        }
+    }
+
+    /**
+     * @brief Entrega o bloco atual ao backend e pega outro (chamado com fill_mutex)
+     *
+     * Com O_DIRECT entrega só a parte alinhada; a cauda continua no bloco
+     * atual (ver write_tail()).
+     */
+    void submit_current() {
+        if (next_offset == submitted_end) {
+            return;
+        }
+        submitted_end = next_offset;
+
+        Block* block = current;
+        size_t carry = 0;
+        if (direct_fd >= 0) {
+            size_t aligned = block->used - block->used % AsyncWriteOptions::ALIGNMENT;
+            if (aligned == 0) {
+                return;
+            }
+            carry = block->used - aligned;
+            block->aligned_size = aligned;
+            block->used = aligned;
+        } else {
+            block->aligned_size = 0;
+        }
+
+        current = acquire_block();
+        current->offset = block->offset + block->used;
+        current->used = carry;
+        if (carry > 0) {
+            std::memcpy(current->data, block->data + block->used, carry);
+        }
+
+        dispatch(block);
+    }
+
+    /**
+     * @brief Grava pelo descritor comum a cauda não alinhada do bloco atual
+     *
+     * Chamado com fill_mutex e após wait_idle(): nenhuma escrita O_DIRECT
+     * está em andamento e nenhuma começa antes desta terminar. O bloco
+     * atual continua com a cauda e a regrava por O_DIRECT quando for entregue.
+     */
+    void write_tail() {
+        if (direct_fd < 0 || current->used == 0) {
+            return;
+        }
+
+        int error = write_fully(fd, current->data, current->used, current->offset);
+        if (error != 0) {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (!failed) {
+                failed = true;
+                failure = "Falha na escrita assíncrona de " + filename + ": " + std::strerror(error);
+            }
+        }
+    }
+
+    /**
+     * @brief Obtém um bloco livre, alocando até max_blocks (chamado com fill_mutex)
+     *
+     * Único ponto em que um consumer pode esperar: todos os blocos em escrita.
+     */
+    Block* acquire_block() {
+        std::unique_lock<std::mutex> lock(pool_mutex);
+
+        if (free_blocks.empty() && allocated_blocks < options.max_blocks()) {
+            blocks.push_back(std::unique_ptr<Block>(new Block(options.block_size())));
+            ++allocated_blocks;
+            return blocks.back().get();
+        }
+
+        pool_cv.wait(lock, [this]() { return !free_blocks.empty(); });
+        Block* block = free_blocks.back();
+        free_blocks.pop_back();
+        block->used = 0;
+        block->aligned_size = 0;
+        return block;
+    }
+
+    /**
+     * @brief Devolve um bloco cuja escrita terminou
+     * @param error errno da falha, ou 0
+     */
+    void complete(Block* block, int error) {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (error != 0 && !failed) {
+            failed = true;
+            failure = "Falha na escrita assíncrona de " + filename + ": " + std::strerror(error);
+        }
+        free_blocks.push_back(block);
+        --in_flight;
+        pool_cv.notify_all();
+    }
+
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(pool_mutex);
+        pool_cv.wait(lock, [this]() { return in_flight == 0; });
+    }
+
+    void throw_if_failed() {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (failed) {
+            throw std::runtime_error(failure);
+        }
+    }
+
+    void dispatch(Block* block) {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            ++in_flight;
+        }
+
+#if defined(SPD_HAVE_LIBURING)
+        if (uring_active) {
+            submit_uring(block);
+            return;
+        }
+#endif
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(block);
+        }
+        queue_cv.notify_one();
+    }
+
+    void start_backend() {
+#if defined(SPD_HAVE_LIBURING)
+        if (options.io_uring()) {
+            // Cada bloco usa no máximo duas entradas (parte O_DIRECT e cauda)
+            unsigned entries = 1;
+            while (entries < 2 * options.max_blocks() + 1) {
+                entries <<= 1;
+            }
+
+            if (io_uring_queue_init(entries, &ring, 0) == 0) {
+                uring_active = true;
+                io_threads.push_back(std::thread(&AsyncFileWriter::uring_completion_routine, this));
+                return;
+            }
+        }
+#endif
+
+        for (size_t i = 0; i < options.io_threads(); ++i) {
+            io_threads.push_back(std::thread(&AsyncFileWriter::pool_routine, this));
+        }
+    }
+
+    void stop_backend() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stop_io = true;
+        }
+        queue_cv.notify_all();
+
+#if defined(SPD_HAVE_LIBURING)
+        if (uring_active) {
+            // NOP sem bloco acorda a thread de conclusões para encerrar
+            std::lock_guard<std::mutex> lock(ring_mutex);
+            struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+            if (sqe != nullptr) {
+                io_uring_prep_nop(sqe);
+                io_uring_sqe_set_data(sqe, nullptr);
+                io_uring_submit(&ring);
+            }
+        }
+#endif
+
+        for (size_t i = 0; i < io_threads.size(); ++i) {
+            if (io_threads[i].joinable()) {
+                io_threads[i].join();
+            }
+        }
+        io_threads.clear();
+
+#if defined(SPD_HAVE_LIBURING)
+        if (uring_active) {
+            io_uring_queue_exit(&ring);
+            uring_active = false;
+        }
+#endif
+    }
+
+    /**
+     * @brief Grava todo o trecho com pwrite(), repetindo em escritas parciais
+     * @return 0 ou errno da falha
+     */
+    static int write_fully(int target, const char* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+            ssize_t written = ::pwrite(target, data, size, static_cast<off_t>(offset));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<uint64_t>(written);
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Rotina das threads do pool: grava blocos da fila com pwrite()
+     */
+    void pool_routine() {
+        while (true) {
+            Block* block = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [this]() { return stop_io || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                block = queue.front();
+                queue.pop_front();
+            }
+
+            int error = 0;
+            if (block->aligned_size > 0) {
+                error = write_fully(direct_fd, block->data, block->aligned_size, block->offset);
+            }
+            if (error == 0 && block->used > block->aligned_size) {
+                error = write_fully(fd, block->data + block->aligned_size, block->used - block->aligned_size,
+                                    block->offset + block->aligned_size);
+            }
+            complete(block, error);
+        }
+    }
+
+#if defined(SPD_HAVE_LIBURING)
+    /**
+     * @brief Prepara uma escrita do trecho restante de request (chamado com ring_mutex)
+     */
+    void prepare_uring_write(Block::Request* request) {
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        // O anel comporta duas entradas por bloco, então sempre há espaço
+        io_uring_prep_write(sqe, request->fd, request->block->data + request->begin,
+                            static_cast<unsigned>(request->end - request->begin),
+                            request->block->offset + request->begin);
+        io_uring_sqe_set_data(sqe, request);
+    }
+
+    void submit_uring(Block* block) {
+        unsigned count = 0;
+        if (block->aligned_size > 0) {
+            Block::Request request = {block, direct_fd, 0, block->aligned_size};
+            block->requests[count++] = request;
+        }
+        if (block->used > block->aligned_size) {
+            Block::Request request = {block, fd, block->aligned_size, block->used};
+            block->requests[count++] = request;
+        }
+        block->pending_requests = count;
+
+        std::lock_guard<std::mutex> lock(ring_mutex);
+        for (unsigned i = 0; i < count; ++i) {
+            prepare_uring_write(&block->requests[i]);
+        }
+        io_uring_submit(&ring);
+    }
+
+    /**
+     * @brief Rotina da thread de conclusões do io_uring
+     *
+     * Reenvia escritas parciais e devolve o bloco quando todas as suas
+     * escritas terminam.
+     */
+    void uring_completion_routine() {
+        while (true) {
+            struct io_uring_cqe* cqe = nullptr;
+            int status = io_uring_wait_cqe(&ring, &cqe);
+            if (status == -EINTR) {
+                continue;
+            }
+            if (status < 0) {
+                return;
+            }
+
+            Block::Request* request = static_cast<Block::Request*>(io_uring_cqe_get_data(cqe));
+            int result = cqe->res;
+            io_uring_cqe_seen(&ring, cqe);
+
+            if (request == nullptr) {
+                return;
+            }
+
+            if (result == -EINTR || result == -EAGAIN || (result > 0 && request->begin + static_cast<size_t>(result) < request->end)) {
+                if (result > 0) {
+                    request->begin += static_cast<size_t>(result);
+                }
+                std::lock_guard<std::mutex> lock(ring_mutex);
+                prepare_uring_write(request);
+                io_uring_submit(&ring);
+                continue;
+            }
+
+            Block* block = request->block;
+            int error = result < 0 ? -result : 0;
+            if (error != 0) {
+                // Registra a falha agora; o bloco volta quando a outra escrita terminar
+                std::lock_guard<std::mutex> lock(pool_mutex);
+                if (!failed) {
+                    failed = true;
+                    failure = "Falha na escrita assíncrona de " + filename + ": " + std::strerror(error);
+                }
+            }
+            if (--block->pending_requests == 0) {
+                complete(block, 0);
+            }
+        }
+    }
+#endif
+
+    /**
+     * @brief Rotina da thread de flush periódico: entrega o bloco parcial
+     */
+    void flush_routine() {
+        std::unique_lock<std::mutex> timer_lock(timer_mutex);
+
+        while (!timer_cv.wait_for(timer_lock, flush_policy.interval(), [this]() { return stop_timer; })) {
+            std::lock_guard<std::mutex> lock(fill_mutex);
+            if (accepting) {
+                submit_current();
+            }
+        }
+    }
+
+    void stop_flush_thread() {
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex);
+            stop_timer = true;
+        }
+        timer_cv.notify_all();
+
+        if (flush_thread.joinable()) {
+            flush_thread.join();
+        }
+    }
+
+    // Desabilita cópia para evitar problemas com mutex e descritores
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+};
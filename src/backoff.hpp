@@ -0,0 +1,68 @@
+#pragma once
+
+#include <thread>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Estratégia de espera progressiva para estruturas sem lock
+ *
+ * Usada quando uma operação não pode prosseguir (buffer cheio ou vazio).
+ * As primeiras tentativas apenas giram com instrução de pausa da CPU,
+ * depois cedem o processador e, por fim, dormem por curtos períodos
+ * para não consumir CPU em esperas longas.
+ */
+class Backoff {
+public:
+    Backoff() : attempts(0) {}
+
+    /**
+     * @brief Aguarda um passo, aumentando o custo da espera a cada chamada
+     */
+    void pause() {
+        if (attempts < SPIN_LIMIT) {
+            cpu_relax();
+        } else if (attempts < YIELD_LIMIT) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long>(SLEEP_MICROS)));
+            return;
+        }
+        ++attempts;
+    }
+
+    /**
+     * @brief Indica se as fases de giro e de ceder a CPU já passaram
+     *
+     * Consumers usam para trocar os sonos curtos por dormir em um
+     * EventCount até serem notificados.
+     */
+    bool exhausted() const {
+        return attempts >= YIELD_LIMIT;
+    }
+
+    /**
+     * @brief Reinicia a espera após uma operação bem-sucedida
+     */
+    void reset() {
+        attempts = 0;
+    }
+
+private:
+    static const unsigned SPIN_LIMIT = 64;      ///< Tentativas apenas girando
+    static const unsigned YIELD_LIMIT = 128;    ///< Tentativas cedendo a CPU
+    static const unsigned SLEEP_MICROS = 100;   ///< Duração de cada sono
+
+    unsigned attempts;                          ///< Tentativas desde o último reset
+
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+};
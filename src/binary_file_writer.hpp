@@ -0,0 +1,298 @@
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+
+#include "log_level.hpp"
+#include "record.hpp"
+#include "flush_policy.hpp"
+#include "binary_log.hpp"
+#include "message_catalog.hpp"
+
+/**
+ * @brief Escritor no formato binário compacto de binary_log.hpp
+ *
+ * Mesma interface do FileWriter. Cada append_batch() vira um frame com
+ * deltas de tempo em varint, nível em um byte, producer_id e mensagem com
+ * prefixo de tamanho, montado fora da seção crítica; sob o lock é feita
+ * apenas a escrita do frame. O texto legível só é gerado quando alguém
+ * lê o log, com spd_replay (tools/spd_replay.cpp) ou binary_log::Reader.
+ *
+ * O caminho mais barato é o Logger com LogEvent: os campos crus vão
+ * direto para o frame, sem formatação nenhuma no producer nem no consumer.
+ * Registros do BinaryFormatter também são lidos sem parse; registros de
+ * texto funcionam, extraindo os campos do texto.
+ *
+ * Eventos de template (Logger::emit_template) gravam só o id e os
+ * argumentos; o texto de cada template vai para um frame de dicionário
+ * antes do primeiro registro que o usa, uma vez por arquivo aberto.
+ */
+class BinaryFileWriter {
+public:
+    /**
+     * @brief Abre (ou continua) um arquivo binário de log
+     * @param filename Nome do arquivo (ex: "logs.spdb")
+     * @param policy Política de flush
+     * @throws std::runtime_error se não conseguir abrir o arquivo ou se ele
+     * existir com outro formato
+     */
+    explicit BinaryFileWriter(const std::string& filename, const FlushPolicy& policy = FlushPolicy::every_record())
+        : filename(filename),
+          flush_policy(policy),
+          base_time(binary_log::to_nanos(std::chrono::system_clock::now())),
+          pending_bytes(0),
+          records_count(0),
+          written_bytes(0),
+          stop_timer(false) {
+        bool existing = read_existing_header();
+
+        file.open(filename, std::ios::app | std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Não foi possível abrir o arquivo de log: " + filename);
+        }
+        if (!existing) {
+            std::string header = binary_log::header(base_time);
+            file.write(header.data(), static_cast<std::streamsize>(header.size()));
+            file.flush();
+        }
+
+        if (flush_policy.interval().count() > 0) {
+            flush_thread = std::thread(&BinaryFileWriter::flush_routine, this);
+        }
+
+        std::cout << "BinaryFileWriter criado para arquivo: " << filename << std::endl;
+    }
+
+    ~BinaryFileWriter() {
+        stop_flush_thread();
+
+        if (file.is_open()) {
+            file.close();
+        }
+    }
+
+    /**
+     * @brief Adiciona um registro, em um frame próprio
+     * @param record Registro formatado (BinaryFormatter, JSON ou logfmt)
+     */
+    void append(const std::string& record) {
+        append(record, flush_policy.uses_severity() ? record_level(record) : LogLevel::INFO);
+    }
+
+    /**
+     * @brief Adiciona um registro cujo nível já é conhecido, em um frame próprio
+     * @param record Registro formatado (BinaryFormatter, JSON ou logfmt)
+     * @param level Nível do registro, usado pela política de flush por severidade
+     */
+    void append(const std::string& record, LogLevel level) {
+        static thread_local std::string frame;
+        static const std::vector<uint32_t> no_templates;    // texto formatado nunca traz template
+        frame.clear();
+        binary_log::encode_frame(frame, &record, 1, base_time);
+        write_frame(frame, no_templates, 1, level);
+    }
+
+    /**
+     * @brief Codifica um lote de registros em um frame e o grava
+     * @tparam Record LogEvent, ou registro formatado com record_data()/record_size()
+     * @param records Registros do frame, na ordem do vetor
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        static thread_local std::string frame;
+        static thread_local std::vector<uint32_t> templates;
+        frame.clear();
+        templates.clear();
+        binary_log::encode_frame(frame, records.data(), records.size(), base_time, &templates);
+
+        LogLevel max_level = LogLevel::INFO;
+        if (flush_policy.uses_severity()) {
+            for (size_t i = 0; i < records.size(); ++i) {
+                LogLevel level = record_level(records[i]);
+                if (level > max_level) {
+                    max_level = level;
+                }
+            }
+        }
+
+        write_frame(frame, templates, records.size(), max_level);
+    }
+
+    bool is_open() const {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        return file.is_open();
+    }
+
+    const std::string& get_filename() const {
+        return filename;
+    }
+
+    const FlushPolicy& get_flush_policy() const {
+        return flush_policy;
+    }
+
+    /**
+     * @brief Registros gravados desde a abertura
+     */
+    uint64_t records_written() const {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        return records_count;
+    }
+
+    /**
+     * @brief Bytes de frames gravados desde a abertura (sem o cabeçalho)
+     */
+    uint64_t bytes_written() const {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        return written_bytes;
+    }
+
+    /**
+     * @brief Força flush do arquivo
+     */
+    void flush() {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        if (file.is_open()) {
+            file.flush();
+            pending_bytes = 0;
+        }
+    }
+
+    /**
+     * @brief Fecha o arquivo
+     */
+    void close() {
+        stop_flush_thread();
+
+        std::lock_guard<std::mutex> lock(write_mutex);
+        if (file.is_open()) {
+            file.close();
+            std::cout << "Arquivo de log fechado: " << filename << std::endl;
+        }
+    }
+
+private:
+    mutable std::mutex write_mutex;     ///< Protege o stream e os contadores
+
+    std::ofstream file;                 ///< Cabeçalho e frames
+    std::string filename;               ///< Nome do arquivo de log
+
+    const FlushPolicy flush_policy;     ///< Quando forçar gravação em disco
+    int64_t base_time;                  ///< Instante base do cabeçalho (ns desde a época)
+    size_t pending_bytes;               ///< Bytes escritos desde o último flush
+    uint64_t records_count;             ///< Registros gravados
+    uint64_t written_bytes;             ///< Bytes de frames gravados
+    std::vector<bool> defined;          ///< Templates já gravados no dicionário deste arquivo, por id
+
+    std::thread flush_thread;           ///< Thread do flush periódico (se configurado)
+    std::mutex timer_mutex;             ///< Protege stop_timer
+    std::condition_variable timer_cv;   ///< Acorda a thread de flush para encerrar
+    bool stop_timer;                    ///< Sinaliza fim da thread de flush
+
+    /**
+     * @brief Reaproveita o instante base de um arquivo que já existe
+     * @return false se o arquivo não existir ou estiver vazio
+     * @throws std::runtime_error se o arquivo existir com outro formato
+     */
+    bool read_existing_header() {
+        std::ifstream existing(filename, std::ios::binary);
+        if (!existing.is_open() || existing.peek() == std::char_traits<char>::eof()) {
+            return false;
+        }
+        char fixed[binary_log::FIXED_HEADER_SIZE];
+        uint16_t version = 0;
+        if (!existing.read(fixed, sizeof(fixed)) || !binary_log::parse_fixed_header(fixed, base_time, version)) {
+            throw std::runtime_error("Arquivo existente não está no formato binário: " + filename);
+        }
+        if (version != binary_log::VERSION) {
+            throw std::runtime_error("Arquivo existente usa outra versão do formato binário: " + filename);
+        }
+        return true;
+    }
+
+    void write_frame(const std::string& frame, const std::vector<uint32_t>& templates, size_t records, LogLevel level) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Arquivo de log foi fechado inesperadamente");
+        }
+        if (!templates.empty()) {
+            write_dictionary(templates);
+        }
+
+        file.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        records_count += records;
+        written_bytes += frame.size();
+
+        pending_bytes += frame.size();
+        if (flush_policy.should_flush(pending_bytes, level)) {
+            file.flush();
+            pending_bytes = 0;
+        }
+    }
+
+    /// Grava, antes do frame que os usa, os templates que este arquivo ainda não definiu
+    void write_dictionary(const std::vector<uint32_t>& templates) {
+        std::vector<const MessageTemplate*> missing;
+        for (size_t i = 0; i < templates.size(); ++i) {
+            uint32_t id = templates[i];
+            if (id < defined.size() && defined[id]) {
+                continue;
+            }
+            if (id >= defined.size()) {
+                defined.resize(id + 1, false);
+            }
+            defined[id] = true;
+            missing.push_back(MessageCatalog::shared().find(id));
+        }
+        if (missing.empty()) {
+            return;
+        }
+
+        std::string dictionary;
+        binary_log::encode_dictionary(dictionary, missing);
+        file.write(dictionary.data(), static_cast<std::streamsize>(dictionary.size()));
+        written_bytes += dictionary.size();
+        pending_bytes += dictionary.size();
+    }
+
+    void flush_routine() {
+        std::unique_lock<std::mutex> timer_lock(timer_mutex);
+
+        while (!timer_cv.wait_for(timer_lock, flush_policy.interval(), [this]() { return stop_timer; })) {
+            std::lock_guard<std::mutex> lock(write_mutex);
+            if (pending_bytes > 0 && file.is_open()) {
+                file.flush();
+                pending_bytes = 0;
+            }
+        }
+    }
+
+    void stop_flush_thread() {
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex);
+            stop_timer = true;
+        }
+        timer_cv.notify_all();
+
+        if (flush_thread.joinable()) {
+            flush_thread.join();
+        }
+    }
+
+    // Desabilita cópia para evitar problemas com mutex
+    BinaryFileWriter(const BinaryFileWriter&) = delete;
+    BinaryFileWriter& operator=(const BinaryFileWriter&) = delete;
+};
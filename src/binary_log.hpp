@@ -0,0 +1,563 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <chrono>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "log_level.hpp"
+#include "log_event.hpp"
+#include "record.hpp"
+#include "formatter.hpp"
+#include "json_escape.hpp"
+#include "message_catalog.hpp"
+
+/**
+ * @file binary_log.hpp
+ * @brief Formato binário compacto de arquivo de log (BinaryFileWriter / spd_replay)
+ *
+ * O arquivo começa com um cabeçalho e segue com frames, um por lote do
+ * consumer. Inteiros "varint" usam 7 bits por byte (LEB128); "zigzag"
+ * indica um varint com sinal. Cabeçalho:
+ * | bytes  | campo                                                     |
+ * |--------|-----------------------------------------------------------|
+ * | 4      | "SPDB"                                                    |
+ * | 2      | versão do formato (uint16, little-endian)                 |
+ * | 8      | instante base em ns desde a época (int64, little-endian)  |
+ * | varint | tamanho do esquema                                        |
+ * | N      | esquema em texto: campos de cada registro, na ordem       |
+ *
+ * Frame:
+ * | bytes  | campo                                                     |
+ * |--------|-----------------------------------------------------------|
+ * | varint | bytes do restante do frame                                |
+ * | 1      | tipo: FRAME_RECORDS ou FRAME_DICTIONARY (desde a versão 2)|
+ * | ...    | conteúdo do tipo                                          |
+ *
+ * Frame de registros:
+ * | bytes  | campo                                                     |
+ * |--------|-----------------------------------------------------------|
+ * | varint | quantidade de registros                                   |
+ * | zigzag | instante do frame, em ns a partir do instante base        |
+ * | ...    | registros                                                 |
+ *
+ * Registro:
+ * | bytes  | campo                                                     |
+ * |--------|-----------------------------------------------------------|
+ * | zigzag | ns a partir do registro anterior (ou do instante do frame)|
+ * | 1      | nível (valor de LogLevel), com TEMPLATE_FLAG se template  |
+ * | zigzag | producer_id                                               |
+ * | varint | apenas com TEMPLATE_FLAG: id do template no dicionário    |
+ * | varint | tamanho da mensagem (ou dos argumentos, com TEMPLATE_FLAG)|
+ * | N      | mensagem sem escape (ou argumentos em message_args)       |
+ *
+ * Frame de dicionário (templates do MessageCatalog):
+ * | bytes  | campo                                                     |
+ * |--------|-----------------------------------------------------------|
+ * | varint | quantidade de entradas                                    |
+ * | ...    | por entrada: varint id, varint tamanho, texto do template |
+ *
+ * Os deltas são relativos dentro de cada frame, então cada consumer monta
+ * o frame inteiro fora do lock; o prefixo de tamanho permite pular frames
+ * e detectar um frame truncado no final do arquivo. Cada template aparece
+ * no dicionário antes do primeiro registro que o usa, uma vez por arquivo
+ * aberto pelo escritor; uma entrada posterior com o mesmo id (processo
+ * novo continuando o arquivo) substitui a anterior.
+ */
+namespace binary_log {
+    static const char MAGIC[4] = {'S', 'P', 'D', 'B'};     ///< Início de todo arquivo
+    static const uint16_t VERSION = 2;                      ///< Versão gravada no cabeçalho
+    static const uint16_t MIN_VERSION = 1;                  ///< Versão mais antiga que o Reader entende
+    static const size_t FIXED_HEADER_SIZE = 4 + 2 + 8;      ///< Cabeçalho antes do esquema
+    static const unsigned char FRAME_RECORDS = 0;           ///< Frame com registros
+    static const unsigned char FRAME_DICTIONARY = 1;        ///< Frame com templates
+    static const unsigned char TEMPLATE_FLAG = 0x80;        ///< Bit do byte de nível: registro de template
+
+    /// Esquema gravado no cabeçalho (descritivo: o leitor valida pela versão)
+    inline const char* schema() {
+        return "timestamp:zigzag_delta_ns level:u8(0x80=template) producer_id:zigzag [template_id:varint] "
+               "message:varint_length+bytes; dictionary frames: id:varint text:varint_length+bytes";
+    }
+
+    /// Campos crus de um registro
+    struct RawRecord {
+        int64_t time;                       ///< ns desde a época
+        LogLevel level;                     ///< Nível
+        int producer_id;                    ///< ID do producer
+        const char* message;                ///< Mensagem sem escape (não pertence ao registro)
+        size_t message_size;                ///< Tamanho da mensagem
+        uint32_t template_id;               ///< Template do dicionário (0 = mensagem literal)
+        const char* args;                   ///< Argumentos empacotados, com template_id
+        size_t args_size;                   ///< Tamanho dos argumentos
+    };
+
+    template<typename Out>
+    void put_varint(Out& out, uint64_t value) {
+        char bytes[10];
+        size_t size = 0;
+        while (value >= 0x80) {
+            bytes[size++] = static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        bytes[size++] = static_cast<char>(value);
+        out.append(bytes, size);
+    }
+
+    template<typename Out>
+    void put_zigzag(Out& out, int64_t value) {
+        put_varint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    /**
+     * @brief Lê um varint e avança position
+     * @return false se o texto acabar antes do fim do varint
+     */
+    inline bool get_varint(const char*& position, const char* end, uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 64 && position < end; shift += 7) {
+            unsigned char byte = static_cast<unsigned char>(*position++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool get_zigzag(const char*& position, const char* end, int64_t& value) {
+        uint64_t raw = 0;
+        if (!get_varint(position, end, raw)) {
+            return false;
+        }
+        value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+        return true;
+    }
+
+    inline int64_t to_nanos(std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    inline std::chrono::system_clock::time_point from_nanos(int64_t nanos) {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanos)));
+    }
+
+    /// Cabeçalho completo de um arquivo novo
+    inline std::string header(int64_t base_time) {
+        std::string out(MAGIC, sizeof(MAGIC));
+        format_detail::append_le(out, VERSION);
+        format_detail::append_le(out, base_time);
+        const char* text = schema();
+        put_varint(out, std::strlen(text));
+        out.append(text);
+        return out;
+    }
+
+    /**
+     * @brief Lê a parte fixa do cabeçalho
+     * @param data Primeiros FIXED_HEADER_SIZE bytes do arquivo
+     * @param version Versão gravada no arquivo
+     * @return false se não for um arquivo deste formato (ou de versão desconhecida)
+     */
+    inline bool parse_fixed_header(const char* data, int64_t& base_time, uint16_t& version) {
+        if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+            return false;
+        }
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        version = static_cast<uint16_t>(bytes[4] | (bytes[5] << 8));
+        if (version < MIN_VERSION || version > VERSION) {
+            return false;
+        }
+        uint64_t base = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            base |= static_cast<uint64_t>(bytes[6 + i]) << (8 * i);
+        }
+        base_time = static_cast<int64_t>(base);
+        return true;
+    }
+
+    namespace detail {
+        /// Registro gravado pelo BinaryFormatter (prefixo de tamanho, instante, nível, producer_id, mensagem)
+        inline bool from_binary_formatter(const char* data, size_t size, RawRecord& raw) {
+            static const size_t MIN_SIZE = BinaryFormatter::HEADER_SIZE + BinaryFormatter::FIXED_FIELDS_SIZE;
+            if (size < MIN_SIZE) {
+                return false;
+            }
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+            uint64_t fields[3] = {0, 0, 0};     // tamanho, instante, producer_id
+            for (size_t i = 0; i < 4; ++i) {
+                fields[0] |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+                fields[2] |= static_cast<uint64_t>(bytes[13 + i]) << (8 * i);
+            }
+            for (size_t i = 0; i < 8; ++i) {
+                fields[1] |= static_cast<uint64_t>(bytes[4 + i]) << (8 * i);
+            }
+            if (fields[0] != size - BinaryFormatter::HEADER_SIZE || bytes[12] > static_cast<unsigned char>(LogLevel::ERROR)) {
+                return false;
+            }
+            raw.time = static_cast<int64_t>(fields[1]);
+            raw.level = static_cast<LogLevel>(bytes[12]);
+            raw.producer_id = static_cast<int32_t>(static_cast<uint32_t>(fields[2]));
+            raw.message = data + MIN_SIZE;
+            raw.message_size = size - MIN_SIZE;
+            raw.template_id = 0;
+            return true;
+        }
+
+        /// Mensagem de um registro de texto ("message": "..." ou msg="..."), sem escape
+        inline bool message_from_text(const char* text, size_t size, std::string& message) {
+            static const char json_key[] = "\"message\"";
+            static const char logfmt_key[] = "msg=";
+
+            const char* end = text + size;
+            const char* position = std::search(text, end, json_key, json_key + sizeof(json_key) - 1);
+            if (position != end) {
+                position += sizeof(json_key) - 1;
+                while (position < end && (*position == ' ' || *position == ':')) {
+                    ++position;
+                }
+            } else {
+                position = std::search(text, end, logfmt_key, logfmt_key + sizeof(logfmt_key) - 1);
+                if (position == end) {
+                    return false;
+                }
+                position += sizeof(logfmt_key) - 1;
+            }
+            if (position == end || *position != '"') {
+                return false;
+            }
+            ++position;
+            json_escape::unescape(message, position, static_cast<size_t>(end - position));
+            return true;
+        }
+    }
+
+    /// Campos de um LogEvent, lidos direto (sem formatação); templates seguem como id e argumentos
+    inline void raw_fields(const LogEvent& record, RawRecord& raw, std::string& scratch) {
+        raw.time = to_nanos(record.time);
+        raw.level = record.level;
+        raw.producer_id = record.producer_id;
+        raw.template_id = 0;
+        raw.message = record.message_data();
+        raw.message_size = record.message_size();
+
+        if (record.template_id != 0) {
+            const MessageTemplate* message = MessageCatalog::shared().find(record.template_id);
+            if (message != nullptr) {
+                raw.template_id = record.template_id;
+                raw.args = record.message_data();
+                raw.args_size = record.message_size();
+            } else {
+                // Id fora do catálogo: grava os argumentos como texto, sem perder o registro
+                scratch.assign(record.message_data(), record.message_size());
+                raw.message = scratch.data();
+            }
+        }
+    }
+
+    /**
+     * @brief Campos de um registro já formatado (std::string, SlabRecord, ...)
+     * @param scratch Guarda a mensagem quando ela precisa ser reconstruída
+     *
+     * Registros do BinaryFormatter são lidos direto. Registros de texto
+     * (JSON ou logfmt) têm os campos extraídos e a mensagem sem escape:
+     * funciona, mas paga a formatação no producer e o parse aqui.
+     */
+    template<typename Record>
+    auto raw_fields(const Record& record, RawRecord& raw, std::string& scratch) -> decltype(record_data(record), void()) {
+        const char* data = record_data(record);
+        size_t size = record_size(record);
+        if (detail::from_binary_formatter(data, size, raw)) {
+            return;
+        }
+
+        std::chrono::system_clock::time_point time;
+        raw.time = record_time(record, time) ? to_nanos(time) : to_nanos(std::chrono::system_clock::now());
+        raw.level = record_level(record);
+        raw.template_id = 0;
+        int producer_id = 0;
+        raw.producer_id = producer_from_text(data, size, producer_id) ? producer_id : 0;
+
+        scratch.clear();
+        if (!detail::message_from_text(data, size, scratch)) {
+            // Formato desconhecido: guarda o texto inteiro, sem o terminador
+            scratch.assign(data, size > 0 && data[size - 1] == '\n' ? size - 1 : size);
+        }
+        raw.message = scratch.data();
+        raw.message_size = scratch.size();
+    }
+
+    /**
+     * @brief Acrescenta a out um frame com records[0..count)
+     * @param base_time Instante base do arquivo (cabeçalho)
+     * @param templates Recebe os ids de template usados pelo frame (com repetições), se não for nullptr
+     */
+    template<typename Record>
+    void encode_frame(std::string& out, const Record* records, size_t count, int64_t base_time,
+                      std::vector<uint32_t>* templates = nullptr) {
+        static thread_local std::string body;
+        static thread_local std::string scratch;
+        body.clear();
+
+        RawRecord raw;
+        int64_t frame_time = 0;
+        int64_t previous = 0;
+        for (size_t i = 0; i < count; ++i) {
+            raw_fields(records[i], raw, scratch);
+            if (i == 0) {
+                frame_time = raw.time;
+                previous = raw.time;
+            }
+            put_zigzag(body, raw.time - previous);
+            previous = raw.time;
+            if (raw.template_id != 0) {
+                body.push_back(static_cast<char>(static_cast<unsigned char>(raw.level) | TEMPLATE_FLAG));
+                put_zigzag(body, raw.producer_id);
+                put_varint(body, raw.template_id);
+                put_varint(body, raw.args_size);
+                body.append(raw.args, raw.args_size);
+                if (templates != nullptr) {
+                    templates->push_back(raw.template_id);
+                }
+                continue;
+            }
+            body.push_back(static_cast<char>(raw.level));
+            put_zigzag(body, raw.producer_id);
+            put_varint(body, raw.message_size);
+            body.append(raw.message, raw.message_size);
+        }
+
+        std::string prefix(1, static_cast<char>(FRAME_RECORDS));
+        put_varint(prefix, count);
+        put_zigzag(prefix, frame_time - base_time);
+
+        put_varint(out, prefix.size() + body.size());
+        out.append(prefix);
+        out.append(body);
+    }
+
+    /**
+     * @brief Acrescenta a out um frame de dicionário com os templates
+     * @param templates Templates a definir, na ordem
+     */
+    inline void encode_dictionary(std::string& out, const std::vector<const MessageTemplate*>& templates) {
+        std::string body(1, static_cast<char>(FRAME_DICTIONARY));
+        put_varint(body, templates.size());
+        for (size_t i = 0; i < templates.size(); ++i) {
+            put_varint(body, templates[i]->id());
+            put_varint(body, templates[i]->text().size());
+            body.append(templates[i]->text());
+        }
+        put_varint(out, body.size());
+        out.append(body);
+    }
+
+    /**
+     * @brief Leitura sequencial de um arquivo binário, registro a registro
+     *
+     * Lê um frame por vez do stream (o chamador escolhe o buffer do
+     * stream); as mensagens entregues por next() apontam para o frame atual
+     * e valem até a próxima chamada. Frames de dicionário são consumidos
+     * internamente e registros de template chegam com a mensagem já
+     * expandida (e também com template_id e os argumentos).
+     */
+    class Reader {
+    public:
+        /**
+         * @param in Stream aberto em modo binário, no início do arquivo
+         */
+        explicit Reader(std::istream& in)
+            : in(in),
+              base_time(0),
+              version(0),
+              valid(false),
+              truncated_frame(false),
+              position(nullptr),
+              end(nullptr),
+              left_in_frame(0),
+              previous(0) {
+            char fixed[FIXED_HEADER_SIZE];
+            if (!in.read(fixed, sizeof(fixed)) || !parse_fixed_header(fixed, base_time, version)) {
+                return;
+            }
+            uint64_t schema_size = 0;
+            if (!read_varint(schema_size)) {
+                return;
+            }
+            schema_text.resize(static_cast<size_t>(schema_size));
+            valid = schema_size == 0 || static_cast<bool>(in.read(&schema_text[0], static_cast<std::streamsize>(schema_size)));
+        }
+
+        /// O cabeçalho foi reconhecido
+        bool is_valid() const { return valid; }
+
+        /// O arquivo terminou no meio de um frame (ex: processo interrompido durante a escrita)
+        bool truncated() const { return truncated_frame; }
+
+        /// Instante base do cabeçalho
+        int64_t base() const { return base_time; }
+
+        /// Esquema gravado no cabeçalho
+        const std::string& schema_description() const { return schema_text; }
+
+        /// Versão do formato gravada no cabeçalho
+        uint16_t format_version() const { return version; }
+
+        /// Template do dicionário lido até aqui (nullptr se o id ainda não apareceu)
+        const MessageTemplate* find_template(uint32_t id) const {
+            std::unordered_map<uint32_t, std::unique_ptr<MessageTemplate> >::const_iterator found = dictionary.find(id);
+            return found == dictionary.end() ? nullptr : found->second.get();
+        }
+
+        /**
+         * @brief Próximo registro
+         * @return false no fim do arquivo (ou em um frame truncado/corrompido)
+         */
+        bool next(RawRecord& record) {
+            while (left_in_frame == 0) {
+                if (!valid || !load_frame()) {
+                    return false;
+                }
+            }
+
+            int64_t delta = 0;
+            int64_t producer = 0;
+            uint64_t template_id = 0;
+            uint64_t size = 0;
+            if (!get_zigzag(position, end, delta) || position == end) {
+                return corrupted();
+            }
+            unsigned char level = static_cast<unsigned char>(*position++);
+            bool is_template = (level & TEMPLATE_FLAG) != 0 && version >= 2;
+            if (!get_zigzag(position, end, producer) ||
+                (is_template && !get_varint(position, end, template_id)) ||
+                !get_varint(position, end, size) || size > static_cast<uint64_t>(end - position)) {
+                return corrupted();
+            }
+            previous += delta;
+            record.time = previous;
+            record.level = static_cast<LogLevel>(is_template ? level & ~TEMPLATE_FLAG : level);
+            record.producer_id = static_cast<int>(producer);
+            record.template_id = static_cast<uint32_t>(template_id);
+            record.message = position;
+            record.message_size = static_cast<size_t>(size);
+            position += size;
+            --left_in_frame;
+
+            if (is_template) {
+                const MessageTemplate* message = find_template(record.template_id);
+                if (message == nullptr) {
+                    return corrupted();
+                }
+                record.args = record.message;
+                record.args_size = record.message_size;
+                expanded.clear();
+                message->expand(expanded, record.args, record.args_size);
+                record.message = expanded.data();
+                record.message_size = expanded.size();
+            }
+            return true;
+        }
+
+    private:
+        std::istream& in;
+        int64_t base_time;                  ///< Instante base do arquivo
+        uint16_t version;                   ///< Versão do formato do arquivo
+        std::string schema_text;            ///< Esquema do cabeçalho
+        bool valid;                         ///< Cabeçalho reconhecido e sem erros de leitura
+        bool truncated_frame;               ///< Último frame incompleto
+        std::string frame;                  ///< Frame atual
+        const char* position;               ///< Próximo registro do frame
+        const char* end;                    ///< Fim do frame
+        uint64_t left_in_frame;             ///< Registros restantes no frame
+        int64_t previous;                   ///< Instante do registro anterior
+        std::string expanded;               ///< Mensagem expandida do registro de template atual
+        std::unordered_map<uint32_t, std::unique_ptr<MessageTemplate> > dictionary;  ///< Templates lidos
+
+        bool read_varint(uint64_t& value) {
+            value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                int byte = in.get();
+                if (byte == std::char_traits<char>::eof()) {
+                    return false;
+                }
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool load_frame() {
+            uint64_t size = 0;
+            if (!read_varint(size)) {
+                return false;
+            }
+            frame.resize(static_cast<size_t>(size));
+            if (size > 0 && !in.read(&frame[0], static_cast<std::streamsize>(size))) {
+                truncated_frame = true;
+                valid = false;
+                return false;
+            }
+
+            position = frame.data();
+            end = frame.data() + frame.size();
+            if (version >= 2) {
+                if (position == end) {
+                    return corrupted();
+                }
+                unsigned char kind = static_cast<unsigned char>(*position++);
+                if (kind == FRAME_DICTIONARY) {
+                    return load_dictionary();
+                }
+                if (kind != FRAME_RECORDS) {
+                    return corrupted();
+                }
+            }
+            int64_t frame_time = 0;
+            if (!get_varint(position, end, left_in_frame) || !get_zigzag(position, end, frame_time)) {
+                return corrupted();
+            }
+            previous = base_time + frame_time;
+            return true;
+        }
+
+        /// Lê as entradas de um frame de dicionário (o frame não tem registros)
+        bool load_dictionary() {
+            uint64_t entries = 0;
+            if (!get_varint(position, end, entries)) {
+                return corrupted();
+            }
+            for (uint64_t i = 0; i < entries; ++i) {
+                uint64_t id = 0;
+                uint64_t size = 0;
+                if (!get_varint(position, end, id) || !get_varint(position, end, size) ||
+                    size > static_cast<uint64_t>(end - position)) {
+                    return corrupted();
+                }
+                uint32_t key = static_cast<uint32_t>(id);
+                dictionary[key].reset(new MessageTemplate(key, std::string(position, static_cast<size_t>(size))));
+                position += size;
+            }
+            left_in_frame = 0;
+            return true;
+        }
+
+        bool corrupted() {
+            truncated_frame = true;
+            valid = false;
+            left_in_frame = 0;
+            return false;
+        }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+    };
+}
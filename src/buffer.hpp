@@ -2,53 +2,135 @@
 
 #include <queue>
 #include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <stdexcept>
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <condition_variable>
 
-class MessageBuffer {
+#include "log_level.hpp"
+#include "record.hpp"
+#include "overflow_policy.hpp"
+#include "spill_queue.hpp"
+#include "event_count.hpp"
+#include "memory_budget.hpp"
+
+/**
+ * @brief Buffer limitado protegido por mutex e variáveis de condição
+ * @tparam T Tipo do registro armazenado (texto formatado, SlabRecord, ...)
+ *
+ * O comportamento de push() com o buffer cheio segue a OverflowPolicy:
+ * esperar (padrão), esperar com tempo limite, descartar o novo ou o mais
+ * antigo, amostrar, ou transbordar para uma fila em disco. Registros
+ * descartados são contados por nível (dropped()).
+ *
+ * As variáveis de condição só são sinalizadas quando há alguém esperando:
+ * consumers acordam quando o buffer deixa de estar vazio ou passa de
+ * wake_watermark(), e producers, quando uma posição é liberada.
+ *
+ * Com um MemoryBudget o buffer também é considerado cheio enquanto o
+ * orçamento estiver em pressão (acima da marca alta, até voltar à baixa)
+ * ou quando o registro passaria do limite, e a OverflowPolicy vale do
+ * mesmo jeito, mesmo com a fila vazia: a memória retida pelas áreas do
+ * Logger, pelos lotes dos consumers e pelo escritor também segura os
+ * producers. Com a fila vazia, um producer que espera (BLOCK, BLOCK_FOR ou
+ * nível preservado) e não vê memória liberada por stall_timeout() aceita o
+ * registro mesmo assim: a memória pode estar retida pelo próprio producer
+ * (área de agrupamento), e só esse caso passa do limite. O orçamento vale
+ * para o pipeline: o Logger e os consumers deste buffer o encontram por
+ * memory_budget() e contam nele o que retêm.
+ */
+template<typename T>
+class BasicMessageBuffer {
 public:
+    typedef T value_type;       ///< Tipo do registro armazenado
+
     /**
      * @brief Construtor que define capacidade máxima do buffer
      * @param capacity Número máximo de mensagens que o buffer pode armazenar
-     * @throws std::invalid_argument se capacity for 0
+     * @param policy O que fazer com push() quando o buffer estiver cheio
+     * @param budget Orçamento de memória do pipeline (nullptr = limitado só por capacity);
+     * deve viver mais que o buffer
+     * @throws std::invalid_argument se capacity for 0 ou se o tipo do registro
+     * não puder ser gravado em disco com OverflowPolicy::spill()
+     * @throws std::runtime_error se não conseguir criar a fila em disco
      */
-    explicit MessageBuffer(size_t capacity) : max_capacity(capacity), is_shutdown(false) {
+    explicit BasicMessageBuffer(size_t capacity, const OverflowPolicy& policy = OverflowPolicy::block(),
+                                MemoryBudget* budget = nullptr)
+        : max_capacity(capacity),
+          wake_threshold(wake_watermark(capacity)),
+          waiting_consumers(0),
+          waiting_producers(0),
+          is_shutdown(false),
+          policy(policy),
+          spilled_count(0),
+          budget(budget),
+          stored_bytes(0) {
         if (capacity == 0) {
             throw std::invalid_argument("Capacidade do buffer deve ser maior que zero");
         }
+
+        for (size_t i = 0; i < LEVEL_COUNT; ++i) {
+            dropped_counts[i].store(0);
+        }
+
+        if (policy.mode() == OverflowPolicy::Mode::SPILL) {
+            if (!SpillCodec<T>::supported) {
+                throw std::invalid_argument("Fila em disco suportada apenas para registros de texto");
+            }
+            spill_queue.reset(new SpillQueue(policy.spill_path()));
+        }
     }
 
-    ~MessageBuffer() {
+    ~BasicMessageBuffer() {
         shutdown();
     }
 
     /**
      * @brief Adiciona mensagem ao buffer (operação de Producer)
      * @param message Mensagem a ser adicionada
-     * @return true se mensagem foi adicionada, false se buffer foi fechado
+     * @return true se mensagem foi adicionada (na memória ou na fila em disco),
+     * false se foi descartada ou se o buffer foi fechado
      *
-     * Bloqueia se buffer estiver cheio até haver espaço disponível.
-     * Retorna false apenas se shutdown() foi chamado durante a espera.
+     * Com a política padrão, bloqueia se buffer estiver cheio até haver
+     * espaço disponível e retorna false apenas se shutdown() foi chamado
+     * durante a espera.
      */
-    bool push(const std::string& message) {
-        std::unique_lock<std::mutex> lock(mutex);
-
-        // Espera até haver espaço ou buffer ser fechado
-        not_full.wait(lock, [this]() {
-            return buffer.size() < max_capacity || is_shutdown;
-        });
+    bool push(const T& message) {
+        return emplace(message);
+    }
 
-        // Se buffer foi fechado durante a espera
-        if (is_shutdown) {
-            return false;
-        }
+    /**
+     * @brief Adiciona mensagem ao buffer transferindo sua posse
+     * @param message Mensagem a ser movida para o buffer
+     * @return true se mensagem foi adicionada, false se foi descartada ou se o buffer foi fechado
+     */
+    bool push(T&& message) {
+        return emplace(std::move(message));
+    }
 
-        // Adiciona mensagem e notifica consumers
-        buffer.push(message);
-        not_empty.notify_one();
+    /**
+     * @brief Adiciona várias mensagens sob um único lock, transferindo sua posse
+     * @param messages Mensagens a serem movidas para o buffer, em ordem
+     * @return Quantidade de mensagens aceitas
+     *
+     * Cada mensagem segue a OverflowPolicy como em push(); com a política
+     * padrão, a espera por espaço libera o lock até os consumers drenarem.
+     */
+    size_t push_batch(std::vector<T>& messages) {
+        std::unique_lock<std::mutex> lock(mutex);
 
-        return true;
+        size_t accepted = 0;
+        for (size_t i = 0; i < messages.size(); ++i) {
+            if (emplace_locked(lock, std::move(messages[i]))) {
+                ++accepted;
+            }
+        }
+        return accepted;
     }
 
     /**
@@ -59,27 +141,66 @@ public:
      * Bloqueia se buffer estiver vazio até haver mensagem disponível.
      * Retorna false apenas se shutdown() foi chamado e buffer está vazio.
      */
-    bool pop(std::string& message) {
+    bool pop(T& message) {
         std::unique_lock<std::mutex> lock(mutex);
 
-        // Espera até haver mensagem ou buffer ser fechado
-        not_empty.wait(lock, [this]() {
-            return !buffer.empty() || is_shutdown;
-        });
+        wait_not_empty(lock);
 
         // Se buffer foi fechado e está vazio
-        if (is_shutdown && buffer.empty()) {
+        if (!has_messages()) {
             return false;
         }
 
+        // A memória guarda sempre os registros mais antigos que os da fila em disco
+        if (buffer.empty()) {
+            return pop_spilled(message);
+        }
+
         // Remove mensagem e notifica producers
-        message = buffer.front();
+        message = std::move(buffer.front());
         buffer.pop();
-        not_full.notify_one();
+        release_memory(record_memory(message));
+        signal_not_full(1);
 
         return true;
     }
 
+    /**
+     * @brief Remove várias mensagens do buffer de uma vez (operação de Consumer)
+     * @param messages Vetor que recebe as mensagens removidas (é limpo antes)
+     * @param max_messages Número máximo de mensagens a remover
+     * @return Quantidade de mensagens removidas, 0 se buffer foi fechado
+     *
+     * Bloqueia até haver ao menos uma mensagem e então remove, sob um único
+     * lock, todas as disponíveis até max_messages.
+     * Retorna 0 apenas se shutdown() foi chamado e buffer está vazio.
+     */
+    size_t pop_batch(std::vector<T>& messages, size_t max_messages) {
+        messages.clear();
+        std::unique_lock<std::mutex> lock(mutex);
+
+        wait_not_empty(lock);
+
+        size_t bytes = 0;
+        while (!buffer.empty() && messages.size() < max_messages) {
+            messages.push_back(std::move(buffer.front()));
+            buffer.pop();
+            bytes += record_memory(messages.back());
+        }
+        release_memory(bytes);
+
+        // Várias posições podem ter sido liberadas
+        signal_not_full(messages.size());
+
+        // Memória vazia: completa o lote com a fila em disco
+        T spilled;
+        while (messages.size() < max_messages && pop_spilled(spilled)) {
+            messages.push_back(std::move(spilled));
+        }
+
+        return messages.size();
+    }
+
     /**
      * @brief Obtém número atual de mensagens no buffer
      * @return Quantidade de mensagens armazenadas
@@ -87,7 +208,7 @@ public:
      */
     size_t size() const {
         std::lock_guard<std::mutex> lock(mutex);
-        return buffer.size();
+        return buffer.size() + (spill_queue ? spill_queue->size() : 0);
     }
 
     /**
@@ -98,6 +219,55 @@ public:
         return max_capacity;
     }
 
+    /**
+     * @brief Memória retida pelos registros na fila em memória (sem a fila em disco)
+     * @return Bytes estimados com record_memory()
+     */
+    size_t memory_used() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stored_bytes;
+    }
+
+    /**
+     * @brief Orçamento de memória do pipeline
+     * @return nullptr se o buffer for limitado só pela capacidade
+     */
+    MemoryBudget* memory_budget() const {
+        return budget;
+    }
+
+    /**
+     * @brief Obtém a política aplicada com o buffer cheio
+     */
+    const OverflowPolicy& overflow_policy() const {
+        return policy;
+    }
+
+    /**
+     * @brief Registros descartados de um nível desde a criação do buffer
+     */
+    uint64_t dropped(LogLevel level) const {
+        return dropped_counts[static_cast<size_t>(level)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Total de registros descartados, de todos os níveis
+     */
+    uint64_t dropped_total() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < LEVEL_COUNT; ++i) {
+            total += dropped_counts[i].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Registros enviados para a fila em disco desde a criação do buffer
+     */
+    uint64_t spilled() const {
+        return spilled_count.load(std::memory_order_relaxed);
+    }
+
     /**
      * @brief Inicia processo de shutdown do buffer
      *
@@ -117,16 +287,276 @@ public:
     }
 
 private:
+    static const size_t LEVEL_COUNT = 3;         ///< Níveis de LogLevel
+
+    template<typename U>
+    bool emplace(U&& message) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return emplace_locked(lock, std::forward<U>(message));
+    }
+
+    template<typename U>
+    bool emplace_locked(std::unique_lock<std::mutex>& lock, U&& message) {
+        if (is_shutdown) {
+            return false;
+        }
+
+        // Enquanto houver transbordo, novos registros vão para o disco para manter a ordem
+        size_t bytes = record_memory(message);
+        if (has_room(bytes) && !(spill_queue && !spill_queue->empty())) {
+            return enqueue(std::forward<U>(message));
+        }
+
+        if (policy.mode() == OverflowPolicy::Mode::SPILL) {
+            return spill(message);
+        }
+
+        if (policy.mode() == OverflowPolicy::Mode::BLOCK || policy.preserves(record_level(message))) {
+            return wait_and_enqueue(lock, std::forward<U>(message), bytes);
+        }
+
+        switch (policy.mode()) {
+            case OverflowPolicy::Mode::BLOCK_FOR: {
+                std::chrono::milliseconds timeout = policy.timeout();
+                if (wait_for_room(lock, &timeout, bytes)) {
+                    return !is_shutdown && enqueue(std::forward<U>(message));
+                }
+                count_drop(message);
+                return false;
+            }
+
+            case OverflowPolicy::Mode::SAMPLE:
+                if (next_random_ratio() >= policy.sample_ratio() || !drop_oldest_for(bytes)) {
+                    count_drop(message);
+                    return false;
+                }
+                return enqueue(std::forward<U>(message));
+
+            case OverflowPolicy::Mode::DROP_OLDEST:
+                if (!drop_oldest_for(bytes)) {
+                    count_drop(message);
+                    return false;
+                }
+                return enqueue(std::forward<U>(message));
+
+            default:
+                count_drop(message);
+                return false;
+        }
+    }
+
+    /// Adiciona mensagem e notifica consumers (chamado com mutex e espaço livre)
+    template<typename U>
+    bool enqueue(U&& message) {
+        size_t bytes = record_memory(message);
+        buffer.push(std::forward<U>(message));
+        stored_bytes += bytes;
+        if (budget != nullptr) {
+            budget->add(MemoryArea::BUFFER, bytes);
+        }
+        signal_not_empty();
+        return true;
+    }
+
+    /// Devolve ao orçamento a memória de registros retirados da fila (chamado com mutex)
+    void release_memory(size_t bytes) {
+        stored_bytes -= bytes;
+        if (budget != nullptr) {
+            budget->release(MemoryArea::BUFFER, bytes);
+        }
+    }
+
+    /// Cabe um registro de bytes: abaixo da capacidade e dentro do orçamento
+    bool has_room(size_t bytes) const {
+        if (buffer.size() >= max_capacity) {
+            return false;
+        }
+        return budget == nullptr || budget->admits(bytes);
+    }
+
+    /**
+     * @brief Espera até haver espaço ou buffer ser fechado (chamado com mutex)
+     * @param timeout Tempo máximo de espera (nullptr = sem limite)
+     * @param bytes Memória do registro que espera (record_memory)
+     * @return false se o tempo acabou sem espaço
+     *
+     * Com orçamento, a espera acorda a cada relief_poll() para reavaliar a
+     * pressão, que também cai quando consumers e escritor liberam memória
+     * sem passar pelo buffer. Com a fila vazia e o uso parado por
+     * stall_timeout(), o registro é aceito (ver a descrição da classe).
+     */
+    bool wait_for_room(std::unique_lock<std::mutex>& lock, const std::chrono::milliseconds* timeout, size_t bytes) {
+        auto ready = [this, bytes]() {
+            return has_room(bytes) || is_shutdown;
+        };
+
+        ++waiting_producers;
+        bool result = true;
+        if (budget == nullptr && timeout == nullptr) {
+            not_full.wait(lock, ready);
+        } else if (budget == nullptr) {
+            result = not_full.wait_for(lock, *timeout, ready);
+        } else {
+            std::chrono::steady_clock::time_point deadline =
+                std::chrono::steady_clock::now() + (timeout != nullptr ? *timeout : std::chrono::milliseconds(0));
+            std::chrono::steady_clock::time_point stalled_since = std::chrono::steady_clock::now();
+            size_t last_used = budget->used();
+            while (!(result = ready())) {
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                if (timeout != nullptr && now >= deadline) {
+                    break;
+                }
+
+                // Fila vazia: só consumers e escritor podem liberar memória; sem progresso, aceita
+                size_t used = budget->used();
+                if (!buffer.empty() || used < last_used) {
+                    stalled_since = now;
+                }
+                last_used = used;
+                if (buffer.empty() && now - stalled_since >= stall_timeout()) {
+                    result = true;
+                    break;
+                }
+
+                std::chrono::steady_clock::time_point wake = now + relief_poll();
+                not_full.wait_until(lock, timeout != nullptr && deadline < wake ? deadline : wake);
+            }
+        }
+        --waiting_producers;
+        return result;
+    }
+
+    template<typename U>
+    bool wait_and_enqueue(std::unique_lock<std::mutex>& lock, U&& message, size_t bytes) {
+        // Espera até haver espaço ou buffer ser fechado
+        wait_for_room(lock, nullptr, bytes);
+
+        // Se buffer foi fechado durante a espera
+        if (is_shutdown) {
+            return false;
+        }
+
+        return enqueue(std::forward<U>(message));
+    }
+
+    bool spill(const T& message) {
+        static thread_local std::string text;
+        SpillCodec<T>::encode(message, text);
+        spill_queue->push(text.data(), text.size());
+        spilled_count.fetch_add(1, std::memory_order_relaxed);
+        signal_not_empty();
+        return true;
+    }
+
+    /// Espera até haver mensagem ou buffer ser fechado
+    void wait_not_empty(std::unique_lock<std::mutex>& lock) {
+        ++waiting_consumers;
+        not_empty.wait(lock, [this]() {
+            return has_messages() || is_shutdown;
+        });
+        --waiting_consumers;
+    }
+
+    /**
+     * @brief Acorda um consumer após um push (chamado com mutex)
+     *
+     * Só acorda na transição de vazio para não vazio ou acima da marca:
+     * um consumer já acordado drena o restante antes de voltar a esperar.
+     */
+    void signal_not_empty() {
+        if (waiting_consumers == 0) {
+            return;
+        }
+
+        size_t pending = buffer.size() + (spill_queue ? spill_queue->size() : 0);
+        if (pending == 1 || pending >= wake_threshold) {
+            not_empty.notify_one();
+        }
+    }
+
+    /// Acorda até freed producers esperando por espaço (chamado com mutex)
+    void signal_not_full(size_t freed) {
+        size_t wake = freed < waiting_producers ? freed : waiting_producers;
+        for (size_t i = 0; i < wake; ++i) {
+            not_full.notify_one();
+        }
+    }
+
+    /// Retira um registro da fila em disco (chamado com mutex)
+    bool pop_spilled(T& message) {
+        if (!spill_queue || spill_queue->empty()) {
+            return false;
+        }
+
+        static thread_local std::string text;
+        spill_queue->pop(text);
+        SpillCodec<T>::decode(text, message);
+        return true;
+    }
+
+    bool has_messages() const {
+        return !buffer.empty() || (spill_queue && !spill_queue->empty());
+    }
+
+    /**
+     * @brief Descarta os registros mais antigos até caber um registro de bytes
+     * @return false se nem a fila vazia abre espaço (memória retida fora do buffer)
+     */
+    bool drop_oldest_for(size_t bytes) {
+        while (!has_room(bytes) && !buffer.empty()) {
+            count_drop(buffer.front());
+            release_memory(record_memory(buffer.front()));
+            buffer.pop();
+        }
+        return has_room(bytes);
+    }
+
+    void count_drop(const T& message) {
+        dropped_counts[static_cast<size_t>(record_level(message))].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Intervalo em que producers esperando reavaliam a pressão do orçamento
+    static std::chrono::milliseconds relief_poll() {
+        return std::chrono::milliseconds(5);
+    }
+
+    /// Tempo com a fila vazia e nenhuma memória liberada até o producer que espera ser aceito
+    static std::chrono::milliseconds stall_timeout() {
+        return std::chrono::milliseconds(100);
+    }
+
+    /// Número pseudoaleatório em [0, 1) para a amostragem (xorshift por thread)
+    static double next_random_ratio() {
+        static thread_local uint64_t state = 0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&state);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<double>(state >> 11) * (1.0 / 9007199254740992.0);
+    }
+
     mutable std::mutex mutex;                    ///< Mutex para acesso thread-safe
 
     std::condition_variable not_empty;           ///< Condição para consumers esperando
     std::condition_variable not_full;            ///< Condição para producers esperando
-    std::queue<std::string> buffer;              ///< Fila FIFO interna
+    std::queue<T> buffer;                        ///< Fila FIFO interna
 
     const size_t max_capacity;                   ///< Capacidade máxima do buffer
+    const size_t wake_threshold;                 ///< Ocupação que acorda mais consumers
+    size_t waiting_consumers;                    ///< Consumers em not_empty (protegido pelo mutex)
+    size_t waiting_producers;                    ///< Producers em not_full (protegido pelo mutex)
     std::atomic<bool> is_shutdown;               ///< Flag de shutdown thread-safe
 
+    const OverflowPolicy policy;                 ///< Ação com o buffer cheio
+    std::unique_ptr<SpillQueue> spill_queue;     ///< Fila em disco (apenas em SPILL)
+    std::atomic<uint64_t> dropped_counts[LEVEL_COUNT];   ///< Descartes por nível
+    std::atomic<uint64_t> spilled_count;         ///< Registros enviados ao disco
+    MemoryBudget* const budget;                  ///< Orçamento do pipeline (nullptr = sem orçamento)
+    size_t stored_bytes;                         ///< Memória dos registros na fila (protegido pelo mutex)
+
     // Desabilita cópia para evitar problemas com mutex
-    MessageBuffer(const MessageBuffer&) = delete;
-    MessageBuffer& operator=(const MessageBuffer&) = delete;
+    BasicMessageBuffer(const BasicMessageBuffer&) = delete;
+    BasicMessageBuffer& operator=(const BasicMessageBuffer&) = delete;
 };
+
+/// Buffer de registros já formatados como texto
+typedef BasicMessageBuffer<std::string> MessageBuffer;
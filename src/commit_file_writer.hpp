@@ -0,0 +1,775 @@
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <condition_variable>
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+
+#include "log_level.hpp"
+#include "record.hpp"
+#include "event_count.hpp"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include "emergency_flush.hpp"
+#else
+namespace emergency { class Region; }
+#endif
+
+/**
+ * @brief Configuração do CommitFileWriter
+ *
+ * Exemplo: buffers de 4 MiB por consumer, registros gravados em ordem de
+ * timestamp desde que cheguem ao committer com menos de 50 ms de atraso:
+ * @code
+ * CommitOptions::defaults().with_buffer_bytes(4 << 20).with_timestamp_order(std::chrono::milliseconds(50))
+ * @endcode
+ */
+class CommitOptions {
+public:
+    /// Buffers de 1 MiB, até 4 por consumer, entregues após no máximo 100 ms, sem reordenação
+    static CommitOptions defaults() {
+        return CommitOptions();
+    }
+
+    /**
+     * @brief Tamanho a partir do qual o buffer de um consumer é entregue ao committer
+     * @throws std::invalid_argument se bytes for 0
+     */
+    CommitOptions with_buffer_bytes(size_t bytes) const {
+        if (bytes == 0) {
+            throw std::invalid_argument("Tamanho do buffer deve ser maior que zero");
+        }
+        CommitOptions options(*this);
+        options.buffer_limit = bytes;
+        return options;
+    }
+
+    /**
+     * @brief Buffers de um consumer que podem existir ao mesmo tempo (enchendo ou na fila)
+     * @throws std::invalid_argument se count for menor que 2
+     *
+     * Com todos em uso, o consumer espera o committer devolver um.
+     */
+    CommitOptions with_buffers_per_consumer(size_t count) const {
+        if (count < 2) {
+            throw std::invalid_argument("São necessários pelo menos 2 buffers por consumer");
+        }
+        CommitOptions options(*this);
+        options.buffer_count = count;
+        return options;
+    }
+
+    /// Tempo máximo que um registro espera no buffer parcial de um consumer
+    CommitOptions with_max_delay(std::chrono::milliseconds delay) const {
+        CommitOptions options(*this);
+        options.delay = delay;
+        return options;
+    }
+
+    /**
+     * @brief Grava os registros de todos os consumers em ordem de timestamp
+     * @param window Quanto o committer segura cada registro esperando por outros mais antigos
+     *
+     * A ordem é garantida para registros que chegam ao committer com atraso
+     * menor que a janela; a janela deve ser maior que max_delay. flush() e
+     * close() gravam tudo o que já chegou, sem esperar a janela.
+     */
+    CommitOptions with_timestamp_order(std::chrono::milliseconds window) const {
+        CommitOptions options(*this);
+        options.ordered = true;
+        options.window = window;
+        return options;
+    }
+
+    size_t buffer_bytes() const { return buffer_limit; }
+    size_t buffers_per_consumer() const { return buffer_count; }
+    std::chrono::milliseconds max_delay() const { return delay; }
+    /**
+     * @brief Publica os buffers em memória para emergency::flush_all() (apenas POSIX)
+     *
+     * Com emergency::install_handlers() no programa, um SIGTERM ou uma falha
+     * grava no arquivo o que ainda estava nos buffers dos consumers.
+     */
+    CommitOptions with_emergency_flush(bool enabled = true) const {
+        CommitOptions options(*this);
+        options.emergency = enabled;
+        return options;
+    }
+
+    bool timestamp_order() const { return ordered; }
+    std::chrono::milliseconds order_window() const { return window; }
+    bool emergency_flush() const { return emergency; }
+
+private:
+    size_t buffer_limit;                    ///< Bytes por buffer
+    size_t buffer_count;                    ///< Buffers por consumer
+    std::chrono::milliseconds delay;        ///< Espera máxima no buffer parcial
+    bool ordered;                           ///< Reordena por timestamp
+    std::chrono::milliseconds window;       ///< Janela de reordenação
+    bool emergency;                         ///< Publica os buffers para a gravação de emergência
+
+    CommitOptions()
+        : buffer_limit(1024 * 1024),
+          buffer_count(4),
+          delay(100),
+          ordered(false),
+          window(0),
+          emergency(false) {}
+};
+
+/**
+ * @brief Escritor de arquivo em que cada consumer escreve sem disputar lock
+ *
+ * Mesma interface do FileWriter (append, append_batch, flush, close). No
+ * FileWriter todos os consumers passam pelo mesmo mutex; aqui cada thread
+ * que escreve recebe um buffer privado grande e formata os registros
+ * diretamente nele. Buffers cheios (ou com registros mais velhos que
+ * max_delay) são entregues por uma fila sem lock a uma única thread de
+ * commit, que os grava no arquivo e os devolve ao consumer para reuso.
+ * Assim mais consumers significam mais formatação em paralelo, e o arquivo
+ * recebe poucas escritas grandes.
+ *
+ * Sem reordenação, os registros de um buffer ficam contíguos no arquivo e
+ * buffers de consumers diferentes se intercalam na ordem de entrega. Com
+ * with_timestamp_order(), o committer intercala os registros de todos os
+ * buffers pelo timestamp (record_time()).
+ */
+class CommitFileWriter {
+public:
+    /**
+     * @param filename Nome do arquivo de log (registros são acrescentados ao final)
+     * @param options Tamanho e quantidade de buffers, espera máxima e reordenação
+     * @throws std::runtime_error se não conseguir abrir o arquivo
+     */
+    explicit CommitFileWriter(const std::string& filename, const CommitOptions& options = CommitOptions::defaults())
+        : filename(filename),
+          options(options),
+          writer_id(next_writer_id()),
+          emergency_fd(-1),
+          stub(nullptr, nullptr),
+          head(&stub),
+          tail(&stub),
+          handed_off(0),
+          committed(0),
+          flush_waiters(0),
+          failed(false),
+          stopping(false),
+          accepting(true) {
+        file.open(filename, std::ios::app | std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Não foi possível abrir o arquivo de log: " + filename);
+        }
+#if !defined(_WIN32)
+        if (options.emergency_flush()) {
+            // Descritor próprio: o tratador de sinal não pode usar o ofstream
+            emergency_fd = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        }
+#endif
+
+        commit_thread = std::thread(&CommitFileWriter::commit_routine, this);
+
+        std::cout << "CommitFileWriter criado para arquivo: " << filename << std::endl;
+    }
+
+    ~CommitFileWriter() {
+        try {
+            close();
+        } catch (const std::exception&) {
+            // Destrutor não propaga falhas de escrita
+        }
+    }
+
+    /**
+     * @brief Adiciona registro formatado ao buffer desta thread
+     * @throws std::runtime_error se o arquivo foi fechado ou uma escrita anterior falhou
+     */
+    void append(const std::string& record) {
+        Lane& lane = local_lane();
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        Buffer& buffer = writable_buffer(lane);
+
+        size_t begin = buffer.data.size();
+        buffer.data.append(record);
+        if (options.timestamp_order()) {
+            std::chrono::system_clock::time_point time;
+            if (!record_time(record, time)) {
+                time = std::chrono::system_clock::now();
+            }
+            buffer.spans.push_back(Span(time, begin, record.size()));
+        }
+        publish_region(buffer.region, buffer.data);
+        after_append(lane);
+    }
+
+    /// Nível não altera a escrita; existe pela interface comum dos escritores
+    void append(const std::string& record, LogLevel) {
+        append(record);
+    }
+
+    /**
+     * @brief Formata um lote diretamente no buffer desta thread
+     * @tparam Record Tipo do registro, acessado via append_record() (e record_time() com reordenação)
+     * @throws std::runtime_error se o arquivo foi fechado ou uma escrita anterior falhou
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        Lane& lane = local_lane();
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        Buffer& buffer = writable_buffer(lane);
+
+        if (!options.timestamp_order()) {
+            for (size_t i = 0; i < records.size(); ++i) {
+                append_record(buffer.data, records[i]);
+            }
+        } else {
+            std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+            for (size_t i = 0; i < records.size(); ++i) {
+                size_t begin = buffer.data.size();
+                append_record(buffer.data, records[i]);
+
+                std::chrono::system_clock::time_point time;
+                if (!record_time(records[i], time)) {
+                    time = now;
+                }
+                buffer.spans.push_back(Span(time, begin, buffer.data.size() - begin));
+            }
+        }
+        publish_region(buffer.region, buffer.data);
+        after_append(lane);
+    }
+
+    bool is_open() const {
+        return accepting.load() && !failed.load();
+    }
+
+    const std::string& get_filename() const {
+        return filename;
+    }
+
+    const CommitOptions& get_options() const {
+        return options;
+    }
+
+    /**
+     * @brief Memória reservada pelos buffers dos consumers (usado pelo MemoryBudget)
+     *
+     * Cada buffer alocado reserva sua capacidade inteira, cheio ou não.
+     */
+    size_t buffered_bytes() const {
+        std::lock_guard<std::mutex> lock(lanes_mutex);
+        size_t allocated = 0;
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            allocated += lanes[i]->allocated.load(std::memory_order_relaxed);
+        }
+        return allocated * (options.buffer_bytes() + options.buffer_bytes() / 4);
+    }
+
+    /**
+     * @brief Entrega os buffers parciais de todos os consumers e espera sua gravação
+     * @throws std::runtime_error se alguma escrita falhou
+     */
+    void flush() {
+        hand_off_all();
+        wait_committed(handed_off.load());
+        if (failed.load()) {
+            throw std::runtime_error("Falha ao gravar no arquivo de log: " + filename);
+        }
+    }
+
+    /**
+     * @brief Grava tudo o que estiver nos buffers e encerra a thread de commit
+     *
+     * Os consumers devem ter parado de escrever antes.
+     */
+    void close() {
+        if (!accepting.exchange(false)) {
+            return;
+        }
+
+        hand_off_all();
+        wait_committed(handed_off.load());
+
+        stopping.store(true);
+        ready.notify_all();
+        if (commit_thread.joinable()) {
+            commit_thread.join();
+        }
+
+        file.flush();
+        file.close();
+#if !defined(_WIN32)
+        if (emergency_fd >= 0) {
+            ::close(emergency_fd);
+            emergency_fd = -1;
+        }
+#endif
+        std::cout << "Arquivo de log fechado: " << filename << std::endl;
+    }
+
+private:
+    /// Posição de um registro no buffer, para a reordenação por timestamp
+    struct Span {
+        std::chrono::system_clock::time_point time;
+        size_t offset;
+        size_t length;
+
+        Span(std::chrono::system_clock::time_point time, size_t offset, size_t length)
+            : time(time), offset(offset), length(length) {}
+    };
+
+    struct Lane;
+
+    /// Buffer privado de um consumer; também é o nó da fila sem lock
+    struct Buffer {
+        std::atomic<Buffer*> next;                          ///< Próximo na fila de commit
+        Lane* lane;                                         ///< Consumer dono (nullptr no nó sentinela)
+        std::string data;                                   ///< Registros formatados
+        std::vector<Span> spans;                            ///< Registros (só com reordenação)
+        std::chrono::steady_clock::time_point first_write;  ///< Primeiro registro do buffer
+        emergency::Region* region;                          ///< Gravação de emergência (ou nullptr)
+
+        Buffer(Lane* lane, emergency::Region* region) : next(nullptr), lane(lane), region(region) {}
+
+        ~Buffer() {
+            close_region(region);
+        }
+    };
+
+    /**
+     * @brief Registros de um buffer retidos pela reordenação
+     *
+     * O committer troca o conteúdo do buffer recebido pelo de um Chunk vazio
+     * e devolve o buffer na hora: sem isso, a janela de reordenação prenderia
+     * os buffers dos consumers e atrasaria a entrada dos próximos registros.
+     */
+    struct Chunk {
+        std::string data;
+        std::vector<Span> spans;
+        size_t unwritten;                   ///< Registros ainda no heap
+        emergency::Region* region;          ///< Gravação de emergência (ou nullptr)
+
+        explicit Chunk(emergency::Region* region) : unwritten(0), region(region) {}
+
+        ~Chunk() {
+            close_region(region);
+        }
+    };
+
+    /// Estado de um consumer: buffer atual e buffer devolvido pelo committer
+    struct Lane {
+        std::mutex mutex;                   ///< Só disputado por flush() e pela varredura de buffers parados
+        Buffer* current;                    ///< Buffer sendo preenchido
+        std::atomic<Buffer*> spare;         ///< Buffer vazio devolvido pelo committer
+        std::atomic<size_t> allocated;      ///< Buffers deste consumer em uso
+        EventCount returned;                ///< Consumer esperando um buffer livre
+
+        Lane() : current(nullptr), spare(nullptr), allocated(0) {}
+
+        ~Lane() {
+            delete current;
+            delete spare.load();
+        }
+    };
+
+    /// Registro aguardando no heap de reordenação
+    struct Pending {
+        std::chrono::system_clock::time_point time;
+        uint64_t sequence;                  ///< Desempate: ordem de chegada
+        Chunk* chunk;
+        size_t span;
+
+        bool operator>(const Pending& other) const {
+            return time != other.time ? time > other.time : sequence > other.sequence;
+        }
+    };
+
+    const std::string filename;                 ///< Arquivo de saída
+    const CommitOptions options;                ///< Configuração
+    const uint64_t writer_id;                   ///< Chave do cache de lanes por thread
+    int emergency_fd;                           ///< Descritor da gravação de emergência (-1 = desativada)
+    std::ofstream file;                         ///< Só a thread de commit (e close()) escreve
+
+    mutable std::mutex lanes_mutex;             ///< Protege lanes
+    std::vector<std::unique_ptr<Lane> > lanes;  ///< Um por thread que já escreveu
+
+    Buffer stub;                                ///< Nó sentinela da fila
+    std::atomic<Buffer*> head;                  ///< Último nó inserido (producers)
+    Buffer* tail;                               ///< Próximo nó a retirar (só o committer)
+    EventCount ready;                           ///< Committer esperando buffers
+
+    std::atomic<uint64_t> handed_off;           ///< Buffers entregues à fila
+    std::atomic<uint64_t> committed;            ///< Buffers gravados por completo
+    std::atomic<int> flush_waiters;             ///< flush() esperando: reordenação não segura registros
+    std::mutex committed_mutex;                 ///< Protege a espera de flush()
+    std::condition_variable committed_cv;       ///< Sinaliza buffers gravados
+
+    std::atomic<bool> failed;                   ///< Alguma escrita falhou
+    std::atomic<bool> stopping;                 ///< Thread de commit deve terminar
+    std::atomic<bool> accepting;                ///< false após close()
+    std::thread commit_thread;                  ///< Thread que grava no arquivo
+
+    static uint64_t next_writer_id() {
+        static std::atomic<uint64_t> counter(0);
+        return counter.fetch_add(1) + 1;
+    }
+
+    /**
+     * @brief Lane da thread atual, criada no primeiro uso
+     */
+    Lane& local_lane() {
+        static thread_local std::vector<std::pair<uint64_t, Lane*> > cache;
+        for (size_t i = 0; i < cache.size(); ++i) {
+            if (cache[i].first == writer_id) {
+                return *cache[i].second;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(lanes_mutex);
+        lanes.emplace_back(new Lane());
+        cache.push_back(std::make_pair(writer_id, lanes.back().get()));
+        return *lanes.back();
+    }
+
+    /**
+     * @brief Buffer atual da lane, obtendo um livre se necessário (chamado com lane.mutex)
+     * @throws std::runtime_error se o escritor foi fechado ou uma escrita falhou
+     */
+    Buffer& writable_buffer(Lane& lane) {
+        if (!accepting.load(std::memory_order_relaxed)) {
+            throw std::runtime_error("Arquivo de log foi fechado inesperadamente");
+        }
+        if (failed.load(std::memory_order_relaxed)) {
+            throw std::runtime_error("Falha ao gravar no arquivo de log: " + filename);
+        }
+
+        if (lane.current == nullptr) {
+            lane.current = acquire_buffer(lane);
+        }
+        if (lane.current->data.empty()) {
+            lane.current->first_write = std::chrono::steady_clock::now();
+        }
+        return *lane.current;
+    }
+
+    /// Reaproveita o buffer devolvido, aloca outro ou espera o committer devolver um
+    Buffer* acquire_buffer(Lane& lane) {
+        for (;;) {
+            Buffer* buffer = lane.spare.exchange(nullptr, std::memory_order_acquire);
+            if (buffer != nullptr) {
+                return buffer;
+            }
+            if (lane.allocated.load(std::memory_order_relaxed) < options.buffers_per_consumer()) {
+                lane.allocated.fetch_add(1, std::memory_order_relaxed);
+                buffer = new Buffer(&lane, open_region());
+                buffer->data.reserve(options.buffer_bytes() + options.buffer_bytes() / 4);
+                return buffer;
+            }
+
+            uint32_t key = lane.returned.prepare_wait();
+            if (lane.spare.load(std::memory_order_acquire) != nullptr || failed.load()) {
+                lane.returned.cancel_wait();
+                if (failed.load()) {
+                    throw std::runtime_error("Falha ao gravar no arquivo de log: " + filename);
+                }
+                continue;
+            }
+            lane.returned.wait(key);
+        }
+    }
+
+    /// Entrega o buffer se encheu ou se ficou velho (chamado com lane.mutex)
+    void after_append(Lane& lane) {
+        Buffer* buffer = lane.current;
+        if (buffer->data.size() >= options.buffer_bytes() ||
+            std::chrono::steady_clock::now() - buffer->first_write >= options.max_delay()) {
+            hand_off(lane);
+        }
+    }
+
+    /// Coloca o buffer atual da lane na fila de commit (chamado com lane.mutex)
+    void hand_off(Lane& lane) {
+        Buffer* buffer = lane.current;
+        if (buffer == nullptr || buffer->data.empty()) {
+            return;
+        }
+        lane.current = nullptr;
+
+        handed_off.fetch_add(1, std::memory_order_relaxed);
+        push(buffer);
+        if (ready.has_waiters()) {
+            ready.notify_one();
+        }
+    }
+
+    /// Entrega os buffers parciais de todas as lanes
+    void hand_off_all() {
+        std::lock_guard<std::mutex> lock(lanes_mutex);
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            std::lock_guard<std::mutex> lane_lock(lanes[i]->mutex);
+            hand_off(*lanes[i]);
+        }
+    }
+
+    /// Espera a thread de commit gravar target buffers
+    void wait_committed(uint64_t target) {
+        flush_waiters.fetch_add(1);
+        ready.notify_one();
+
+        std::unique_lock<std::mutex> lock(committed_mutex);
+        committed_cv.wait(lock, [this, target]() { return committed.load() >= target || failed.load(); });
+        flush_waiters.fetch_sub(1);
+    }
+
+    /// Insere na fila MPSC sem lock (algoritmo de Vyukov)
+    void push(Buffer* buffer) {
+        buffer->next.store(nullptr, std::memory_order_relaxed);
+        Buffer* previous = head.exchange(buffer, std::memory_order_acq_rel);
+        previous->next.store(buffer, std::memory_order_release);
+    }
+
+    /// Retira da fila (só a thread de commit); nullptr se vazia ou com inserção em andamento
+    Buffer* pop() {
+        Buffer* first = tail;
+        Buffer* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail = next;
+            return first;
+        }
+        if (first != head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        push(&stub);
+        next = first->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail = next;
+            return first;
+        }
+        return nullptr;
+    }
+
+    /// Devolve o buffer gravado ao seu consumer
+    void release(Buffer* buffer) {
+        Lane* lane = buffer->lane;
+        clear_region(buffer->region);
+        buffer->data.clear();
+        buffer->spans.clear();
+
+        Buffer* previous = lane->spare.exchange(buffer, std::memory_order_acq_rel);
+        if (previous != nullptr) {
+            lane->allocated.fetch_sub(1, std::memory_order_relaxed);
+            delete previous;
+        }
+        if (lane->returned.has_waiters()) {
+            lane->returned.notify_all();
+        }
+    }
+
+    /**
+     * @brief Rotina da thread de commit: grava buffers na ordem de entrega ou por timestamp
+     */
+    void commit_routine() {
+        std::vector<Pending> heap;                      // Registros retidos, menor timestamp no topo
+        std::vector<std::unique_ptr<Chunk> > chunks;    // Todos os chunks criados
+        std::vector<Chunk*> free_chunks;                // Chunks sem registros no heap
+        std::vector<Chunk*> finished_chunks;            // Chunks esvaziados nesta rodada
+        std::string block;
+        uint64_t sequence = 0;
+        uint64_t received = 0;
+        std::chrono::milliseconds tick = options.max_delay();
+        if (options.timestamp_order() && options.order_window() < tick) {
+            tick = options.order_window();
+        }
+        if (tick.count() <= 0) {
+            tick = std::chrono::milliseconds(1);
+        }
+
+        for (;;) {
+            bool progressed = false;
+
+            Buffer* buffer;
+            while ((buffer = pop()) != nullptr) {
+                progressed = true;
+                ++received;
+                if (!options.timestamp_order()) {
+                    write_block(buffer->data);
+                    file.flush();
+                    release(buffer);
+                    committed.store(received, std::memory_order_release);
+                    continue;
+                }
+
+                if (free_chunks.empty()) {
+                    chunks.emplace_back(new Chunk(open_region()));
+                    free_chunks.push_back(chunks.back().get());
+                }
+                Chunk* chunk = free_chunks.back();
+                free_chunks.pop_back();
+                chunk->data.swap(buffer->data);
+                chunk->spans.swap(buffer->spans);
+                chunk->unwritten = chunk->spans.size();
+                publish_region(chunk->region, chunk->data);
+                release(buffer);
+
+                for (size_t i = 0; i < chunk->spans.size(); ++i) {
+                    Pending entry;
+                    entry.time = chunk->spans[i].time;
+                    entry.sequence = sequence++;
+                    entry.chunk = chunk;
+                    entry.span = i;
+                    heap.push_back(entry);
+                    std::push_heap(heap.begin(), heap.end(), std::greater<Pending>());
+                }
+                if (chunk->unwritten == 0) {
+                    free_chunks.push_back(chunk);
+                }
+            }
+
+            if (options.timestamp_order() && !heap.empty()) {
+                bool drain_all = flush_waiters.load() > 0 || stopping.load();
+                std::chrono::system_clock::time_point limit = std::chrono::system_clock::now() - options.order_window();
+                block.clear();
+                while (!heap.empty() && (drain_all || heap.front().time <= limit)) {
+                    std::pop_heap(heap.begin(), heap.end(), std::greater<Pending>());
+                    Pending entry = heap.back();
+                    heap.pop_back();
+
+                    const Span& span = entry.chunk->spans[entry.span];
+                    block.append(entry.chunk->data, span.offset, span.length);
+                    if (--entry.chunk->unwritten == 0) {
+                        finished_chunks.push_back(entry.chunk);
+                    }
+                    progressed = true;
+                }
+                write_block(block);
+                file.flush();
+
+                // Só depois de gravados os bytes deixam de precisar da gravação de emergência
+                for (size_t i = 0; i < finished_chunks.size(); ++i) {
+                    clear_region(finished_chunks[i]->region);
+                    finished_chunks[i]->data.clear();
+                    finished_chunks[i]->spans.clear();
+                    free_chunks.push_back(finished_chunks[i]);
+                }
+                finished_chunks.clear();
+            }
+            if (options.timestamp_order() && heap.empty()) {
+                // Com reordenação, um buffer só conta como gravado quando todos os registros saem do heap
+                committed.store(received, std::memory_order_release);
+            }
+
+            if (progressed) {
+                file.flush();
+                if (!file.good()) {
+                    failed.store(true);
+                }
+                std::lock_guard<std::mutex> lock(committed_mutex);
+                committed_cv.notify_all();
+            }
+
+            if (stopping.load() && heap.empty() && tail->next.load() == nullptr && head.load() == tail) {
+                break;
+            }
+
+            hand_off_idle_lanes();
+
+            uint32_t key = ready.prepare_wait();
+            if (head.load(std::memory_order_acquire) != tail || tail->next.load(std::memory_order_acquire) != nullptr ||
+                stopping.load() || (flush_waiters.load() > 0 && !heap.empty())) {
+                ready.cancel_wait();
+                continue;
+            }
+            ready.wait_for(key, tick);
+        }
+    }
+
+    /// Região de emergência para um novo buffer ou chunk (nullptr se desativada)
+    emergency::Region* open_region() const {
+#if !defined(_WIN32)
+        return emergency_fd >= 0 ? emergency::open_region(emergency_fd) : nullptr;
+#else
+        return nullptr;
+#endif
+    }
+
+    static void publish_region(emergency::Region* region, const std::string& data) {
+#if !defined(_WIN32)
+        if (region != nullptr) {
+            region->publish(data.data(), data.size());
+        }
+#else
+        (void)region;
+        (void)data;
+#endif
+    }
+
+    static void clear_region(emergency::Region* region) {
+#if !defined(_WIN32)
+        if (region != nullptr) {
+            region->clear();
+        }
+#else
+        (void)region;
+#endif
+    }
+
+    static void close_region(emergency::Region* region) {
+#if !defined(_WIN32)
+        emergency::close_region(region);
+#else
+        (void)region;
+#endif
+    }
+
+    void write_block(const std::string& data) {
+        if (!data.empty()) {
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+    }
+
+    /// Entrega buffers parciais parados há mais de max_delay (consumer ocioso)
+    void hand_off_idle_lanes() {
+        std::unique_lock<std::mutex> lock(lanes_mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            Lane& lane = *lanes[i];
+            // try_lock: um consumer esperando buffer livre segura o mutex da lane
+            std::unique_lock<std::mutex> lane_lock(lane.mutex, std::try_to_lock);
+            if (lane_lock.owns_lock() && lane.current != nullptr && !lane.current->data.empty() &&
+                now - lane.current->first_write >= options.max_delay()) {
+                hand_off(lane);
+            }
+        }
+    }
+
+    // Desabilita cópia, a thread de commit e as lanes referenciam esta instância
+    CommitFileWriter(const CommitFileWriter&) = delete;
+    CommitFileWriter& operator=(const CommitFileWriter&) = delete;
+};
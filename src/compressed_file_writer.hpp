@@ -0,0 +1,513 @@
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <condition_variable>
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+
+#include "log_level.hpp"
+#include "record.hpp"
+#include "flush_policy.hpp"
+#include "compression.hpp"
+
+/**
+ * @brief Entrada do índice de frames de um CompressedFileWriter
+ *
+ * Gravada no arquivo "<log>.idx" com 24 bytes em little-endian:
+ * | bytes | campo                                                  |
+ * |-------|--------------------------------------------------------|
+ * | 8     | offset do frame no arquivo de log (uint64)             |
+ * | 4     | tamanho comprimido do frame (uint32)                   |
+ * | 4     | quantidade de registros no frame (uint32)              |
+ * | 8     | instante do primeiro registro em ns desde a época (int64) |
+ */
+struct FrameIndexEntry {
+    static const size_t ENCODED_SIZE = 24;  ///< Bytes de cada entrada no arquivo
+
+    uint64_t offset;                        ///< Início do frame no arquivo de log
+    uint32_t compressed_size;               ///< Bytes do frame
+    uint32_t record_count;                  ///< Registros no frame
+    int64_t first_time;                     ///< Primeiro registro, em ns desde a época
+
+    void encode(char* out) const {
+        put(out, offset, 8);
+        put(out + 8, compressed_size, 4);
+        put(out + 12, record_count, 4);
+        put(out + 16, static_cast<uint64_t>(first_time), 8);
+    }
+
+    static FrameIndexEntry decode(const char* in) {
+        FrameIndexEntry entry;
+        entry.offset = get(in, 8);
+        entry.compressed_size = static_cast<uint32_t>(get(in + 8, 4));
+        entry.record_count = static_cast<uint32_t>(get(in + 12, 4));
+        entry.first_time = static_cast<int64_t>(get(in + 16, 8));
+        return entry;
+    }
+
+private:
+    static void put(char* out, uint64_t value, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    static uint64_t get(const char* in, size_t size) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+        }
+        return value;
+    }
+};
+
+/**
+ * @brief Leitura de logs gravados pelo CompressedFileWriter
+ */
+namespace frame_index {
+    /**
+     * @brief Carrega todas as entradas de um arquivo de índice
+     * @throws std::runtime_error se não conseguir abrir o índice
+     */
+    inline std::vector<FrameIndexEntry> read(const std::string& index_path) {
+        std::ifstream in(index_path, std::ios::binary);
+        if (!in.is_open()) {
+            throw std::runtime_error("Não foi possível abrir o índice: " + index_path);
+        }
+
+        std::vector<FrameIndexEntry> entries;
+        char bytes[FrameIndexEntry::ENCODED_SIZE];
+        while (in.read(bytes, sizeof(bytes))) {
+            entries.push_back(FrameIndexEntry::decode(bytes));
+        }
+        return entries;
+    }
+
+    /**
+     * @brief Posição do primeiro frame que pode conter registros a partir de time
+     * @return Índice em entries (0 se time for anterior a todos os frames)
+     *
+     * Frames de consumers diferentes podem se sobrepor no tempo; a busca
+     * assume a ordem aproximada e recua um frame para não perder registros.
+     */
+    inline size_t find(const std::vector<FrameIndexEntry>& entries, std::chrono::system_clock::time_point time) {
+        int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        size_t position = static_cast<size_t>(std::lower_bound(entries.begin(), entries.end(), nanos,
+            [](const FrameIndexEntry& entry, int64_t value) { return entry.first_time < value; }) - entries.begin());
+        return position > 0 ? position - 1 : 0;
+    }
+
+    /**
+     * @brief Lê e descomprime um único frame, acrescentando seus registros a out
+     * @return false se o frame não puder ser lido ou estiver corrompido
+     */
+    inline bool read_frame(std::ifstream& log, const FrameIndexEntry& entry, std::string& out) {
+        std::string frame(entry.compressed_size, '\0');
+        log.clear();
+        log.seekg(static_cast<std::streamoff>(entry.offset));
+        if (!log.read(&frame[0], static_cast<std::streamsize>(frame.size()))) {
+            return false;
+        }
+        return compression::decompress_frame(frame.data(), frame.size(), out);
+    }
+}
+
+/**
+ * @brief Escritor que comprime os registros em frames gzip independentes
+ *
+ * Mesma interface do FileWriter. Os registros (de append() ou de lotes
+ * inteiros de append_batch()) são formatados na thread do consumer e
+ * acumulados sem compressão; o frame só é selado quando o acumulado chega
+ * a frame_bytes() (padrão 64 KiB), em flush(), no intervalo da FlushPolicy,
+ * em close() ou com um registro da severidade da política. Lotes do
+ * Consumer sob carga real têm poucos registros, e um frame por lote
+ * comprimiria mal (ou até aumentaria o arquivo) e encheria o índice. A
+ * compressão do frame selado é feita fora da seção crítica, na thread que
+ * o selou; sob o lock ficam a cópia para o acumulado e a escrita do frame
+ * e de sua entrada no índice "<arquivo>.idx" (offset, tamanho, registros e
+ * instante do primeiro registro). Os frames são gravados na ordem em que
+ * foram selados.
+ *
+ * Leitores usam o índice (frame_index) para ir direto a um frame sem
+ * descomprimir o arquivo inteiro; como os frames são membros gzip
+ * concatenados, o arquivo também é lido por zcat. Registros ainda não
+ * selados só chegam ao arquivo no próximo frame, então o padrão é selar a
+ * cada segundo. Requer zlib (SPD_HAVE_ZLIB).
+ */
+class CompressedFileWriter {
+public:
+    static const int DEFAULT_LEVEL = 6;                     ///< Nível de compressão do zlib
+    static const size_t DEFAULT_FRAME_BYTES = 64 * 1024;    ///< Bytes sem compressão que selam um frame
+
+    /**
+     * @brief Abre o arquivo de log e o índice
+     * @param filename Nome do arquivo de log (ex: "logs.jsonl.gz")
+     * @param policy Política de flush; o intervalo também sela o frame em montagem
+     * @param level Nível de compressão do zlib (1 a 9)
+     * @param frame_bytes Bytes sem compressão acumulados que selam um frame
+     * @throws std::runtime_error se não conseguir abrir os arquivos ou não houver zlib
+     */
+    explicit CompressedFileWriter(const std::string& filename,
+                                  const FlushPolicy& policy = FlushPolicy::every_interval(std::chrono::milliseconds(1000)),
+                                  int level = DEFAULT_LEVEL,
+                                  size_t frame_bytes = DEFAULT_FRAME_BYTES)
+        : filename(filename),
+          index_filename(filename + ".idx"),
+          flush_policy(policy),
+          compression_level(level),
+          frame_limit(frame_bytes == 0 ? 1 : frame_bytes),
+          file_offset(0),
+          pending_bytes(0),
+          raw_bytes(0),
+          written_bytes(0),
+          staged_records(0),
+          staged_level(LogLevel::INFO),
+          sealed_frames(0),
+          written_frames(0),
+          stop_timer(false) {
+        if (!compression::available()) {
+            throw std::runtime_error("Compressão indisponível: compile com zlib");
+        }
+
+        {
+            std::ifstream existing(filename, std::ios::binary | std::ios::ate);
+            if (existing.is_open()) {
+                file_offset = static_cast<uint64_t>(existing.tellg());
+            }
+        }
+
+        file.open(filename, std::ios::app | std::ios::binary);
+        index.open(index_filename, std::ios::app | std::ios::binary);
+        if (!file.is_open() || !index.is_open()) {
+            throw std::runtime_error("Não foi possível abrir o arquivo de log: " + filename);
+        }
+
+        if (flush_policy.interval().count() > 0) {
+            flush_thread = std::thread(&CompressedFileWriter::flush_routine, this);
+        }
+
+        std::cout << "CompressedFileWriter criado para arquivo: " << filename << std::endl;
+    }
+
+    ~CompressedFileWriter() {
+        stop_flush_thread();
+
+        std::unique_lock<std::mutex> lock(write_mutex);
+        if (file.is_open()) {
+            try {
+                finish_locked(lock);
+            } catch (const std::exception&) {
+                // Destrutor não propaga falhas
+            }
+            file.close();
+            index.close();
+        }
+    }
+
+    /**
+     * @brief Adiciona um registro formatado ao frame em montagem
+     * @param record Registro completo, já com seu terminador
+     */
+    void append(const std::string& record) {
+        LogLevel level = flush_policy.uses_severity() ? level_from_text(record) : LogLevel::INFO;
+        append(record, level);
+    }
+
+    /**
+     * @brief Adiciona registro formatado cujo nível já é conhecido ao frame em montagem
+     * @param record Registro completo, já com seu terminador
+     * @param level Nível do registro, usado pela política de flush por severidade
+     */
+    void append(const std::string& record, LogLevel level) {
+        std::chrono::system_clock::time_point time;
+        if (!record_time(record, time)) {
+            time = std::chrono::system_clock::now();
+        }
+        stage(record.data(), record.size(), 1, time, level);
+    }
+
+    /**
+     * @brief Acrescenta um lote de registros ao frame em montagem
+     * @tparam Record Tipo do registro, acessado via append_record(),
+     * record_level() e record_time()
+     * @param records Registros, na ordem do vetor
+     *
+     * O lote é formatado fora da seção crítica e fica inteiro no mesmo frame.
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        static thread_local std::string block;
+        block.clear();
+
+        LogLevel max_level = LogLevel::INFO;
+        for (size_t i = 0; i < records.size(); ++i) {
+            append_record(block, records[i]);
+
+            if (flush_policy.uses_severity()) {
+                LogLevel level = record_level(records[i]);
+                if (level > max_level) {
+                    max_level = level;
+                }
+            }
+        }
+
+        std::chrono::system_clock::time_point first_time;
+        if (!record_time(records.front(), first_time)) {
+            first_time = std::chrono::system_clock::now();
+        }
+
+        stage(block.data(), block.size(), records.size(), first_time, max_level);
+    }
+
+    bool is_open() const {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        return file.is_open();
+    }
+
+    const std::string& get_filename() const {
+        return filename;
+    }
+
+    /**
+     * @brief Nome do arquivo de índice dos frames
+     */
+    const std::string& get_index_filename() const {
+        return index_filename;
+    }
+
+    const FlushPolicy& get_flush_policy() const {
+        return flush_policy;
+    }
+
+    /// Bytes sem compressão que selam um frame
+    size_t frame_bytes() const {
+        return frame_limit;
+    }
+
+    /**
+     * @brief Bytes recebidos antes da compressão (incluindo os ainda não selados)
+     */
+    uint64_t uncompressed_bytes() const {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        return raw_bytes;
+    }
+
+    /**
+     * @brief Bytes gravados no arquivo de log (frames comprimidos)
+     */
+    uint64_t compressed_bytes() const {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        return written_bytes;
+    }
+
+    /**
+     * @brief Bytes do frame em montagem (usado pelo MemoryBudget)
+     */
+    size_t buffered_bytes() const {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        return staged.size();
+    }
+
+    /**
+     * @brief Sela o frame em montagem e força flush do arquivo de log e do índice
+     */
+    void flush() {
+        std::unique_lock<std::mutex> lock(write_mutex);
+        if (file.is_open()) {
+            finish_locked(lock);
+            flush_locked();
+        }
+    }
+
+    /**
+     * @brief Sela o frame em montagem e fecha o arquivo de log e o índice
+     */
+    void close() {
+        stop_flush_thread();
+
+        std::unique_lock<std::mutex> lock(write_mutex);
+        if (file.is_open()) {
+            finish_locked(lock);
+            file.close();
+            index.close();
+            std::cout << "Arquivo de log fechado: " << filename << std::endl;
+        }
+    }
+
+private:
+    mutable std::mutex write_mutex;     ///< Protege os streams, o frame em montagem e os contadores
+
+    std::ofstream file;                 ///< Frames comprimidos
+    std::ofstream index;                ///< Entradas do índice
+    std::string filename;               ///< Nome do arquivo de log
+    std::string index_filename;         ///< Nome do arquivo de índice
+
+    const FlushPolicy flush_policy;     ///< Quando forçar gravação em disco
+    const int compression_level;        ///< Nível do zlib
+    const size_t frame_limit;           ///< Bytes que selam um frame
+    uint64_t file_offset;               ///< Offset do próximo frame
+    size_t pending_bytes;               ///< Bytes escritos desde o último flush
+    uint64_t raw_bytes;                 ///< Total antes da compressão
+    uint64_t written_bytes;             ///< Total de frames gravados
+
+    std::string staged;                                 ///< Registros do frame em montagem, sem compressão
+    size_t staged_records;                              ///< Registros em staged
+    std::chrono::system_clock::time_point staged_time;  ///< Primeiro registro de staged
+    LogLevel staged_level;                              ///< Maior nível em staged
+    uint64_t sealed_frames;                             ///< Frames selados (ordem de gravação)
+    uint64_t written_frames;                            ///< Frames já gravados ou abandonados
+    std::condition_variable turn_cv;                    ///< Acorda quem espera a vez de gravar
+
+    std::thread flush_thread;           ///< Thread do flush periódico (se configurado)
+    std::mutex timer_mutex;             ///< Protege stop_timer
+    std::condition_variable timer_cv;   ///< Acorda a thread de flush para encerrar
+    bool stop_timer;                    ///< Sinaliza fim da thread de flush
+
+    /**
+     * @brief Compressor da thread atual, recriado se o nível mudar
+     */
+    compression::FrameCompressor& thread_compressor() {
+        static thread_local std::unique_ptr<compression::FrameCompressor> compressor;
+        if (!compressor || compressor->level() != compression_level) {
+            compressor.reset(new compression::FrameCompressor(compression_level));
+        }
+        return *compressor;
+    }
+
+    /// Copia registros já formatados para o frame em montagem, selando-o se necessário
+    void stage(const char* data, size_t size, size_t records,
+               std::chrono::system_clock::time_point first_time, LogLevel level) {
+        std::unique_lock<std::mutex> lock(write_mutex);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Arquivo de log foi fechado inesperadamente");
+        }
+
+        if (staged_records == 0) {
+            staged_time = first_time;
+            staged_level = LogLevel::INFO;
+        }
+        staged.append(data, size);
+        staged_records += records;
+        if (level > staged_level) {
+            staged_level = level;
+        }
+        raw_bytes += size;
+
+        bool urgent = flush_policy.uses_severity() && level >= flush_policy.severity();
+        if (staged.size() >= frame_limit || urgent) {
+            seal_locked(lock);
+        }
+    }
+
+    /**
+     * @brief Sela o frame em montagem, comprime sem o lock e o grava na sua vez
+     * @param lock Lock de write_mutex, mantido na entrada e na saída
+     */
+    void seal_locked(std::unique_lock<std::mutex>& lock) {
+        if (staged_records == 0) {
+            return;
+        }
+
+        static thread_local std::string data;
+        data.clear();
+        data.swap(staged);
+
+        FrameIndexEntry entry;
+        entry.record_count = static_cast<uint32_t>(staged_records);
+        entry.first_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            staged_time.time_since_epoch()).count();
+        LogLevel level = staged_level;
+        uint64_t ticket = sealed_frames++;
+        staged_records = 0;
+
+        lock.unlock();
+        static thread_local std::string frame;
+        bool compressed = thread_compressor().compress(data.data(), data.size(), frame);
+        lock.lock();
+
+        // Frames entram no arquivo na ordem em que foram selados
+        turn_cv.wait(lock, [this, ticket]() { return written_frames == ticket; });
+        ++written_frames;
+        turn_cv.notify_all();
+
+        if (!compressed) {
+            throw std::runtime_error("Falha ao comprimir frame de " + filename);
+        }
+        if (!file.is_open()) {
+            throw std::runtime_error("Arquivo de log foi fechado inesperadamente");
+        }
+
+        entry.offset = file_offset;
+        entry.compressed_size = static_cast<uint32_t>(frame.size());
+        char encoded[FrameIndexEntry::ENCODED_SIZE];
+        entry.encode(encoded);
+
+        file.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        index.write(encoded, sizeof(encoded));
+
+        file_offset += frame.size();
+        written_bytes += frame.size();
+
+        pending_bytes += frame.size();
+        if (flush_policy.should_flush(pending_bytes, level)) {
+            flush_locked();
+        }
+    }
+
+    /// Sela o frame em montagem e espera os frames selados por outras threads serem gravados
+    void finish_locked(std::unique_lock<std::mutex>& lock) {
+        seal_locked(lock);
+        turn_cv.wait(lock, [this]() { return written_frames == sealed_frames; });
+    }
+
+    void flush_locked() {
+        file.flush();
+        index.flush();
+        pending_bytes = 0;
+    }
+
+    void flush_routine() {
+        std::unique_lock<std::mutex> timer_lock(timer_mutex);
+
+        while (!timer_cv.wait_for(timer_lock, flush_policy.interval(), [this]() { return stop_timer; })) {
+            try {
+                std::unique_lock<std::mutex> lock(write_mutex);
+                if (file.is_open() && (staged_records > 0 || pending_bytes > 0)) {
+                    seal_locked(lock);
+                    flush_locked();
+                }
+            } catch (const std::exception& e) {
+                std::cout << "Erro no flush periódico de " << filename << " -> " << e.what() << std::endl;
+            }
+        }
+    }
+
+    void stop_flush_thread() {
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex);
+            stop_timer = true;
+        }
+        timer_cv.notify_all();
+
+        if (flush_thread.joinable()) {
+            flush_thread.join();
+        }
+    }
+
+    // Desabilita cópia para evitar problemas com mutex
+    CompressedFileWriter(const CompressedFileWriter&) = delete;
+    CompressedFileWriter& operator=(const CompressedFileWriter&) = delete;
+};
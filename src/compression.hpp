@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#if defined(SPD_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+/**
+ * @brief Compressão de arquivos de log
+ *
+ * Usa o zlib quando o projeto é compilado com SPD_HAVE_ZLIB (o CMake
+ * define a macro ao encontrar a biblioteca); sem ele, available() retorna
+ * false e as funções não fazem nada.
+ */
+namespace compression {
+    /**
+     * @brief Indica se há suporte a compressão nesta compilação
+     */
+    inline bool available() {
+#if defined(SPD_HAVE_ZLIB)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Comprime um arquivo em formato gzip
+     * @param source Arquivo original (não é removido)
+     * @param target Arquivo .gz a ser criado
+     * @param level Nível de compressão do zlib (1 a 9)
+     * @return true se o arquivo comprimido foi escrito por completo
+     */
+    inline bool gzip_file(const std::string& source, const std::string& target, int level = 6) {
+#if defined(SPD_HAVE_ZLIB)
+        std::FILE* in = std::fopen(source.c_str(), "rb");
+        if (in == nullptr) {
+            return false;
+        }
+
+        std::string mode = "wb" + std::to_string(level);
+        gzFile out = gzopen(target.c_str(), mode.c_str());
+        if (out == nullptr) {
+            std::fclose(in);
+            return false;
+        }
+
+        std::vector<char> buffer(256 * 1024);
+        bool ok = true;
+        size_t read = 0;
+        while (ok && (read = std::fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+            ok = gzwrite(out, buffer.data(), static_cast<unsigned>(read)) == static_cast<int>(read);
+        }
+        ok = ok && !std::ferror(in);
+
+        std::fclose(in);
+        ok = gzclose(out) == Z_OK && ok;
+        if (!ok) {
+            std::remove(target.c_str());
+        }
+        return ok;
+#else
+        (void)source;
+        (void)target;
+        (void)level;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Comprime blocos em frames gzip independentes, reaproveitando o estado
+     *
+     * Cada chamada de compress() gera um membro gzip completo; membros
+     * concatenados formam um arquivo .gz válido (zcat lê todos), e cada um
+     * pode ser descomprimido sozinho a partir do seu offset.
+     */
+    class FrameCompressor {
+    public:
+        /**
+         * @param level Nível de compressão do zlib (1 a 9)
+         * @throws std::runtime_error se não houver zlib ou o nível for inválido
+         */
+        explicit FrameCompressor(int level) : compression_level(level) {
+#if defined(SPD_HAVE_ZLIB)
+            stream.zalloc = Z_NULL;
+            stream.zfree = Z_NULL;
+            stream.opaque = Z_NULL;
+            // windowBits 15 + 16: deflate com cabeçalho e rodapé gzip
+            if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw std::runtime_error("Não foi possível iniciar o compressor zlib");
+            }
+#else
+            throw std::runtime_error("Compressão indisponível: compile com zlib");
+#endif
+        }
+
+        ~FrameCompressor() {
+#if defined(SPD_HAVE_ZLIB)
+            deflateEnd(&stream);
+#endif
+        }
+
+        int level() const {
+            return compression_level;
+        }
+
+        /**
+         * @brief Comprime data em um frame, substituindo o conteúdo de out
+         * @return false se o zlib falhar
+         */
+        bool compress(const char* data, size_t size, std::string& out) {
+#if defined(SPD_HAVE_ZLIB)
+            if (deflateReset(&stream) != Z_OK) {
+                return false;
+            }
+
+            out.resize(deflateBound(&stream, static_cast<uLong>(size)));
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            stream.avail_in = static_cast<uInt>(size);
+            stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+            stream.avail_out = static_cast<uInt>(out.size());
+
+            int status = deflate(&stream, Z_FINISH);
+            out.resize(stream.total_out);
+            return status == Z_STREAM_END;
+#else
+            (void)data;
+            (void)size;
+            (void)out;
+            return false;
+#endif
+        }
+
+    private:
+        int compression_level;      ///< Nível usado em deflateInit2
+#if defined(SPD_HAVE_ZLIB)
+        z_stream stream;            ///< Estado do deflate, reiniciado a cada frame
+#endif
+
+        FrameCompressor(const FrameCompressor&) = delete;
+        FrameCompressor& operator=(const FrameCompressor&) = delete;
+    };
+
+    /**
+     * @brief Descomprime um frame gzip, acrescentando o resultado a out
+     * @return false se o frame estiver corrompido ou não houver zlib
+     */
+    inline bool decompress_frame(const char* data, size_t size, std::string& out) {
+#if defined(SPD_HAVE_ZLIB)
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = static_cast<uInt>(size);
+        if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+            return false;
+        }
+
+        char buffer[64 * 1024];
+        int status = Z_OK;
+        while (status == Z_OK) {
+            stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = sizeof(buffer);
+            status = inflate(&stream, Z_NO_FLUSH);
+            out.append(buffer, sizeof(buffer) - stream.avail_out);
+        }
+
+        inflateEnd(&stream);
+        return status == Z_STREAM_END;
+#else
+        (void)data;
+        (void)size;
+        (void)out;
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+
+#include "log_level.hpp"
+#include "record.hpp"
+
+/**
+ * @brief Configuração do ConsoleWriter
+ *
+ * Exemplo: apenas WARNING e ERROR, no máximo 50 registros por segundo, em stderr:
+ * @code
+ * ConsoleOptions::defaults().with_min_level(LogLevel::WARNING).with_rate_limit(50).to_stderr()
+ * @endcode
+ */
+class ConsoleOptions {
+public:
+    /// Todos os níveis, sem limite de taxa, fila de 1 MiB, em stdout
+    static ConsoleOptions defaults() {
+        return ConsoleOptions();
+    }
+
+    /// Registros abaixo deste nível não vão para o console
+    ConsoleOptions with_min_level(LogLevel level) const {
+        ConsoleOptions options(*this);
+        options.level = level;
+        return options;
+    }
+
+    /**
+     * @brief Limita a saída a records_per_second registros por segundo (0 = sem limite)
+     *
+     * Admite rajadas de até um segundo de registros; o excedente é descartado
+     * e contado em uma linha de aviso, exibida no máximo uma vez por segundo.
+     */
+    ConsoleOptions with_rate_limit(size_t records_per_second) const {
+        ConsoleOptions options(*this);
+        options.rate = records_per_second;
+        return options;
+    }
+
+    /// Bytes aguardando a thread do console; acima disso os registros são descartados
+    ConsoleOptions with_queue_bytes(size_t bytes) const {
+        ConsoleOptions options(*this);
+        options.queue_limit = bytes;
+        return options;
+    }
+
+    /// Escreve em stderr em vez de stdout
+    ConsoleOptions to_stderr() const {
+        ConsoleOptions options(*this);
+        options.use_stderr = true;
+        return options;
+    }
+
+    LogLevel min_level() const { return level; }
+    size_t rate_limit() const { return rate; }
+    size_t queue_bytes() const { return queue_limit; }
+    bool uses_stderr() const { return use_stderr; }
+
+private:
+    LogLevel level;             ///< Nível mínimo exibido
+    size_t rate;                ///< Registros por segundo (0 = sem limite)
+    size_t queue_limit;         ///< Bytes máximos na fila
+    bool use_stderr;            ///< Saída em stderr
+
+    ConsoleOptions() : level(LogLevel::INFO), rate(0), queue_limit(1024 * 1024), use_stderr(false) {}
+};
+
+/**
+ * @brief Escritor que exibe os registros no console sem bloquear o pipeline
+ *
+ * Mesma interface de escrita do FileWriter (append, append_batch, flush,
+ * close), para ser usado como escritor de um Consumer ou ao lado de outro
+ * escritor com TeeWriter. Os registros filtrados por nível e pelo limite
+ * de taxa são descartados antes de qualquer formatação; os demais vão para
+ * uma fila limitada, escrita por uma thread própria com um único fwrite por
+ * lote, então nenhum consumer espera pelo lock de stdout.
+ */
+class ConsoleWriter {
+public:
+    /**
+     * @param options Nível mínimo, limite de taxa, tamanho da fila e saída
+     */
+    explicit ConsoleWriter(const ConsoleOptions& options = ConsoleOptions::defaults())
+        : options(options),
+          output(options.uses_stderr() ? stderr : stdout),
+          tokens(static_cast<double>(options.rate_limit())),
+          last_refill(std::chrono::steady_clock::now()),
+          suppressed(0),
+          overflowed(0),
+          writing(false),
+          block_bytes(0),
+          accepting(true) {
+        writer_thread = std::thread(&ConsoleWriter::writer_routine, this);
+    }
+
+    ~ConsoleWriter() {
+        close();
+    }
+
+    /// Exibe um registro formatado (nível extraído do texto)
+    void append(const std::string& record) {
+        append(record, level_from_text(record));
+    }
+
+    /// Exibe um registro formatado cujo nível já é conhecido
+    void append(const std::string& record, LogLevel level) {
+        if (level < options.min_level()) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (take_tokens(1) == 1) {
+            enqueue(record.data(), record.size());
+        }
+    }
+
+    /**
+     * @brief Exibe os registros do lote que passam pelo nível e pelo limite de taxa
+     * @tparam Record Tipo do registro, acessado via append_record() e record_level()
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        static thread_local std::string block;
+        block.clear();
+
+        size_t selected = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (record_level(records[i]) >= options.min_level()) {
+                ++selected;
+            }
+        }
+        if (selected == 0) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        size_t allowed = take_tokens(selected);
+        lock.unlock();
+
+        // Formata fora do lock apenas os registros que serão exibidos
+        for (size_t i = 0; i < records.size() && allowed > 0; ++i) {
+            if (record_level(records[i]) >= options.min_level()) {
+                append_record(block, records[i]);
+                --allowed;
+            }
+        }
+
+        lock.lock();
+        enqueue(block.data(), block.size());
+    }
+
+    bool is_open() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return accepting;
+    }
+
+    const ConsoleOptions& get_options() const {
+        return options;
+    }
+
+    /**
+     * @brief Bytes retidos pela fila e pelo bloco em escrita (usado pelo MemoryBudget)
+     */
+    size_t buffered_bytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size() + block_bytes;
+    }
+
+    /**
+     * @brief Espera a fila atual ser escrita no console
+     */
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this]() { return (queue.empty() && !writing) || !accepting; });
+    }
+
+    /**
+     * @brief Escreve o que estiver na fila e encerra a thread do console
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!accepting) {
+                return;
+            }
+            accepting = false;
+        }
+        not_empty.notify_all();
+
+        if (writer_thread.joinable()) {
+            writer_thread.join();
+        }
+        drained.notify_all();
+    }
+
+private:
+    const ConsoleOptions options;       ///< Configuração
+    std::FILE* output;                  ///< stdout ou stderr
+
+    mutable std::mutex mutex;           ///< Protege fila, tokens e contadores
+    std::condition_variable not_empty;  ///< Acorda a thread do console
+    std::condition_variable drained;    ///< Sinaliza fila escrita (flush)
+    std::string queue;                  ///< Texto aguardando a thread do console
+
+    double tokens;                      ///< Registros ainda permitidos (balde de fichas)
+    std::chrono::steady_clock::time_point last_refill;   ///< Última recarga do balde
+    size_t suppressed;                  ///< Descartados pelo limite de taxa desde o último aviso
+    size_t overflowed;                  ///< Descartados por fila cheia desde o último aviso
+
+    bool writing;                       ///< Thread do console escrevendo um lote
+    size_t block_bytes;                 ///< Tamanho do bloco em escrita
+    bool accepting;                     ///< false após close()
+    std::thread writer_thread;          ///< Thread que escreve no console
+
+    /**
+     * @brief Retira até wanted fichas do balde (chamado com mutex)
+     * @return Quantos registros podem ser exibidos; o restante é contado como suprimido
+     */
+    size_t take_tokens(size_t wanted) {
+        if (options.rate_limit() == 0) {
+            return wanted;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double rate = static_cast<double>(options.rate_limit());
+        tokens += std::chrono::duration<double>(now - last_refill).count() * rate;
+        if (tokens > rate) {
+            tokens = rate;
+        }
+        last_refill = now;
+
+        size_t allowed = tokens >= static_cast<double>(wanted) ? wanted : static_cast<size_t>(tokens);
+        tokens -= static_cast<double>(allowed);
+        suppressed += wanted - allowed;
+        return allowed;
+    }
+
+    /// Acrescenta texto à fila (chamado com mutex)
+    void enqueue(const char* data, size_t size) {
+        if (size == 0 || !accepting) {
+            return;
+        }
+        if (queue.size() + size > options.queue_bytes()) {
+            ++overflowed;
+            return;
+        }
+
+        bool was_empty = queue.empty();
+        queue.append(data, size);
+        if (was_empty) {
+            not_empty.notify_one();
+        }
+    }
+
+    /**
+     * @brief Rotina da thread do console: troca a fila por um bloco vazio e o escreve sem lock
+     */
+    void writer_routine() {
+        std::string block;
+        std::chrono::steady_clock::time_point last_report = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+
+        for (;;) {
+            not_empty.wait(lock, [this]() { return !queue.empty() || !accepting; });
+            if (queue.empty() && !accepting) {
+                break;
+            }
+
+            block.clear();
+            block.swap(queue);
+
+            // Avisos de descarte no máximo uma vez por segundo (e sempre no close)
+            size_t rate_drops = 0;
+            size_t queue_drops = 0;
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (now - last_report >= std::chrono::seconds(1) || !accepting) {
+                rate_drops = suppressed;
+                queue_drops = overflowed;
+                suppressed = 0;
+                overflowed = 0;
+                last_report = now;
+            }
+            writing = true;
+            block_bytes = block.size();
+            lock.unlock();
+
+            std::fwrite(block.data(), 1, block.size(), output);
+            if (rate_drops > 0) {
+                std::fprintf(output, "[console] %zu registros omitidos pelo limite de taxa\n", rate_drops);
+            }
+            if (queue_drops > 0) {
+                std::fprintf(output, "[console] %zu lotes descartados com a fila cheia\n", queue_drops);
+            }
+            std::fflush(output);
+
+            lock.lock();
+            writing = false;
+            block_bytes = 0;
+            drained.notify_all();
+        }
+
+        if (suppressed > 0 || overflowed > 0) {
+            std::fprintf(output, "[console] %zu registros omitidos pelo limite de taxa, %zu lotes descartados com a fila cheia\n",
+                         suppressed, overflowed);
+            std::fflush(output);
+        }
+    }
+
+    // Desabilita cópia, a thread do console referencia esta instância
+    ConsoleWriter(const ConsoleWriter&) = delete;
+    ConsoleWriter& operator=(const ConsoleWriter&) = delete;
+};
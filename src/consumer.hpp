@@ -3,9 +3,16 @@
 #include <exception>
 #include <thread>
 #include <string>
+#include <vector>
 #include <atomic>
+#include <chrono>
 #include <iostream>
 
+#include "record.hpp"
+#include "metrics.hpp"
+#include "memory_budget.hpp"
+#include "cpu_affinity.hpp"
+
 
 template<typename LogBuffer, typename FileWriter>
 class Consumer {
@@ -13,14 +20,23 @@ public:
     /**
      * @brief Construtor que inicializa consumer com buffer, ID e arquivo de saída
      * @param buffer Referência para buffer de onde logs serão consumidos
+     * @param log_writer Referência para o escritor onde logs serão gravados
      * @param consumer_id ID único deste consumer
-     * @param filename Nome do arquivo onde logs serão escritos (padrão: "log.json")
+     * @param batch_size Número máximo de mensagens retiradas do buffer por vez
+     * @param metrics Registro opcional de métricas (profundidade da fila, latências, vazão)
      */
-    Consumer(LogBuffer& buffer, FileWriter& log_writer, int consumer_id)
+    Consumer(LogBuffer& buffer, FileWriter& log_writer, int consumer_id, size_t batch_size = DEFAULT_BATCH_SIZE,
+             MetricsRegistry* metrics = nullptr)
         : buffer_ref(buffer),
+          log_writer(log_writer),
           consumer_id(consumer_id),
+          batch_size(batch_size == 0 ? 1 : batch_size),
+          metrics(metrics),
           is_running(false),
-          log_writer(log_writer) {}
+          draining(false),
+          drain_deadline(0),
+          written(0),
+          finished(false) {}
 
     ~Consumer() {
         stop();
@@ -33,7 +49,7 @@ public:
      * Não faz nada se já estiver rodando.
      */
     void start() {
-        if (is_running.load()) {
+        if (is_running.load() || worker_thread.joinable()) {
             std::cout << "Consumer [" << consumer_id << "] já iniciado." << std::endl;
             return;
         }
@@ -49,9 +65,13 @@ public:
      *
      * Sinaliza para a thread parar e aguarda sua finalização.
      * Operação segura - pode ser chamada múltiplas vezes.
+     *
+     * A thread só percebe o sinal entre lotes: com o buffer vazio ela está
+     * dormindo no pop_batch(), então o buffer deve ser fechado com
+     * shutdown() antes (como em main.cpp).
      */
     void stop() {
-        if (!is_running.load()) {
+        if (!worker_thread.joinable()) {
             return;
         }
 
@@ -64,14 +84,93 @@ public:
         std::cout << "Consumer [" << consumer_id << "] parado..." << std::endl;
     }
 
+    /**
+     * @brief Grava o que restar no buffer, em lotes cheios, até ele esvaziar ou o prazo acabar
+     * @param deadline Instante a partir do qual a thread para, mesmo com registros no buffer
+     *
+     * Diferente de stop(), que pode sair com registros ainda na fila. O
+     * prazo só é verificado entre lotes, então o buffer deve ter sido
+     * fechado com shutdown(): aberto e com a fila vazia, a thread fica
+     * bloqueada no pop_batch() até chegar um registro, mesmo depois do
+     * prazo. Um lote em gravação também termina antes de a thread sair.
+     * Quando há vários consumers, chamar drain() em sequência com o mesmo
+     * prazo é suficiente: os demais continuam consumindo enquanto o
+     * primeiro é aguardado.
+     * Ver drain_pipeline() em drain.hpp.
+     */
+    void drain(std::chrono::steady_clock::time_point deadline) {
+        if (!is_running.load()) {
+            return;
+        }
+
+        drain_deadline.store(deadline.time_since_epoch().count());
+        draining.store(true);
+        is_running.store(false);
+
+        if (worker_thread.joinable()) {
+            worker_thread.join();
+        }
+        draining.store(false);
+
+        std::cout << "Consumer [" << consumer_id << "] drenado..." << std::endl;
+    }
+
+    /**
+     * @brief Pede que a thread pare após o lote atual, sem esperar por ela
+     *
+     * Usado pelo ConsumerPool para reduzir o número de consumers: a thread
+     * termina o lote em andamento (ou, dormindo no buffer vazio, o próximo
+     * que retirar) e sai; is_finished() indica quando stop() não vai mais
+     * bloquear.
+     */
+    void retire() {
+        is_running.store(false);
+    }
+
+    /// A thread saiu da rotina de consumo (pronta para stop())
+    bool is_finished() const {
+        return finished.load();
+    }
+
+    /**
+     * @brief Núcleos onde a thread de consumo deve rodar
+     * @param cpu_list Núcleos permitidos (vazio = sem fixação); vale a partir do próximo start()
+     */
+    void set_cpu_affinity(const std::vector<int>& cpu_list) {
+        cpus = cpu_list;
+    }
+
+    /// Registros entregues ao escritor desde a criação
+    uint64_t records_written() const {
+        return written.load(std::memory_order_relaxed);
+    }
+
+    static const size_t DEFAULT_BATCH_SIZE = 64;   ///< Tamanho padrão do lote
+
 private:
     LogBuffer& buffer_ref;              ///< Referência ao buffer de logs
     FileWriter& log_writer;             ///< Referência ao escritor de arquivo
 
     int consumer_id;                    ///< ID único deste consumer
+    size_t batch_size;                  ///< Máximo de mensagens por lote
+    MetricsRegistry* metrics;           ///< Métricas do pipeline (nullptr = desativadas)
 
     std::thread worker_thread;          ///< Thread dedicada para consumo
     std::atomic<bool> is_running;       ///< Flag thread-safe para controle de execução
+    std::atomic<bool> draining;         ///< drain() em andamento: continua até o prazo
+    std::atomic<std::chrono::steady_clock::rep> drain_deadline;    ///< Prazo do drain()
+    std::atomic<uint64_t> written;      ///< Registros entregues ao escritor
+    std::atomic<bool> finished;         ///< writing_routine() retornou
+    std::vector<int> cpus;              ///< Núcleos da thread (vazio = sem fixação)
+
+    /// Continua consumindo: rodando, ou drenando dentro do prazo
+    bool keeps_consuming() const {
+        if (is_running.load()) {
+            return true;
+        }
+        return draining.load() &&
+               std::chrono::steady_clock::now().time_since_epoch().count() < drain_deadline.load();
+    }
 
     /**
      * @brief Rotina principal executada na thread separada
@@ -80,26 +179,48 @@ private:
      * sinal de parada. Trata exceções para evitar crash da thread.
      *
      * A rotina funciona de forma que:
-     * - Tenta consumir mensagens enquanto o consumer estiver rodando
-     * - Se buffer.pop() retorna false (buffer vazio), verifica se deve continuar
-     * - Se is_running for false, para o loop
-     * - Inclui pequeno delay para evitar busy-waiting excessivo
+     * - Retira do buffer lotes de até batch_size mensagens
+     * - Cada lote é gravado com uma única chamada a append_batch(); para ver os
+     *   registros no terminal, use um ConsoleWriter como escritor (ou com TeeWriter)
+     * - Com o buffer vazio, pop_batch() espera sem consumir CPU (sem polling)
+     * - Se buffer.pop_batch() retorna 0 (buffer fechado e vazio), encerra
+     * - Se is_running for false, para o loop (em drain(), só após o prazo)
+     * - Com um MemoryBudget no buffer, o lote conta como MemoryArea::BATCHES
+     *   até ser gravado, e os buffers do escritor (buffered_bytes()) são
+     *   informados como MemoryArea::WRITER após cada lote
      */
     void writing_routine() {
-        try {
-            std::string message;
+        if (!cpus.empty() && !affinity::pin_current_thread(cpus)) {
+            std::cout << "Consumer [" << consumer_id << "] sem fixação de núcleo" << std::endl;
+        }
 
-            while (is_running.load()) {
-                if (buffer_ref.pop(message)) {
-                    log_writer.append(message);
+        MemoryBudget* budget = memory_budget::of(buffer_ref);
+        size_t batch_bytes = 0;
+        try {
+            std::vector<typename LogBuffer::value_type> batch;
+            batch.reserve(batch_size);
 
-                    // Log no terminal sem quebrar a mensagem
-                    std::ostringstream oss;
-                    oss << "\n[CONSUMER " << consumer_id << "] processou: " << message;
-                    std::cout << oss.str() << std::endl;
+            while (keeps_consuming() && buffer_ref.pop_batch(batch, batch_size) > 0) {
+                if (budget != nullptr) {
+                    for (size_t i = 0; i < batch.size(); ++i) {
+                        batch_bytes += record_memory(batch[i]);
+                    }
+                    budget->add(MemoryArea::BATCHES, batch_bytes);
+                }
 
+                if (metrics != nullptr) {
+                    write_measured(batch);
                 } else {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    log_writer.append_batch(batch);
+                }
+                written.fetch_add(batch.size(), std::memory_order_relaxed);
+
+                // Descarta os registros já gravados (devolve posições do slab)
+                batch.clear();
+                if (budget != nullptr) {
+                    budget->release(MemoryArea::BATCHES, batch_bytes);
+                    batch_bytes = 0;
+                    budget->set(MemoryArea::WRITER, memory_budget::writer_bytes(log_writer));
                 }
             }
         } catch (const std::exception& e) {
@@ -107,6 +228,61 @@ private:
                 << "Erro em consumer [" << consumer_id << "] -> "
                 << e.what()
                 << std::endl;
+            if (budget != nullptr) {
+                budget->release(MemoryArea::BATCHES, batch_bytes);
+            }
         }
+        finished.store(true);
+    }
+
+    /**
+     * @brief Grava o lote registrando profundidade da fila, latências e volume
+     *
+     * A latência na fila parte do instante gravado no registro (record_time):
+     * exata para LogEvent e com a precisão de milissegundos do timestamp
+     * para registros já formatados. MetricLatency::APPEND vai da saída do
+     * buffer até append_batch() retornar: escritores assíncronos (ou com
+     * flush por intervalo) ainda não gravaram o lote em disco nesse ponto.
+     *
+     * Os bytes são os de registros já formatados (record_size) ou, para
+     * LogEvent, uma estimativa (record_size_estimate): o registro nunca é
+     * formatado só para ser medido.
+     */
+    void write_measured(const std::vector<typename LogBuffer::value_type>& batch) {
+        // Profundidade antes deste pop_batch: o que restou mais o que foi retirado
+        metrics->observe_queue_depth(buffer_ref.size() + batch.size());
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::chrono::system_clock::time_point dequeued = std::chrono::system_clock::now();
+        std::chrono::system_clock::time_point created;
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (record_time(batch[i], created)) {
+                metrics->record_latency(MetricLatency::QUEUE,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(dequeued - created));
+            }
+            bytes += record_bytes(batch[i], 0);
+        }
+
+        log_writer.append_batch(batch);
+        metrics->record_latency(MetricLatency::APPEND,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start),
+            batch.size());
+
+        metrics->add(MetricCounter::RECORDS_WRITTEN, batch.size());
+        metrics->add(MetricCounter::BYTES_WRITTEN, bytes);
+        metrics->add(MetricCounter::BATCHES_WRITTEN);
+    }
+
+    /// Tamanho de registros já formatados, sem cópia
+    template<typename Record>
+    static auto record_bytes(const Record& record, int) -> decltype(record_size(record)) {
+        return record_size(record);
+    }
+
+    /// Registros formatados só pelo escritor (ex: LogEvent) têm o tamanho estimado
+    template<typename Record>
+    static size_t record_bytes(const Record& record, long) {
+        return record_size_estimate(record);
     }
 };
@@ -0,0 +1,444 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <condition_variable>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include "consumer.hpp"
+#include "cpu_affinity.hpp"
+#include "metrics.hpp"
+
+/**
+ * @brief Configuração do ConsumerPool: quantos consumers e em quais núcleos
+ *
+ * Um pool adaptativo começa com o mínimo de consumers e, a cada intervalo,
+ * compara a profundidade do buffer com duas marcas (frações da capacidade):
+ * acima da marca alta e sem diminuir desde a amostra anterior (os consumers
+ * não estão vencendo a chegada), adiciona um consumer; abaixo da marca
+ * baixa por with_idle_intervals() amostras seguidas, retira um. Exemplo:
+ * entre 2 e 8 consumers fixados nos núcleos do nó NUMA 1:
+ * @code
+ * PoolOptions::adaptive(2, 8).with_numa_node(1)
+ * @endcode
+ */
+class PoolOptions {
+public:
+    /**
+     * @brief Número fixo de consumers
+     * @param consumers Quantidade de consumers (mínimo 1)
+     */
+    static PoolOptions fixed(size_t consumers) {
+        return adaptive(consumers, consumers);
+    }
+
+    /**
+     * @brief Número de consumers ajustado pela profundidade do buffer
+     * @param min_consumers Consumers sempre ativos (mínimo 1)
+     * @param max_consumers Limite de consumers
+     * @throws std::invalid_argument se max_consumers < min_consumers
+     */
+    static PoolOptions adaptive(size_t min_consumers, size_t max_consumers) {
+        if (min_consumers == 0) {
+            min_consumers = 1;
+        }
+        if (max_consumers < min_consumers) {
+            throw std::invalid_argument("Máximo de consumers menor que o mínimo");
+        }
+        PoolOptions options;
+        options.minimum = min_consumers;
+        options.maximum = max_consumers;
+        return options;
+    }
+
+    /// Intervalo entre amostras da fila (padrão: 100 ms)
+    PoolOptions with_scale_interval(std::chrono::milliseconds interval) const {
+        PoolOptions options(*this);
+        options.interval = interval.count() > 0 ? interval : std::chrono::milliseconds(1);
+        return options;
+    }
+
+    /**
+     * @brief Marcas de ocupação do buffer, em fração da capacidade
+     * @param low Abaixo dela a fila é considerada ociosa (padrão: 0.05)
+     * @param high A partir dela a fila é considerada atrasada (padrão: 0.5)
+     * @throws std::invalid_argument se não valer 0 <= low < high <= 1
+     */
+    PoolOptions with_watermarks(double low, double high) const {
+        if (low < 0.0 || high > 1.0 || low >= high) {
+            throw std::invalid_argument("Marcas de ocupação inválidas");
+        }
+        PoolOptions options(*this);
+        options.low_mark = low;
+        options.high_mark = high;
+        return options;
+    }
+
+    /// Amostras ociosas seguidas antes de retirar um consumer (padrão: 10)
+    PoolOptions with_idle_intervals(size_t samples) const {
+        PoolOptions options(*this);
+        options.idle_samples = samples > 0 ? samples : 1;
+        return options;
+    }
+
+    /**
+     * @brief Núcleos reservados aos consumers
+     * @param cpu_list Cada consumer é fixado em um deles, escolhendo o menos ocupado
+     */
+    PoolOptions with_cpus(const std::vector<int>& cpu_list) const {
+        PoolOptions options(*this);
+        options.cpus = cpu_list;
+        return options;
+    }
+
+    /**
+     * @brief Usa os núcleos de um nó NUMA (lidos do sistema)
+     *
+     * Se o nó não existir, ou fora do Linux, os consumers ficam sem fixação.
+     */
+    PoolOptions with_numa_node(int node) const {
+        return with_cpus(affinity::cpus_of_numa_node(node));
+    }
+
+    /// Máximo de mensagens por lote de cada consumer
+    PoolOptions with_batch_size(size_t size) const {
+        PoolOptions options(*this);
+        options.batch = size > 0 ? size : 1;
+        return options;
+    }
+
+    size_t min_consumers() const { return minimum; }
+    size_t max_consumers() const { return maximum; }
+    bool is_adaptive() const { return maximum > minimum; }
+    std::chrono::milliseconds scale_interval() const { return interval; }
+    double low_watermark() const { return low_mark; }
+    double high_watermark() const { return high_mark; }
+    size_t idle_intervals() const { return idle_samples; }
+    const std::vector<int>& cpu_list() const { return cpus; }
+    size_t batch_size() const { return batch; }
+
+private:
+    size_t minimum;                             ///< Consumers sempre ativos
+    size_t maximum;                             ///< Limite de consumers
+    std::chrono::milliseconds interval;         ///< Intervalo entre amostras
+    double low_mark;                            ///< Fila ociosa abaixo desta fração
+    double high_mark;                           ///< Fila atrasada a partir desta fração
+    size_t idle_samples;                        ///< Amostras ociosas antes de reduzir
+    std::vector<int> cpus;                      ///< Núcleos dos consumers (vazio = sem fixação)
+    size_t batch;                               ///< Tamanho do lote
+
+    PoolOptions()
+        : minimum(1),
+          maximum(1),
+          interval(100),
+          low_mark(0.05),
+          high_mark(0.5),
+          idle_samples(10),
+          batch(64) {}
+};
+
+/**
+ * @brief Conjunto de consumers sobre um buffer, com quantidade ajustada à carga
+ *
+ * Substitui um número fixo de Consumer: uma thread de controle amostra a
+ * profundidade do buffer e a vazão dos consumers a cada intervalo e
+ * adiciona ou retira consumers entre os limites de PoolOptions. Um
+ * consumer retirado termina o lote em andamento e sai, sem perder
+ * registros. Com with_cpus()/with_numa_node(), cada consumer é fixado em
+ * um único núcleo, e não migra levando o cache consigo.
+ *
+ * Tem a mesma interface de parada do Consumer (stop(), drain(),
+ * records_written()), então pode ser passado a drain_pipeline().
+ *
+ * @tparam LogBuffer Buffer com pop_batch(), size() e capacity()
+ * @tparam FileWriter Escritor compartilhado pelos consumers
+ */
+template<typename LogBuffer, typename FileWriter>
+class ConsumerPool {
+public:
+    typedef Consumer<LogBuffer, FileWriter> ConsumerType;
+
+    /**
+     * @brief Construtor
+     * @param buffer Buffer de onde os logs serão consumidos
+     * @param log_writer Escritor compartilhado pelos consumers
+     * @param options Limites, intervalo de ajuste e núcleos
+     * @param first_id ID do primeiro consumer; os seguintes são numerados em sequência
+     * @param metrics Registro opcional de métricas, repassado aos consumers
+     */
+    ConsumerPool(LogBuffer& buffer, FileWriter& log_writer, const PoolOptions& options = PoolOptions::fixed(2),
+                 int first_id = 1, MetricsRegistry* metrics = nullptr)
+        : buffer_ref(buffer),
+          log_writer(log_writer),
+          options(options),
+          next_id(first_id),
+          metrics(metrics),
+          cpu_load(options.cpu_list().size(), 0),
+          retired_written(0),
+          is_running(false),
+          stop_scaler(false),
+          last_rate(0),
+          grown(0),
+          shrunk(0) {}
+
+    ~ConsumerPool() {
+        stop();
+    }
+
+    /**
+     * @brief Inicia o mínimo de consumers e, se adaptativo, a thread de controle
+     */
+    void start() {
+        if (is_running.load()) {
+            return;
+        }
+        is_running.store(true);
+
+        {
+            std::lock_guard<std::mutex> lock(workers_mutex);
+            while (active.size() < options.min_consumers()) {
+                add_worker();
+            }
+        }
+
+        if (options.is_adaptive()) {
+            stop_scaler = false;
+            scaler_thread = std::thread(&ConsumerPool::scaler_routine, this);
+        }
+    }
+
+    /**
+     * @brief Para a thread de controle e todos os consumers
+     *
+     * Como em Consumer::stop(), o buffer deve ser fechado com shutdown()
+     * antes, para acordar consumers dormindo no buffer vazio.
+     */
+    void stop() {
+        if (!is_running.load()) {
+            return;
+        }
+        stop_scaling();
+
+        std::lock_guard<std::mutex> lock(workers_mutex);
+        for (size_t i = 0; i < active.size(); ++i) {
+            active[i].consumer->stop();
+        }
+        reap_all();
+        is_running.store(false);
+    }
+
+    /**
+     * @brief Drena o buffer com todos os consumers ativos (ver Consumer::drain())
+     * @param deadline Instante a partir do qual os consumers param
+     */
+    void drain(std::chrono::steady_clock::time_point deadline) {
+        if (!is_running.load()) {
+            return;
+        }
+        stop_scaling();
+
+        std::lock_guard<std::mutex> lock(workers_mutex);
+        for (size_t i = 0; i < active.size(); ++i) {
+            active[i].consumer->drain(deadline);
+        }
+        reap_all();
+        is_running.store(false);
+    }
+
+    /// Registros entregues ao escritor por todos os consumers, inclusive os já retirados
+    uint64_t records_written() const {
+        std::lock_guard<std::mutex> lock(workers_mutex);
+        return written_locked();
+    }
+
+    /// Consumers ativos (não inclui os que estão terminando o último lote)
+    size_t consumer_count() const {
+        std::lock_guard<std::mutex> lock(workers_mutex);
+        return active.size();
+    }
+
+    /// Vazão medida na última amostra, em registros por segundo
+    uint64_t drain_rate() const {
+        return last_rate.load(std::memory_order_relaxed);
+    }
+
+    /// Consumers adicionados pela thread de controle
+    uint64_t scale_ups() const {
+        return grown.load(std::memory_order_relaxed);
+    }
+
+    /// Consumers retirados pela thread de controle
+    uint64_t scale_downs() const {
+        return shrunk.load(std::memory_order_relaxed);
+    }
+
+private:
+    /// Consumer e o núcleo em que foi fixado
+    struct Worker {
+        std::unique_ptr<ConsumerType> consumer;
+        int cpu_slot;                           ///< Posição em cpu_list() (-1 = sem fixação)
+    };
+
+    LogBuffer& buffer_ref;                  ///< Buffer compartilhado pelos consumers
+    FileWriter& log_writer;                 ///< Escritor compartilhado pelos consumers
+    PoolOptions options;                    ///< Limites e núcleos
+    int next_id;                            ///< ID do próximo consumer
+    MetricsRegistry* metrics;               ///< Repassado aos consumers
+
+    mutable std::mutex workers_mutex;       ///< Protege active, retiring e contadores abaixo
+    std::vector<Worker> active;             ///< Consumers em execução
+    std::vector<Worker> retiring;           ///< Consumers terminando o último lote
+    std::vector<size_t> cpu_load;           ///< Consumers ativos por núcleo de cpu_list()
+    uint64_t retired_written;               ///< Registros gravados por consumers já encerrados
+
+    std::atomic<bool> is_running;           ///< start() chamado e pool não parado
+    std::thread scaler_thread;              ///< Thread de controle (só no modo adaptativo)
+    std::mutex scaler_mutex;                ///< Protege stop_scaler
+    std::condition_variable scaler_cv;      ///< Acorda a thread de controle na parada
+    bool stop_scaler;                       ///< Pede o fim da thread de controle
+
+    std::atomic<uint64_t> last_rate;        ///< Vazão da última amostra (registros/s)
+    std::atomic<uint64_t> grown;            ///< Consumers adicionados
+    std::atomic<uint64_t> shrunk;           ///< Consumers retirados
+
+    /// Cria e inicia um consumer no núcleo menos ocupado (workers_mutex tomado)
+    void add_worker() {
+        Worker worker;
+        worker.consumer.reset(new ConsumerType(buffer_ref, log_writer, next_id++, options.batch_size(), metrics));
+        worker.cpu_slot = -1;
+
+        if (!cpu_load.empty()) {
+            size_t slot = 0;
+            for (size_t i = 1; i < cpu_load.size(); ++i) {
+                if (cpu_load[i] < cpu_load[slot]) {
+                    slot = i;
+                }
+            }
+            ++cpu_load[slot];
+            worker.cpu_slot = static_cast<int>(slot);
+            worker.consumer->set_cpu_affinity(std::vector<int>(1, options.cpu_list()[slot]));
+        }
+
+        worker.consumer->start();
+        active.push_back(std::move(worker));
+    }
+
+    /// Pede a saída do consumer mais recente (workers_mutex tomado)
+    void retire_worker() {
+        Worker worker = std::move(active.back());
+        active.pop_back();
+        if (worker.cpu_slot >= 0) {
+            --cpu_load[static_cast<size_t>(worker.cpu_slot)];
+        }
+        worker.consumer->retire();
+        retiring.push_back(std::move(worker));
+    }
+
+    /// Encerra os consumers retirados que já saíram (workers_mutex tomado)
+    void reap_finished() {
+        for (size_t i = 0; i < retiring.size();) {
+            if (retiring[i].consumer->is_finished()) {
+                retiring[i].consumer->stop();
+                retired_written += retiring[i].consumer->records_written();
+                retiring[i] = std::move(retiring.back());
+                retiring.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    /// Encerra todos os consumers depois da parada (workers_mutex tomado)
+    void reap_all() {
+        for (size_t i = 0; i < retiring.size(); ++i) {
+            // Na parada o buffer já foi fechado: quem dormia no pop_batch() sai
+            retiring[i].consumer->stop();
+        }
+        reap_finished();
+    }
+
+    uint64_t written_locked() const {
+        uint64_t total = retired_written;
+        for (size_t i = 0; i < active.size(); ++i) {
+            total += active[i].consumer->records_written();
+        }
+        for (size_t i = 0; i < retiring.size(); ++i) {
+            total += retiring[i].consumer->records_written();
+        }
+        return total;
+    }
+
+    void stop_scaling() {
+        {
+            std::lock_guard<std::mutex> lock(scaler_mutex);
+            stop_scaler = true;
+        }
+        scaler_cv.notify_all();
+        if (scaler_thread.joinable()) {
+            scaler_thread.join();
+        }
+    }
+
+    /**
+     * @brief Rotina da thread de controle
+     *
+     * A cada intervalo: encerra consumers retirados que já saíram, mede a
+     * vazão e decide, pela profundidade do buffer, se adiciona ou retira
+     * um consumer (no máximo um por amostra, para não oscilar).
+     */
+    void scaler_routine() {
+        const size_t high = static_cast<size_t>(options.high_watermark() * buffer_ref.capacity());
+        const size_t low = static_cast<size_t>(options.low_watermark() * buffer_ref.capacity());
+
+        size_t last_depth = 0;
+        size_t idle = 0;
+        uint64_t last_written = 0;
+        std::chrono::steady_clock::time_point last_sample = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> scaler_lock(scaler_mutex);
+        while (!scaler_cv.wait_for(scaler_lock, options.scale_interval(), [this]() { return stop_scaler; })) {
+            std::lock_guard<std::mutex> lock(workers_mutex);
+            reap_finished();
+
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            uint64_t total = written_locked();
+            std::chrono::nanoseconds::rep elapsed =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_sample).count();
+            if (elapsed > 0) {
+                last_rate.store((total - last_written) * 1000000000ull / static_cast<uint64_t>(elapsed),
+                                std::memory_order_relaxed);
+            }
+            last_written = total;
+            last_sample = now;
+
+            size_t depth = buffer_ref.size();
+            if (depth >= high && depth > 0 && depth >= last_depth) {
+                // Fila cheia e sem baixar: a vazão atual não vence a chegada
+                idle = 0;
+                if (active.size() < options.max_consumers()) {
+                    add_worker();
+                    grown.fetch_add(1, std::memory_order_relaxed);
+                }
+            } else if (depth <= low) {
+                if (++idle >= options.idle_intervals() && active.size() > options.min_consumers()) {
+                    retire_worker();
+                    shrunk.fetch_add(1, std::memory_order_relaxed);
+                    idle = 0;
+                }
+            } else {
+                idle = 0;
+            }
+            last_depth = depth;
+        }
+    }
+
+    // Desabilita cópia, a thread de controle guarda o endereço do pool
+    ConsumerPool(const ConsumerPool&) = delete;
+    ConsumerPool& operator=(const ConsumerPool&) = delete;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdlib>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief Fixação de threads em núcleos (CPU affinity)
+ *
+ * Usado pelo ConsumerPool para manter cada consumer no mesmo núcleo (sem
+ * migração, o cache do consumer continua quente) e longe dos núcleos das
+ * threads da aplicação, que podem ser fixadas com pin_current_thread().
+ *
+ * O suporte real existe apenas no Linux; nas demais plataformas as funções
+ * não fazem nada e retornam false/lista vazia.
+ */
+namespace affinity {
+    /// Núcleos disponíveis no sistema
+    inline unsigned cpu_count() {
+        unsigned count = std::thread::hardware_concurrency();
+        return count > 0 ? count : 1;
+    }
+
+    /**
+     * @brief Fixa a thread que chama nos núcleos indicados
+     * @param cpus Núcleos permitidos (vazio = não altera)
+     * @return false se a plataforma não suportar ou o sistema recusar
+     */
+    inline bool pin_current_thread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+        if (cpus.empty()) {
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (size_t i = 0; i < cpus.size(); ++i) {
+            if (cpus[i] >= 0 && cpus[i] < CPU_SETSIZE) {
+                CPU_SET(cpus[i], &set);
+            }
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpus;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Converte uma lista do kernel ("0-3,8,10-11") em núcleos
+     * @return Lista vazia se o texto for inválido
+     */
+    inline std::vector<int> parse_cpu_list(const std::string& text) {
+        std::vector<int> cpus;
+        size_t position = 0;
+        while (position < text.size()) {
+            size_t end = text.find(',', position);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            std::string item = text.substr(position, end - position);
+            while (!item.empty() && (item[item.size() - 1] == '\n' || item[item.size() - 1] == ' ')) {
+                item.erase(item.size() - 1);
+            }
+            if (!item.empty()) {
+                char* rest = nullptr;
+                long first = std::strtol(item.c_str(), &rest, 10);
+                long last = first;
+                if (*rest == '-') {
+                    last = std::strtol(rest + 1, &rest, 10);
+                }
+                if (*rest != '\0' || first < 0 || last < first) {
+                    return std::vector<int>();
+                }
+                for (long cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(static_cast<int>(cpu));
+                }
+            }
+            position = end + 1;
+        }
+        return cpus;
+    }
+
+    /**
+     * @brief Núcleos de um nó NUMA, lidos de /sys/devices/system/node
+     * @param node Número do nó
+     * @return Lista vazia se o nó não existir (ou fora do Linux)
+     */
+    inline std::vector<int> cpus_of_numa_node(int node) {
+#if defined(__linux__)
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string text;
+        if (!file || !std::getline(file, text)) {
+            return std::vector<int>();
+        }
+        return parse_cpu_list(text);
+#else
+        (void)node;
+        return std::vector<int>();
+#endif
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Resultado de drain_pipeline()
+ */
+struct DrainReport {
+    uint64_t records_drained;               ///< Registros gravados durante a drenagem
+    size_t records_left;                    ///< Registros que ficaram no buffer (prazo esgotado)
+    bool deadline_reached;                  ///< true se o prazo acabou antes do buffer esvaziar
+    std::chrono::milliseconds elapsed;      ///< Duração total, incluindo o flush do escritor
+};
+
+/**
+ * @brief Encerra o pipeline gravando o máximo possível dentro do prazo
+ * @param buffer Buffer de onde os consumers leem; é fechado com shutdown()
+ * @param consumers Consumers em execução sobre o buffer
+ * @param writer Escritor dos consumers; recebe flush() ao final
+ * @param timeout Tempo máximo para esvaziar o buffer
+ * @return Quanto foi gravado e quanto ficou no buffer
+ *
+ * Os producers devem ter sido parados antes. Todos os consumers continuam
+ * gravando lotes cheios até o buffer esvaziar ou o prazo acabar:
+ * @code
+ * DrainReport report = drain_pipeline(buffer, {&consumer_one, &consumer_two}, writer,
+ *                                     std::chrono::seconds(2));
+ * @endcode
+ */
+template<typename LogBuffer, typename ConsumerType, typename Writer>
+DrainReport drain_pipeline(LogBuffer& buffer, const std::vector<ConsumerType*>& consumers, Writer& writer,
+                           std::chrono::milliseconds timeout) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point deadline = start + timeout;
+
+    uint64_t written_before = 0;
+    for (size_t i = 0; i < consumers.size(); ++i) {
+        written_before += consumers[i]->records_written();
+    }
+
+    buffer.shutdown();
+    for (size_t i = 0; i < consumers.size(); ++i) {
+        consumers[i]->drain(deadline);
+    }
+    writer.flush();
+
+    DrainReport report;
+    report.records_drained = 0;
+    for (size_t i = 0; i < consumers.size(); ++i) {
+        report.records_drained += consumers[i]->records_written();
+    }
+    report.records_drained -= written_before;
+    report.records_left = buffer.size();
+    report.deadline_reached = report.records_left > 0;
+    report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    return report;
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstddef>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <signal.h>
+
+/**
+ * @brief Gravação de emergência dos buffers em memória quando o processo morre
+ *
+ * Escritores que guardam registros em memória (ex: CommitFileWriter com
+ * with_emergency_flush()) publicam cada buffer em uma Region: descritor do
+ * arquivo, início e tamanho dos bytes ainda não gravados. install_handlers()
+ * instala tratadores para os sinais de falha (SIGSEGV, SIGBUS, SIGABRT,
+ * SIGFPE, SIGILL), que gravam todas as regiões com write(), que é
+ * async-signal-safe, e repetem o sinal com a ação padrão.
+ *
+ * SIGTERM e SIGINT não são falhas: o processo ainda pode drenar o pipeline
+ * inteiro (buffer e lotes dos consumers, que não estão em nenhuma Region).
+ * O primeiro apenas marca o pedido e acorda wait_for_shutdown() por um
+ * self-pipe, e a aplicação chama drain_pipeline() fora do tratador:
+ * @code
+ * emergency::install_handlers();
+ * ...
+ * emergency::wait_for_shutdown(std::chrono::hours(24));
+ * producer.stop();
+ * drain_pipeline(buffer, consumers, writer, std::chrono::seconds(2));
+ * @endcode
+ * Um segundo SIGTERM/SIGINT durante a drenagem grava as regiões e encerra
+ * o processo como um sinal de falha.
+ *
+ * Em uma falha de memória os buffers podem estar no meio de uma escrita,
+ * então o final do arquivo pode ter um registro incompleto ou repetido;
+ * o objetivo é não perder o que estava em memória.
+ *
+ * Disponível apenas em sistemas POSIX.
+ */
+namespace emergency {
+    /**
+     * @brief Bytes de um buffer que ainda não chegaram ao arquivo
+     *
+     * Só a thread dona do buffer chama publish()/clear(); o tratador de
+     * sinal apenas lê.
+     */
+    class Region {
+    public:
+        Region() : fd(-1), data(nullptr), size(0), in_use(false) {}
+
+        /// Registra o conteúdo atual do buffer (chamado após cada alteração)
+        void publish(const char* bytes, size_t length) {
+            size.store(0, std::memory_order_release);
+            data.store(bytes, std::memory_order_release);
+            size.store(length, std::memory_order_release);
+        }
+
+        /// O buffer foi gravado ou esvaziado
+        void clear() {
+            size.store(0, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<int> fd;                    ///< Arquivo de destino
+        std::atomic<const char*> data;          ///< Início dos bytes pendentes
+        std::atomic<size_t> size;               ///< Bytes pendentes (0 = nada a gravar)
+        std::atomic<bool> in_use;               ///< Posição da tabela ocupada
+
+        friend Region* open_region(int);
+        friend void close_region(Region*);
+        friend void flush_all();
+
+        Region(const Region&) = delete;
+        Region& operator=(const Region&) = delete;
+    };
+
+    static const size_t MAX_REGIONS = 1024;     ///< Regiões simultâneas
+
+    inline void flush_all();
+
+    namespace detail {
+        /// Tabela fixa: o tratador de sinal não pode alocar nem tomar locks
+        inline Region* regions() {
+            static Region table[MAX_REGIONS];
+            return table;
+        }
+
+        inline void write_all(int fd, const char* data, size_t size) {
+            while (size > 0) {
+                ssize_t written = ::write(fd, data, size);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return;
+                }
+                data += written;
+                size -= static_cast<size_t>(written);
+            }
+        }
+
+        inline void handle_signal(int signal_number) {
+            int saved_errno = errno;
+            flush_all();
+            errno = saved_errno;
+            // SA_RESETHAND já restaurou a ação padrão; o sinal é entregue ao sair do tratador
+            ::raise(signal_number);
+        }
+
+        /// Pedido de encerramento recebido (SIGTERM/SIGINT)
+        inline std::atomic<bool>& shutdown_flag() {
+            static std::atomic<bool> requested(false);
+            return requested;
+        }
+
+        /// Self-pipe que acorda wait_for_shutdown(): [0] leitura, [1] escrita
+        inline int* shutdown_pipe() {
+            static int fds[2] = {-1, -1};
+            return fds;
+        }
+
+        /// Volta à ação padrão e trata o sinal como uma falha
+        inline void terminate_with(int signal_number) {
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_handler = SIG_DFL;
+            sigemptyset(&action.sa_mask);
+            ::sigaction(signal_number, &action, nullptr);
+            handle_signal(signal_number);
+        }
+
+        inline void handle_shutdown(int signal_number) {
+            int saved_errno = errno;
+            if (shutdown_flag().exchange(true)) {
+                // Segundo pedido: a drenagem não terminou a tempo, encerra como em uma falha
+                terminate_with(signal_number);
+                return;
+            }
+            int fd = shutdown_pipe()[1];
+            if (fd >= 0) {
+                char byte = 1;
+                ssize_t ignored = ::write(fd, &byte, 1);
+                (void)ignored;
+            }
+            errno = saved_errno;
+        }
+    }
+
+    /**
+     * @brief Reserva uma região para um buffer que será gravado em fd
+     * @return nullptr se a tabela estiver cheia (o buffer fica sem cobertura)
+     */
+    inline Region* open_region(int fd) {
+        Region* table = detail::regions();
+        for (size_t i = 0; i < MAX_REGIONS; ++i) {
+            bool expected = false;
+            if (table[i].in_use.compare_exchange_strong(expected, true)) {
+                table[i].size.store(0, std::memory_order_relaxed);
+                table[i].fd.store(fd, std::memory_order_release);
+                return &table[i];
+            }
+        }
+        return nullptr;
+    }
+
+    /// Libera a região (buffer destruído)
+    inline void close_region(Region* region) {
+        if (region != nullptr) {
+            region->size.store(0, std::memory_order_release);
+            region->fd.store(-1, std::memory_order_release);
+            region->in_use.store(false, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Grava todas as regiões com bytes pendentes (async-signal-safe)
+     */
+    inline void flush_all() {
+        Region* table = detail::regions();
+        for (size_t i = 0; i < MAX_REGIONS; ++i) {
+            if (!table[i].in_use.load(std::memory_order_acquire)) {
+                continue;
+            }
+            int fd = table[i].fd.load(std::memory_order_acquire);
+            size_t size = table[i].size.load(std::memory_order_acquire);
+            const char* data = table[i].data.load(std::memory_order_acquire);
+            if (table[i].size.load(std::memory_order_acquire) != size) {
+                // publish() em andamento: início e tamanho podem ser de buffers diferentes
+                continue;
+            }
+            if (fd >= 0 && size > 0 && data != nullptr) {
+                detail::write_all(fd, data, size);
+            }
+        }
+    }
+
+    /// Indica se SIGTERM ou SIGINT já foi recebido
+    inline bool shutdown_requested() {
+        return detail::shutdown_flag().load();
+    }
+
+    /**
+     * @brief Espera SIGTERM/SIGINT por até timeout
+     * @return true se o encerramento foi pedido
+     *
+     * Requer install_handlers(); sem ele, apenas espera o tempo inteiro.
+     */
+    template<typename Rep, typename Period>
+    bool wait_for_shutdown(std::chrono::duration<Rep, Period> timeout) {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+        int fd = detail::shutdown_pipe()[0];
+        while (!shutdown_requested()) {
+            std::chrono::steady_clock::duration left = deadline - std::chrono::steady_clock::now();
+            if (left <= std::chrono::steady_clock::duration::zero()) {
+                return false;
+            }
+            if (fd < 0) {
+                std::this_thread::sleep_for(left);
+                return false;
+            }
+            long long millis = std::chrono::duration_cast<std::chrono::milliseconds>(left).count() + 1;
+            int wait = static_cast<int>(millis < 60000 ? millis : 60000);
+            struct pollfd descriptor;
+            descriptor.fd = fd;
+            descriptor.events = POLLIN;
+            descriptor.revents = 0;
+            if (::poll(&descriptor, 1, wait) > 0) {
+                char bytes[16];
+                while (::read(fd, bytes, sizeof(bytes)) > 0) {
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Instala os tratadores de SIGTERM, SIGINT, SIGSEGV, SIGBUS, SIGABRT, SIGFPE e SIGILL
+     * @return false se algum sigaction() ou a criação do self-pipe falhar
+     *
+     * Também cria uma pilha alternativa para a thread que chama, de forma
+     * que um estouro de pilha nela ainda consiga executar o tratador.
+     */
+    inline bool install_handlers() {
+        detail::regions();
+        detail::shutdown_flag();
+
+        bool ok = true;
+        int* fds = detail::shutdown_pipe();
+        if (fds[0] < 0) {
+            ok = ::pipe(fds) == 0;
+            for (int i = 0; ok && i < 2; ++i) {
+                ::fcntl(fds[i], F_SETFL, ::fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+                ::fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+            }
+            if (!ok) {
+                fds[0] = fds[1] = -1;
+            }
+        }
+
+        static char alternate_stack[64 * 1024];
+        stack_t stack;
+        std::memset(&stack, 0, sizeof(stack));
+        stack.ss_sp = alternate_stack;
+        stack.ss_size = sizeof(alternate_stack);
+        ::sigaltstack(&stack, nullptr);
+
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = &detail::handle_signal;
+        action.sa_flags = SA_RESETHAND | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+
+        const int signals[] = {SIGSEGV, SIGBUS, SIGABRT, SIGFPE, SIGILL};
+        for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); ++i) {
+            ok = ::sigaction(signals[i], &action, nullptr) == 0 && ok;
+        }
+
+        // Encerramento pedido: o tratador continua instalado para o segundo sinal
+        action.sa_handler = &detail::handle_shutdown;
+        action.sa_flags = SA_ONSTACK | SA_RESTART;
+        const int shutdown_signals[] = {SIGTERM, SIGINT};
+        for (size_t i = 0; i < sizeof(shutdown_signals) / sizeof(shutdown_signals[0]); ++i) {
+            ok = ::sigaction(shutdown_signals[i], &action, nullptr) == 0 && ok;
+        }
+        return ok;
+    }
+}
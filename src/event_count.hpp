@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+/**
+ * @brief Ponto de espera para consumers de estruturas sem lock
+ *
+ * Permite que uma thread durma até ser notificada sem perder notificações
+ * que cheguem entre a última verificação da fila e o início do sono
+ * ("event count"). O consumer segue o protocolo:
+ * @code
+ * uint32_t key = gate.prepare_wait();
+ * if (try_pop(message)) { gate.cancel_wait(); return true; }
+ * gate.wait(key);
+ * @endcode
+ * e o producer, após publicar o registro, só paga pela notificação quando
+ * há alguém esperando (has_waiters()).
+ *
+ * No Linux a espera usa um futex sobre o contador de épocas; nas demais
+ * plataformas, mutex e variável de condição.
+ */
+class EventCount {
+public:
+    EventCount() : epoch(0), waiters(0) {}
+
+    /**
+     * @brief Registra a thread como esperando, antes de verificar a fila uma última vez
+     * @return Época atual, a ser passada para wait()
+     */
+    uint32_t prepare_wait() {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Desiste da espera (a verificação final encontrou trabalho)
+     */
+    void cancel_wait() {
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Dorme até alguma notificação posterior a prepare_wait()
+     * @param key Valor retornado por prepare_wait()
+     */
+    void wait(uint32_t key) {
+#if defined(__linux__)
+        while (epoch.load(std::memory_order_acquire) == key) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+        }
+#else
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this, key]() { return epoch.load(std::memory_order_acquire) != key; });
+#endif
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Como wait(), mas desiste após timeout
+     * @param key Valor retornado por prepare_wait()
+     * @param timeout Espera máxima
+     * @return false se o tempo acabou sem notificação
+     */
+    bool wait_for(uint32_t key, std::chrono::nanoseconds timeout) {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+        bool notified = true;
+#if defined(__linux__)
+        while (epoch.load(std::memory_order_acquire) == key) {
+            std::chrono::nanoseconds left = deadline - std::chrono::steady_clock::now();
+            if (left.count() <= 0) {
+                notified = false;
+                break;
+            }
+            struct timespec relative;
+            relative.tv_sec = static_cast<time_t>(left.count() / 1000000000);
+            relative.tv_nsec = static_cast<long>(left.count() % 1000000000);
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, key, &relative, nullptr, 0);
+        }
+#else
+        std::unique_lock<std::mutex> lock(mutex);
+        notified = cv.wait_until(lock, deadline, [this, key]() { return epoch.load(std::memory_order_acquire) != key; });
+#endif
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return notified;
+    }
+
+    /**
+     * @brief Indica se alguma thread está esperando
+     *
+     * Deve ser chamada depois de publicar o registro; a barreira garante que
+     * ou o producer vê o consumer registrado, ou o consumer vê o registro.
+     */
+    bool has_waiters() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return waiters.load(std::memory_order_acquire) > 0;
+    }
+
+    /// Acorda uma thread em espera
+    void notify_one() {
+        wake(1);
+    }
+
+    /// Acorda todas as threads em espera (ex: no shutdown)
+    void notify_all() {
+        wake(WAKE_ALL);
+    }
+
+private:
+    static const int WAKE_ALL = 0x7fffffff;     ///< "Todas" para o futex
+
+    std::atomic<uint32_t> epoch;                    ///< Incrementada a cada notificação
+    std::atomic<uint32_t> waiters;                  ///< Threads entre prepare_wait() e o fim de wait()
+#if !defined(__linux__)
+    std::mutex mutex;                               ///< Protege a espera na variável de condição
+    std::condition_variable cv;                     ///< Onde as threads dormem
+#endif
+
+    void wake(int count) {
+        epoch.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+        // Passar pelo mutex impede que a notificação caia entre o teste e o sono
+        { std::lock_guard<std::mutex> lock(mutex); }
+        if (count == 1) {
+            cv.notify_one();
+        } else {
+            cv.notify_all();
+        }
+#endif
+    }
+
+    // Desabilita cópia, threads esperam neste endereço
+    EventCount(const EventCount&) = delete;
+    EventCount& operator=(const EventCount&) = delete;
+};
+
+/**
+ * @brief Ocupação a partir da qual producers acordam consumers adicionais
+ * @param capacity Capacidade do buffer
+ *
+ * Abaixo dela, só a transição de vazio para não vazio acorda um consumer;
+ * acima, cada push acorda mais um enquanto houver consumers dormindo.
+ */
+inline size_t wake_watermark(size_t capacity) {
+    return capacity / 4 > 1 ? capacity / 4 : 1;
+}
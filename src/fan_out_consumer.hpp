@@ -0,0 +1,397 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+
+#include "log_level.hpp"
+#include "record.hpp"
+#include "record_ref.hpp"
+#include "event_count.hpp"
+
+/**
+ * @brief Configuração de um sink do FanOutConsumer
+ *
+ * Exemplo: arquivo de alertas só com erros, que nunca atrasa os demais sinks:
+ * @code
+ * SinkOptions::lossy().with_min_level(LogLevel::ERROR)
+ * @endcode
+ */
+class SinkOptions {
+public:
+    /// Recebe todos os lotes; se ficar para trás, o FanOutConsumer espera por ele
+    static SinkOptions lossless() {
+        return SinkOptions(false);
+    }
+
+    /**
+     * @brief Nunca atrasa o FanOutConsumer: ao ficar um anel inteiro para trás,
+     *        pula os lotes já sobrescritos e os conta em dropped_batches()
+     */
+    static SinkOptions lossy() {
+        return SinkOptions(true);
+    }
+
+    /// Registros abaixo deste nível não são entregues ao sink
+    SinkOptions with_min_level(LogLevel level) const {
+        SinkOptions options(*this);
+        options.level = level;
+        return options;
+    }
+
+    LogLevel min_level() const { return level; }
+    bool drops_when_behind() const { return drops; }
+
+private:
+    LogLevel level;             ///< Nível mínimo entregue
+    bool drops;                 ///< true = pode pular lotes
+
+    explicit SinkOptions(bool drops) : level(LogLevel::INFO), drops(drops) {}
+};
+
+/**
+ * @brief Consumer que entrega cada registro do buffer a vários escritores
+ * @tparam LogBuffer Buffer de onde os registros são retirados
+ *
+ * Substitui o Consumer quando os mesmos registros devem ir para mais de um
+ * destino (arquivo local, coletor de rede, arquivo de alertas...). Vários
+ * Consumers sobre o mesmo buffer dividiriam os registros entre si; aqui uma
+ * thread retira cada lote do buffer uma única vez, o move para um lote
+ * compartilhado (contado por referência) e o publica em um anel. Cada sink
+ * tem thread e cursor próprios sobre o anel, então um sink lento não atrasa
+ * a escrita dos outros, e nenhum registro é copiado por sink: sinks com
+ * nível mínimo recebem um lote de RecordRef apontando para os registros
+ * originais. O lote é liberado (devolvendo posições do slab) quando o
+ * último sink termina de escrevê-lo.
+ *
+ * @code
+ * FanOutConsumer<MessageBuffer> fan_out(buffer);
+ * fan_out.add_sink(file_writer);
+ * fan_out.add_sink(alert_writer, SinkOptions::lossy().with_min_level(LogLevel::ERROR));
+ * fan_out.start();
+ * ...
+ * buffer.shutdown();
+ * fan_out.stop();
+ * @endcode
+ *
+ * Os escritores não pertencem ao FanOutConsumer e devem viver mais que ele.
+ */
+template<typename LogBuffer>
+class FanOutConsumer {
+public:
+    typedef typename LogBuffer::value_type record_type;
+
+    /**
+     * @param buffer Buffer de onde os lotes são retirados
+     * @param batch_size Máximo de registros por lote
+     * @param ring_batches Lotes publicados que ainda podem estar aguardando o sink mais lento
+     *                     (arredondado para potência de 2)
+     */
+    explicit FanOutConsumer(LogBuffer& buffer, size_t batch_size = DEFAULT_BATCH_SIZE,
+                            size_t ring_batches = DEFAULT_RING_BATCHES)
+        : buffer_ref(buffer),
+          batch_size(batch_size == 0 ? 1 : batch_size),
+          ring(round_up_pow2(ring_batches == 0 ? 1 : ring_batches)),
+          mask(ring.size() - 1),
+          published(0),
+          finished(false),
+          is_running(false) {}
+
+    ~FanOutConsumer() {
+        stop();
+    }
+
+    /**
+     * @brief Adiciona um destino para os registros
+     * @param writer Escritor com append_batch(); não pertence ao FanOutConsumer
+     * @param options Nível mínimo e comportamento quando o sink fica para trás
+     * @return Índice do sink (para dropped_batches())
+     * @throws std::logic_error se chamado depois de start()
+     */
+    template<typename Writer>
+    size_t add_sink(Writer& writer, const SinkOptions& options = SinkOptions::lossless()) {
+        if (is_running.load()) {
+            throw std::logic_error("Sinks devem ser adicionados antes de start()");
+        }
+
+        sinks.emplace_back(new WriterSink<Writer>(writer, options));
+        return sinks.size() - 1;
+    }
+
+    /**
+     * @brief Inicia a thread que lê o buffer e uma thread por sink
+     * @throws std::logic_error se nenhum sink foi adicionado
+     */
+    void start() {
+        if (is_running.load()) {
+            std::cout << "FanOutConsumer já iniciado." << std::endl;
+            return;
+        }
+        if (sinks.empty()) {
+            throw std::logic_error("FanOutConsumer sem sinks");
+        }
+
+        finished.store(false);
+        is_running.store(true);
+        for (size_t i = 0; i < sinks.size(); ++i) {
+            sinks[i]->thread = std::thread(&FanOutConsumer::sink_routine, this, sinks[i].get());
+        }
+        reader_thread = std::thread(&FanOutConsumer::reading_routine, this);
+
+        std::cout << "FanOutConsumer iniciado com " << sinks.size() << " sinks..." << std::endl;
+    }
+
+    /**
+     * @brief Espera o buffer esvaziar e cada sink escrever tudo o que foi publicado
+     *
+     * A thread de leitura só termina quando pop_batch() retorna 0, então o
+     * buffer deve ser fechado com shutdown() antes (como no Consumer); os
+     * registros ainda no buffer são entregues a todos os sinks.
+     */
+    void stop() {
+        if (!is_running.load()) {
+            return;
+        }
+
+        is_running.store(false);
+        if (reader_thread.joinable()) {
+            reader_thread.join();
+        }
+
+        finished.store(true, std::memory_order_release);
+        data_ready.notify_all();
+        for (size_t i = 0; i < sinks.size(); ++i) {
+            if (sinks[i]->thread.joinable()) {
+                sinks[i]->thread.join();
+            }
+        }
+
+        std::cout << "FanOutConsumer parado..." << std::endl;
+    }
+
+    size_t sink_count() const {
+        return sinks.size();
+    }
+
+    /// Lotes que um sink lossy pulou por ter ficado para trás
+    uint64_t dropped_batches(size_t sink) const {
+        return sinks.at(sink)->dropped.load(std::memory_order_relaxed);
+    }
+
+    static const size_t DEFAULT_BATCH_SIZE = 64;       ///< Registros por lote
+    static const size_t DEFAULT_RING_BATCHES = 256;    ///< Lotes no anel
+
+private:
+    /// Lote publicado no anel, compartilhado por todos os sinks
+    struct Batch {
+        uint64_t sequence;                  ///< Posição no anel (publicação)
+        std::vector<record_type> records;   ///< Registros retirados do buffer
+        std::atomic<size_t> pending;        ///< Sinks que ainda não escreveram o lote
+
+        Batch(uint64_t sequence, size_t sinks) : sequence(sequence), pending(sinks) {}
+    };
+
+    typedef std::shared_ptr<Batch> BatchPtr;
+
+    /// Sink com tipo de escritor apagado
+    struct Sink {
+        const SinkOptions options;
+        std::atomic<uint64_t> cursor;       ///< Próximo lote a escrever
+        std::atomic<uint64_t> dropped;      ///< Lotes pulados (só lossy)
+        std::thread thread;
+
+        explicit Sink(const SinkOptions& options) : options(options), cursor(0), dropped(0) {}
+        virtual ~Sink() {}
+
+        virtual void write(const std::vector<record_type>& records) = 0;
+        virtual void flush() = 0;
+    };
+
+    template<typename Writer>
+    struct WriterSink : Sink {
+        Writer& writer;
+        std::vector<RecordRef<record_type> > selected;     ///< Registros acima do nível mínimo
+
+        WriterSink(Writer& writer, const SinkOptions& options) : Sink(options), writer(writer) {}
+
+        void write(const std::vector<record_type>& records) override {
+            if (this->options.min_level() == LogLevel::INFO) {
+                writer.append_batch(records);
+                return;
+            }
+
+            selected.clear();
+            for (size_t i = 0; i < records.size(); ++i) {
+                if (record_level(records[i]) >= this->options.min_level()) {
+                    selected.push_back(RecordRef<record_type>(records[i]));
+                }
+            }
+            if (!selected.empty()) {
+                writer.append_batch(selected);
+            }
+        }
+
+        void flush() override {
+            writer.flush();
+        }
+    };
+
+    LogBuffer& buffer_ref;                          ///< Buffer de onde os logs são retirados
+    const size_t batch_size;                        ///< Máximo de registros por lote
+
+    std::vector<BatchPtr> ring;                     ///< Lotes publicados (acesso via std::atomic_load/store)
+    const size_t mask;                              ///< ring.size() - 1
+    std::atomic<uint64_t> published;                ///< Lotes já publicados
+    std::atomic<bool> finished;                     ///< Nenhum lote novo será publicado
+
+    EventCount data_ready;                          ///< Sinks esperando lotes
+    EventCount space_ready;                         ///< Leitor esperando um sink lossless
+
+    std::vector<std::unique_ptr<Sink> > sinks;      ///< Destinos
+    std::thread reader_thread;                      ///< Thread que lê o buffer
+    std::atomic<bool> is_running;                   ///< Flag thread-safe para controle de execução
+
+    static size_t round_up_pow2(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Rotina da thread de leitura: retira lotes do buffer e os publica no anel
+     *
+     * Termina quando o buffer está fechado e vazio.
+     */
+    void reading_routine() {
+        try {
+            for (;;) {
+                uint64_t sequence = published.load(std::memory_order_relaxed);
+                BatchPtr batch = std::make_shared<Batch>(sequence, sinks.size());
+                batch->records.reserve(batch_size);
+
+                if (buffer_ref.pop_batch(batch->records, batch_size) == 0) {
+                    break;
+                }
+
+                wait_for_space(sequence);
+                std::atomic_store_explicit(&ring[sequence & mask], batch, std::memory_order_release);
+                published.store(sequence + 1, std::memory_order_release);
+
+                if (data_ready.has_waiters()) {
+                    data_ready.notify_all();
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cout << "Erro em FanOutConsumer -> " << e.what() << std::endl;
+        }
+    }
+
+    /// Menor cursor entre os sinks que não podem pular lotes
+    uint64_t slowest_lossless() const {
+        uint64_t slowest = UINT64_MAX;
+        for (size_t i = 0; i < sinks.size(); ++i) {
+            if (!sinks[i]->options.drops_when_behind()) {
+                uint64_t cursor = sinks[i]->cursor.load(std::memory_order_acquire);
+                if (cursor < slowest) {
+                    slowest = cursor;
+                }
+            }
+        }
+        return slowest;
+    }
+
+    /**
+     * @brief Espera até a posição sequence do anel não ser mais necessária a um sink lossless
+     */
+    void wait_for_space(uint64_t sequence) {
+        for (;;) {
+            uint64_t slowest = slowest_lossless();
+            if (slowest == UINT64_MAX || sequence - slowest < ring.size()) {
+                return;
+            }
+
+            uint32_t key = space_ready.prepare_wait();
+            if (sequence - slowest_lossless() < ring.size()) {
+                space_ready.cancel_wait();
+                return;
+            }
+            space_ready.wait(key);
+        }
+    }
+
+    /**
+     * @brief Rotina de cada sink: escreve os lotes publicados na ordem, pelo próprio cursor
+     */
+    void sink_routine(Sink* sink) {
+        uint64_t next = 0;
+        for (;;) {
+            uint64_t available = published.load(std::memory_order_acquire);
+            if (next == available) {
+                if (finished.load(std::memory_order_acquire) &&
+                    published.load(std::memory_order_acquire) == next) {
+                    break;
+                }
+
+                uint32_t key = data_ready.prepare_wait();
+                if (published.load(std::memory_order_acquire) != next || finished.load(std::memory_order_acquire)) {
+                    data_ready.cancel_wait();
+                    continue;
+                }
+                data_ready.wait(key);
+                continue;
+            }
+
+            BatchPtr batch = std::atomic_load_explicit(&ring[next & mask], std::memory_order_acquire);
+            if (!batch || batch->sequence != next) {
+                // Sink lossy sobrescrito pelo leitor: pula para o lote mais antigo ainda no anel
+                uint64_t oldest = available > ring.size() ? available - ring.size() : 0;
+                uint64_t resume = oldest > next ? oldest : next + 1;
+                sink->dropped.fetch_add(resume - next, std::memory_order_relaxed);
+                next = resume;
+                sink->cursor.store(next, std::memory_order_release);
+                continue;
+            }
+
+            try {
+                sink->write(batch->records);
+            } catch (const std::exception& e) {
+                std::cout << "Erro em sink do FanOutConsumer -> " << e.what() << std::endl;
+            }
+            release(batch, next);
+
+            ++next;
+            sink->cursor.store(next, std::memory_order_release);
+            if (space_ready.has_waiters()) {
+                space_ready.notify_one();
+            }
+        }
+
+        try {
+            sink->flush();
+        } catch (const std::exception& e) {
+            std::cout << "Erro em sink do FanOutConsumer -> " << e.what() << std::endl;
+        }
+    }
+
+    /**
+     * @brief O último sink a escrever o lote o retira do anel, liberando os registros
+     */
+    void release(BatchPtr& batch, uint64_t sequence) {
+        if (batch->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            BatchPtr expected = batch;
+            std::atomic_compare_exchange_strong(&ring[sequence & mask], &expected, BatchPtr());
+        }
+        batch.reset();
+    }
+
+    // Desabilita cópia, as threads referenciam esta instância
+    FanOutConsumer(const FanOutConsumer&) = delete;
+    FanOutConsumer& operator=(const FanOutConsumer&) = delete;
+};
@@ -3,27 +3,49 @@
 #include <fstream>
 #include <mutex>
 #include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 #include <stdexcept>
 #include <iostream>
 
+#include "log_level.hpp"
+#include "record.hpp"
+#include "flush_policy.hpp"
+
 class FileWriter {
 public:
     /**
      * @brief Obtém instância para um arquivo específico
      * @param filename Nome do arquivo de log (padrão: "logs.json")
+     * @param policy Política de flush (padrão: flush a cada registro)
      * @return Referência para instância única do arquivo
      * @throws std::runtime_error se não conseguir abrir o arquivo
      */
-    explicit FileWriter(const std::string& filename) : filename(filename) {
+    explicit FileWriter(const std::string& filename, const FlushPolicy& policy = FlushPolicy::every_record())
+        : filename(filename),
+          flush_policy(policy),
+          stream_buffer(STREAM_BUFFER_SIZE),
+          pending_bytes(0),
+          stop_timer(false) {
+        // Buffer maior que o padrão, já que o flush agora é controlado pela política
+        file.rdbuf()->pubsetbuf(stream_buffer.data(), static_cast<std::streamsize>(stream_buffer.size()));
         file.open(filename, std::ios::app);
         if (!file.is_open()) {
             throw std::runtime_error("Não foi possível abrir o arquivo de log: " + filename);
         }
 
+        if (flush_policy.interval().count() > 0) {
+            flush_thread = std::thread(&FileWriter::flush_routine, this);
+        }
+
         std::cout << "FileWriter criado para arquivo: " << filename << std::endl;
     }
 
     ~FileWriter() {
+        stop_flush_thread();
+
         if (file.is_open()) {
             file.flush();
             file.close();
@@ -31,14 +53,25 @@ public:
     }
 
     /**
-     * @brief Adiciona linha JSON ao arquivo de log
-     * @param json_line String contendo JSON válido da mensagem de log
+     * @brief Adiciona registro formatado ao arquivo de log
+     * @param record Registro completo, já com seu terminador (ex: '\n' no JSONL)
      *
-     * Operação thread-safe que adiciona a linha ao arquivo e força flush.
-     * Cada linha JSON é escrita individualmente para formar um arquivo
-     * JSONL (JSON Lines) válido.
+     * Operação thread-safe que escreve o registro como recebido; o flush
+     * segue a política configurada. O enquadramento (uma linha por registro
+     * no JSONL, prefixo de tamanho no binário) é responsabilidade do
+     * formatador usado pelo Logger.
      */
-    void append(const std::string& json_line) {
+    void append(const std::string& record) {
+        LogLevel level = flush_policy.uses_severity() ? level_from_text(record) : LogLevel::INFO;
+        append(record, level);
+    }
+
+    /**
+     * @brief Adiciona registro formatado cujo nível já é conhecido
+     * @param record Registro completo, já com seu terminador
+     * @param level Nível do registro, usado pela política de flush por severidade
+     */
+    void append(const std::string& record, LogLevel level) {
         std::lock_guard<std::mutex> lock(write_mutex);
 
         // Verifica se arquivo ainda está aberto
@@ -46,8 +79,51 @@ public:
             throw std::runtime_error("Arquivo de log foi fechado inesperadamente");
         }
 
-        file << json_line << std::endl;
-        file.flush(); // Garante que dados sejam escritos imediatamente
+        file.write(record.data(), static_cast<std::streamsize>(record.size()));
+        flush_if_needed(record.size(), level);
+    }
+
+    /**
+     * @brief Adiciona um lote de registros ao arquivo de log
+     * @tparam Record Tipo do registro (std::string, SlabRecord, LogEvent, ...),
+     * acessado via append_record() e record_level()
+     * @param records Registros a serem escritos, na ordem do vetor
+     *
+     * Os registros são concatenados (e formatados, no caso de LogEvent) em um
+     * único bloco fora da seção crítica;
+     * sob o lock é feita apenas uma escrita para todo o lote, seguida de no
+     * máximo um flush conforme a política. O bloco é reaproveitado entre
+     * chamadas da mesma thread, sem alocação no regime permanente.
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        static thread_local std::string block;
+        block.clear();
+
+        LogLevel max_level = LogLevel::INFO;
+        for (size_t i = 0; i < records.size(); ++i) {
+            append_record(block, records[i]);
+
+            if (flush_policy.uses_severity()) {
+                LogLevel level = record_level(records[i]);
+                if (level > max_level) {
+                    max_level = level;
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(write_mutex);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Arquivo de log foi fechado inesperadamente");
+        }
+
+        file.write(block.data(), static_cast<std::streamsize>(block.size()));
+        flush_if_needed(block.size(), max_level);
     }
 
     /**
@@ -77,9 +153,17 @@ public:
         std::lock_guard<std::mutex> lock(write_mutex);
         if (file.is_open()) {
             file.flush();
+            pending_bytes = 0;
         }
     }
 
+    /**
+     * @brief Obtém a política de flush configurada
+     */
+    const FlushPolicy& get_flush_policy() const {
+        return flush_policy;
+    }
+
     /**
      * @brief Fecha o arquivo explicitamente
      *
@@ -87,6 +171,9 @@ public:
      * escrita irão falhar com exceção.
      */
     void close() {
+        // A thread de flush também usa write_mutex, então é parada antes
+        stop_flush_thread();
+
         std::lock_guard<std::mutex> lock(write_mutex);
         if (file.is_open()) {
             file.flush();
@@ -101,7 +188,59 @@ private:
     std::ofstream file;                 ///< Stream de saída para arquivo
     std::string filename;               ///< Nome do arquivo associado
 
+    static const size_t STREAM_BUFFER_SIZE = 64 * 1024;   ///< Buffer interno do stream
+
+    const FlushPolicy flush_policy;     ///< Quando forçar gravação em disco
+    std::vector<char> stream_buffer;    ///< Memória usada pelo buffer do stream
+    size_t pending_bytes;               ///< Bytes escritos desde o último flush
+
+    std::thread flush_thread;           ///< Thread do flush periódico (se configurado)
+    std::mutex timer_mutex;             ///< Protege stop_timer
+    std::condition_variable timer_cv;   ///< Acorda a thread de flush para encerrar
+    bool stop_timer;                    ///< Sinaliza fim da thread de flush
+
+    /**
+     * @brief Aplica a política após uma escrita (chamado com write_mutex adquirido)
+     * @param written Bytes da escrita atual
+     * @param level Maior nível entre os registros escritos
+     */
+    void flush_if_needed(size_t written, LogLevel level) {
+        pending_bytes += written;
+
+        if (flush_policy.should_flush(pending_bytes, level)) {
+            file.flush();
+            pending_bytes = 0;
+        }
+    }
+
+    /**
+     * @brief Rotina da thread de flush periódico
+     *
+     * Acorda a cada intervalo da política e grava o que estiver pendente.
+     */
+    void flush_routine() {
+        std::unique_lock<std::mutex> timer_lock(timer_mutex);
+
+        while (!timer_cv.wait_for(timer_lock, flush_policy.interval(), [this]() { return stop_timer; })) {
+            std::lock_guard<std::mutex> lock(write_mutex);
+            if (pending_bytes > 0 && file.is_open()) {
+                file.flush();
+                pending_bytes = 0;
+            }
+        }
+    }
+
+    void stop_flush_thread() {
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex);
+            stop_timer = true;
+        }
+        timer_cv.notify_all();
 
+        if (flush_thread.joinable()) {
+            flush_thread.join();
+        }
+    }
 
     // Desabilita cópia para evitar problemas com mutex
     FileWriter(const FileWriter&) = delete;
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+#include "log_level.hpp"
+
+/**
+ * @brief Define quando o FileWriter força a gravação dos dados em disco
+ *
+ * Os critérios podem ser combinados; o flush acontece quando qualquer um
+ * deles é atingido. Exemplo: erros gravados imediatamente e o restante no
+ * máximo a cada 100 ms:
+ * @code
+ * FlushPolicy::on_severity(LogLevel::ERROR).with_interval(std::chrono::milliseconds(100))
+ * @endcode
+ */
+class FlushPolicy {
+public:
+    /**
+     * @brief Flush após cada registro (comportamento mais durável e mais caro)
+     */
+    static FlushPolicy every_record() {
+        FlushPolicy policy;
+        policy.per_record = true;
+        return policy;
+    }
+
+    /**
+     * @brief Flush quando o volume pendente atingir um limite
+     * @param bytes Número de bytes escritos sem flush que dispara a gravação
+     */
+    static FlushPolicy every_bytes(size_t bytes) {
+        return FlushPolicy().with_bytes(bytes);
+    }
+
+    /**
+     * @brief Flush periódico feito por uma thread de temporização
+     * @param interval Tempo máximo que dados podem ficar sem flush
+     */
+    static FlushPolicy every_interval(std::chrono::milliseconds interval) {
+        return FlushPolicy().with_interval(interval);
+    }
+
+    /**
+     * @brief Flush apenas quando chega registro com severidade mínima
+     * @param level Nível a partir do qual o registro força flush
+     */
+    static FlushPolicy on_severity(LogLevel level = LogLevel::ERROR) {
+        return FlushPolicy().with_severity(level);
+    }
+
+    /// Adiciona critério por volume de bytes pendentes
+    FlushPolicy with_bytes(size_t bytes) const {
+        FlushPolicy policy(*this);
+        policy.max_pending_bytes = bytes;
+        return policy;
+    }
+
+    /// Adiciona critério por tempo
+    FlushPolicy with_interval(std::chrono::milliseconds interval) const {
+        FlushPolicy policy(*this);
+        policy.max_interval = interval;
+        return policy;
+    }
+
+    /// Adiciona critério por severidade
+    FlushPolicy with_severity(LogLevel level) const {
+        FlushPolicy policy(*this);
+        policy.severity_enabled = true;
+        policy.min_severity = level;
+        return policy;
+    }
+
+    bool flushes_every_record() const { return per_record; }
+    size_t pending_bytes_limit() const { return max_pending_bytes; }
+    std::chrono::milliseconds interval() const { return max_interval; }
+    bool uses_severity() const { return severity_enabled; }
+    LogLevel severity() const { return min_severity; }
+
+    /**
+     * @brief Decide se uma escrita deve ser seguida de flush
+     * @param pending_bytes Bytes escritos desde o último flush, incluindo a escrita atual
+     * @param level Maior nível entre os registros da escrita atual
+     */
+    bool should_flush(size_t pending_bytes, LogLevel level) const {
+        if (per_record) {
+            return true;
+        }
+        if (max_pending_bytes > 0 && pending_bytes >= max_pending_bytes) {
+            return true;
+        }
+        return severity_enabled && level >= min_severity;
+    }
+
+private:
+    bool per_record;                            ///< Flush após toda escrita
+    size_t max_pending_bytes;                   ///< 0 desativa o critério por volume
+    std::chrono::milliseconds max_interval;     ///< 0 desativa o critério por tempo
+    bool severity_enabled;                      ///< Ativa o critério por severidade
+    LogLevel min_severity;                      ///< Nível mínimo que força flush
+
+    FlushPolicy()
+        : per_record(false),
+          max_pending_bytes(0),
+          max_interval(0),
+          severity_enabled(false),
+          min_severity(LogLevel::ERROR) {}
+};
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_level.hpp"
+#include "timestamp.hpp"
+#include "json_escape.hpp"
+
+/**
+ * @file formatter.hpp
+ *
+ * Formatadores são políticas de Logger<LogBuffer, Formatter>: structs com
+ * um único método estático
+ * @code
+ * template<typename Out>
+ * static void format(Out& out, time_point time, LogLevel level,
+ *                    int producer_id, const char* message, size_t message_size);
+ * @endcode
+ * que escreve o registro completo, incluindo seu terminador. Os trechos
+ * constantes (chaves, separadores e o valor do nível) são literais com
+ * tamanho conhecido em compilação.
+ *
+ * format() é um atalho para format_message() com format_detail::PlainMessage;
+ * mensagens de template (message_catalog.hpp) usam a mesma função com um
+ * Message que já traz o texto fixo escapado.
+ */
+
+/**
+ * @brief Funções de formatação que escrevem em qualquer saída com
+ * append(const char*, size_t) e push_back(char), sem alocar
+ *
+ * Saídas usadas hoje: std::string e SlabRecord.
+ */
+namespace format_detail {
+    static const size_t TIMESTAMP_SIZE = TimestampCache::SIZE;   ///< "YYYY-MM-DDTHH:MM:SS.mmmZ"
+
+    inline const char* level_to_string(LogLevel level) {
+        switch (level) {
+            case LogLevel::INFO: return "INFO";
+            case LogLevel::WARNING: return "WARNING";
+            case LogLevel::ERROR: return "ERROR";
+        }
+
+        return "UNKNOWN";
+    }
+
+    template<typename Out>
+    void append_literal(Out& out, const char* text) {
+        out.append(text, std::strlen(text));
+    }
+
+    /// Acrescenta um literal com tamanho conhecido em compilação (sem strlen)
+    template<typename Out, size_t N>
+    void append_fixed(Out& out, const char (&text)[N]) {
+        out.append(text, N - 1);
+    }
+
+    /// Acrescenta value em little-endian com exatamente sizeof(T) bytes
+    template<typename Out, typename T>
+    void append_le(Out& out, T value) {
+        char bytes[sizeof(T)];
+        uint64_t bits = static_cast<uint64_t>(value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            bytes[i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+        }
+        out.append(bytes, sizeof(T));
+    }
+
+    /// Escapa a mensagem (aspas, barra invertida e caracteres de controle)
+    template<typename Out>
+    void escape_json_string(Out& out, const char* str, size_t size) {
+        json_escape::escape(out, str, size);
+    }
+
+    /**
+     * @brief Formata um instante em UTC sem alocar
+     * @param out Destino com pelo menos TIMESTAMP_SIZE bytes
+     * @param time Instante a ser formatado
+     * @return Quantidade de bytes escritos
+     *
+     * Usa o TimestampCache da thread atual: gmtime_r só roda uma vez por segundo.
+     */
+    inline size_t write_timestamp(char* out, std::chrono::system_clock::time_point time) {
+        return TimestampCache::format_cached(out, time);
+    }
+
+    /**
+     * @brief Mensagem de texto comum, escapada na formatação
+     *
+     * Modelo do parâmetro Message de format_message(): size() é o tamanho
+     * sem escape, append_escaped() escreve o texto escapado para JSON/logfmt
+     * e append_raw() o texto como está (formato binário).
+     */
+    struct PlainMessage {
+        const char* data;                   ///< Texto da mensagem
+        size_t length;                      ///< Tamanho em bytes
+
+        PlainMessage(const char* data, size_t length) : data(data), length(length) {}
+
+        size_t size() const {
+            return length;
+        }
+
+        template<typename Out>
+        void append_escaped(Out& out) const {
+            json_escape::escape(out, data, length);
+        }
+
+        template<typename Out>
+        void append_raw(Out& out) const {
+            out.append(data, length);
+        }
+    };
+
+    template<typename Out>
+    void append_int(Out& out, int value) {
+        char digits[16];
+        char* end = digits + sizeof(digits);
+        char* begin = end;
+        unsigned magnitude = value < 0 ? 0u - static_cast<unsigned>(value) : static_cast<unsigned>(value);
+
+        do {
+            *--begin = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+
+        if (value < 0) {
+            *--begin = '-';
+        }
+
+        out.append(begin, static_cast<size_t>(end - begin));
+    }
+}
+
+/**
+ * @brief JSON compacto, um objeto por linha (JSON Lines)
+ *
+ * Formato de saída:
+ * @code
+ * {"timestamp":"2025-08-31T16:32:01.123Z","level":"ERROR","producer_id":3,"message":"Mensagem do erro"}
+ * @endcode
+ */
+struct JsonLinesFormatter {
+    template<typename Out>
+    static void format(Out& json, std::chrono::system_clock::time_point time, LogLevel level,
+                       int producer_id, const char* message, size_t message_size) {
+        format_message(json, time, level, producer_id, format_detail::PlainMessage(message, message_size));
+    }
+
+    template<typename Out, typename Message>
+    static void format_message(Out& json, std::chrono::system_clock::time_point time, LogLevel level,
+                               int producer_id, const Message& message) {
+        using namespace format_detail;
+
+        char timestamp[TIMESTAMP_SIZE];
+        size_t timestamp_size = write_timestamp(timestamp, time);
+
+        append_fixed(json, "{\"timestamp\":\"");
+        json.append(timestamp, timestamp_size);
+        switch (level) {
+            case LogLevel::INFO: append_fixed(json, "\",\"level\":\"INFO\",\"producer_id\":"); break;
+            case LogLevel::WARNING: append_fixed(json, "\",\"level\":\"WARNING\",\"producer_id\":"); break;
+            case LogLevel::ERROR: append_fixed(json, "\",\"level\":\"ERROR\",\"producer_id\":"); break;
+        }
+        append_int(json, producer_id);
+        append_fixed(json, ",\"message\":\"");
+        message.append_escaped(json);
+        append_fixed(json, "\"}\n");
+    }
+};
+
+/**
+ * @brief Formato JSON indentado, um objeto por registro terminado em "},"
+ *
+ * Formato de saída:
+ * @code
+ * {
+ *   "timestamp": "2025-08-31T16:32:01.123Z",
+ *   "level": "ERROR",
+ *   "producer_id": 3,
+ *   "message": "Mensagem do erro"
+ * },
+ * @endcode
+ */
+struct PrettyJsonFormatter {
+    template<typename Out>
+    static void format(Out& json, std::chrono::system_clock::time_point time, LogLevel level,
+                       int producer_id, const char* message, size_t message_size) {
+        format_message(json, time, level, producer_id, format_detail::PlainMessage(message, message_size));
+    }
+
+    template<typename Out, typename Message>
+    static void format_message(Out& json, std::chrono::system_clock::time_point time, LogLevel level,
+                               int producer_id, const Message& message) {
+        using namespace format_detail;
+
+        char timestamp[TIMESTAMP_SIZE];
+        size_t timestamp_size = write_timestamp(timestamp, time);
+
+        append_fixed(json, "{\n  \"timestamp\": \"");
+        json.append(timestamp, timestamp_size);
+        switch (level) {
+            case LogLevel::INFO: append_fixed(json, "\",\n  \"level\": \"INFO\",\n  \"producer_id\": "); break;
+            case LogLevel::WARNING: append_fixed(json, "\",\n  \"level\": \"WARNING\",\n  \"producer_id\": "); break;
+            case LogLevel::ERROR: append_fixed(json, "\",\n  \"level\": \"ERROR\",\n  \"producer_id\": "); break;
+        }
+        append_int(json, producer_id);
+        append_fixed(json, ",\n  \"message\": \"");
+        message.append_escaped(json);
+        append_fixed(json, "\"\n},\n");
+    }
+};
+
+/**
+ * @brief Formato logfmt (chave=valor), um registro por linha
+ *
+ * Formato de saída:
+ * @code
+ * ts=2025-08-31T16:32:01.123Z level=ERROR producer_id=3 msg="Mensagem do erro"
+ * @endcode
+ */
+struct LogfmtFormatter {
+    template<typename Out>
+    static void format(Out& out, std::chrono::system_clock::time_point time, LogLevel level,
+                       int producer_id, const char* message, size_t message_size) {
+        format_message(out, time, level, producer_id, format_detail::PlainMessage(message, message_size));
+    }
+
+    template<typename Out, typename Message>
+    static void format_message(Out& out, std::chrono::system_clock::time_point time, LogLevel level,
+                               int producer_id, const Message& message) {
+        using namespace format_detail;
+
+        char timestamp[TIMESTAMP_SIZE];
+        size_t timestamp_size = write_timestamp(timestamp, time);
+
+        append_fixed(out, "ts=");
+        out.append(timestamp, timestamp_size);
+        switch (level) {
+            case LogLevel::INFO: append_fixed(out, " level=INFO producer_id="); break;
+            case LogLevel::WARNING: append_fixed(out, " level=WARNING producer_id="); break;
+            case LogLevel::ERROR: append_fixed(out, " level=ERROR producer_id="); break;
+        }
+        append_int(out, producer_id);
+        append_fixed(out, " msg=\"");
+        message.append_escaped(out);
+        append_fixed(out, "\"\n");
+    }
+};
+
+/**
+ * @brief Formato binário com prefixo de tamanho, em little-endian
+ *
+ * Layout de cada registro:
+ * | bytes | campo                                          |
+ * |-------|------------------------------------------------|
+ * | 4     | tamanho do restante do registro (uint32)       |
+ * | 8     | instante em nanossegundos desde a época (int64)|
+ * | 1     | nível (valor de LogLevel)                      |
+ * | 4     | producer_id (int32)                            |
+ * | N     | mensagem sem escape                            |
+ */
+struct BinaryFormatter {
+    static const size_t HEADER_SIZE = 4;                 ///< Prefixo de tamanho
+    static const size_t FIXED_FIELDS_SIZE = 8 + 1 + 4;   ///< Instante, nível e producer_id
+
+    template<typename Out>
+    static void format(Out& out, std::chrono::system_clock::time_point time, LogLevel level,
+                       int producer_id, const char* message, size_t message_size) {
+        format_message(out, time, level, producer_id, format_detail::PlainMessage(message, message_size));
+    }
+
+    template<typename Out, typename Message>
+    static void format_message(Out& out, std::chrono::system_clock::time_point time, LogLevel level,
+                               int producer_id, const Message& message) {
+        using namespace format_detail;
+
+        int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+
+        append_le(out, static_cast<uint32_t>(FIXED_FIELDS_SIZE + message.size()));
+        append_le(out, nanos);
+        out.push_back(static_cast<char>(level));
+        append_le(out, static_cast<int32_t>(producer_id));
+        message.append_raw(out);
+    }
+};
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+
+#include "log_level.hpp"
+#include "record.hpp"
+#include "flush_policy.hpp"
+#include "file_writer.hpp"
+
+/**
+ * @brief Entrada do índice esparso de um IndexedFileWriter
+ *
+ * Cada entrada resume um bloco contíguo do arquivo de log (alguns KiB de
+ * registros inteiros). Gravada no arquivo "<log>.lidx" com 44 bytes em
+ * little-endian:
+ * | bytes | campo                                                       |
+ * |-------|-------------------------------------------------------------|
+ * | 8     | offset do bloco no arquivo de log (uint64)                  |
+ * | 4     | tamanho do bloco (uint32)                                   |
+ * | 4     | quantidade de registros no bloco (uint32)                   |
+ * | 8     | menor instante em ns desde a época (int64)                  |
+ * | 8     | maior instante em ns desde a época (int64)                  |
+ * | 4     | níveis presentes, um bit por valor de LogLevel (uint32)     |
+ * | 8     | producers presentes, bit (producer_id % 64) (uint64)        |
+ *
+ * As colunas de níveis e producers formam, ao longo do índice, um bitmap
+ * por nível e por producer: a leitura descarta os blocos em que o bit
+ * pedido está zerado sem tocar no arquivo de log.
+ */
+struct LogIndexEntry {
+    static const size_t ENCODED_SIZE = 44;  ///< Bytes de cada entrada no arquivo
+
+    uint64_t offset;                        ///< Início do bloco no arquivo de log
+    uint32_t size;                          ///< Bytes do bloco
+    uint32_t record_count;                  ///< Registros no bloco
+    int64_t min_time;                       ///< Menor instante (ns); registros sem instante alargam o intervalo
+    int64_t max_time;                       ///< Maior instante (ns)
+    uint32_t levels;                        ///< Bit (1 << LogLevel) para cada nível presente
+    uint64_t producers;                     ///< Bit (1 << producer_id % 64) para cada producer presente
+
+    LogIndexEntry()
+        : offset(0),
+          size(0),
+          record_count(0),
+          min_time(std::numeric_limits<int64_t>::max()),
+          max_time(std::numeric_limits<int64_t>::min()),
+          levels(0),
+          producers(0) {}
+
+    /// Bit de um nível na coluna levels
+    static uint32_t level_bit(LogLevel level) {
+        return 1u << static_cast<unsigned>(level);
+    }
+
+    /// Bit de um producer na coluna producers
+    static uint64_t producer_bit(int producer_id) {
+        return 1ull << (static_cast<unsigned>(producer_id) % 64);
+    }
+
+    /// Inclui um registro no resumo do bloco
+    void add(bool has_time, int64_t time, LogLevel level, bool has_producer, int producer_id) {
+        ++record_count;
+        if (has_time) {
+            min_time = std::min(min_time, time);
+            max_time = std::max(max_time, time);
+        } else {
+            // Sem instante, o bloco precisa ser lido em qualquer consulta por tempo
+            min_time = std::numeric_limits<int64_t>::min();
+            max_time = std::numeric_limits<int64_t>::max();
+        }
+        levels |= level_bit(level);
+        // Sem producer_id, o bloco precisa ser lido em qualquer consulta por producer
+        producers |= has_producer ? producer_bit(producer_id) : ~0ull;
+    }
+
+    /// Junta o resumo de registros gravados logo em seguida
+    void merge(const LogIndexEntry& other) {
+        size += other.size;
+        record_count += other.record_count;
+        min_time = std::min(min_time, other.min_time);
+        max_time = std::max(max_time, other.max_time);
+        levels |= other.levels;
+        producers |= other.producers;
+    }
+
+    void encode(char* out) const {
+        put(out, offset, 8);
+        put(out + 8, size, 4);
+        put(out + 12, record_count, 4);
+        put(out + 16, static_cast<uint64_t>(min_time), 8);
+        put(out + 24, static_cast<uint64_t>(max_time), 8);
+        put(out + 32, levels, 4);
+        put(out + 36, producers, 8);
+    }
+
+    static LogIndexEntry decode(const char* in) {
+        LogIndexEntry entry;
+        entry.offset = get(in, 8);
+        entry.size = static_cast<uint32_t>(get(in + 8, 4));
+        entry.record_count = static_cast<uint32_t>(get(in + 12, 4));
+        entry.min_time = static_cast<int64_t>(get(in + 16, 8));
+        entry.max_time = static_cast<int64_t>(get(in + 24, 8));
+        entry.levels = static_cast<uint32_t>(get(in + 32, 4));
+        entry.producers = get(in + 36, 8);
+        return entry;
+    }
+
+private:
+    static void put(char* out, uint64_t value, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    static uint64_t get(const char* in, size_t size) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+        }
+        return value;
+    }
+};
+
+/**
+ * @brief Auxiliares do índice (instantes e nomes de arquivo)
+ */
+namespace log_index {
+    /// Instante em nanossegundos desde a época, como gravado no índice
+    inline int64_t to_nanos(std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    /// Nome do arquivo de índice de um log
+    inline std::string index_path(const std::string& log_path) {
+        return log_path + ".lidx";
+    }
+}
+
+/**
+ * @brief Configuração do índice gravado pelo IndexedFileWriter
+ */
+class IndexOptions {
+public:
+    /// Blocos de 64 KiB
+    static IndexOptions defaults() {
+        return IndexOptions();
+    }
+
+    /**
+     * @brief Tamanho a partir do qual o bloco atual é fechado e indexado
+     *
+     * Blocos menores deixam as consultas mais seletivas e o índice maior
+     * (44 bytes por bloco). Um lote nunca é dividido entre blocos.
+     */
+    IndexOptions with_block_bytes(size_t bytes) const {
+        IndexOptions options(*this);
+        options.block = bytes > 0 ? bytes : 1;
+        return options;
+    }
+
+    size_t block_bytes() const { return block; }
+
+private:
+    size_t block;                           ///< Bytes por bloco indexado
+
+    IndexOptions() : block(64 * 1024) {}
+};
+
+/**
+ * @brief FileWriter que mantém um índice esparso consultável do arquivo
+ *
+ * Mesma interface do FileWriter (e o mesmo construtor, então também serve
+ * de escritor de segmento para BasicRotatingFileWriter, com um índice por
+ * segmento). Os registros vão para o arquivo exatamente como no FileWriter;
+ * ao lado, "<arquivo>.lidx" recebe uma LogIndexEntry a cada bloco de
+ * with_block_bytes(): intervalo de tempo, níveis e producers do bloco.
+ * IndexedLogReader (indexed_log_reader.hpp) usa o índice para ler apenas
+ * os blocos que podem conter o que a consulta pede.
+ *
+ * Os campos são lidos dos registros na thread do consumer, fora do lock;
+ * funciona com os formatos de texto (JSON Lines, JSON indentado e logfmt).
+ */
+class IndexedFileWriter {
+public:
+    /**
+     * @brief Construtor
+     * @param filename Arquivo de log; o índice é "<filename>.lidx"
+     * @param policy Política de flush do arquivo de log
+     * @param options Tamanho dos blocos indexados
+     * @throws std::runtime_error se não conseguir abrir o arquivo ou o índice
+     */
+    explicit IndexedFileWriter(const std::string& filename, const FlushPolicy& policy = FlushPolicy::every_record(),
+                               const IndexOptions& options = IndexOptions::defaults())
+        : writer(filename, policy),
+          options(options),
+          data_bytes(existing_size(filename)) {
+        index.open(log_index::index_path(filename), std::ios::binary | std::ios::app);
+        if (!index.is_open()) {
+            throw std::runtime_error("Não foi possível abrir o índice: " + log_index::index_path(filename));
+        }
+    }
+
+    ~IndexedFileWriter() {
+        close();
+    }
+
+    /**
+     * @brief Adiciona registro formatado ao arquivo de log
+     * @param record Registro completo, já com seu terminador
+     */
+    void append(const std::string& record) {
+        append(record, level_from_text(record));
+    }
+
+    /**
+     * @brief Adiciona registro formatado cujo nível já é conhecido
+     * @param record Registro completo, já com seu terminador
+     * @param level Nível do registro
+     */
+    void append(const std::string& record, LogLevel level) {
+        std::chrono::system_clock::time_point time;
+        bool has_time = time_from_text(record, time);
+
+        LogIndexEntry summary;
+        add_to_summary(summary, record.data(), record.size(), has_time ? &time : nullptr, level);
+        summary.size = static_cast<uint32_t>(record.size());
+
+        std::lock_guard<std::mutex> lock(index_mutex);
+        writer.append(record, level);
+        index_written(summary);
+    }
+
+    /**
+     * @brief Adiciona um lote de registros ao arquivo de log
+     * @tparam Record Tipo do registro, acessado via append_record(), record_level() e record_time()
+     * @param records Registros a serem escritos, na ordem do vetor
+     *
+     * Como no FileWriter, o lote é concatenado fora da seção crítica e
+     * gravado com uma escrita; o resumo do lote (tempo, níveis, producers)
+     * também é montado antes do lock.
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        static thread_local std::string block;
+        block.clear();
+
+        LogIndexEntry summary;
+        LogLevel max_level = LogLevel::INFO;
+        std::chrono::system_clock::time_point time;
+        for (size_t i = 0; i < records.size(); ++i) {
+            size_t start = block.size();
+            append_record(block, records[i]);
+
+            LogLevel level = record_level(records[i]);
+            if (level > max_level) {
+                max_level = level;
+            }
+            bool has_time = record_time(records[i], time);
+            add_to_summary(summary, block.data() + start, block.size() - start,
+                           has_time ? &time : nullptr, level);
+        }
+        summary.size = static_cast<uint32_t>(block.size());
+
+        std::lock_guard<std::mutex> lock(index_mutex);
+        writer.append(block, max_level);
+        index_written(summary);
+    }
+
+    /**
+     * @brief Verifica se o arquivo está aberto e operacional
+     */
+    bool is_open() const {
+        return writer.is_open();
+    }
+
+    /// Nome do arquivo de log
+    const std::string& get_filename() const {
+        return writer.get_filename();
+    }
+
+    /**
+     * @brief Indexa o bloco em andamento e grava arquivo e índice
+     *
+     * Depois do flush(), tudo que já foi gravado aparece no índice.
+     */
+    void flush() {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        writer.flush();
+        close_block();
+        index.flush();
+    }
+
+    /**
+     * @brief Fecha arquivo e índice
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        writer.close();
+        if (index.is_open()) {
+            close_block();
+            index.close();
+        }
+    }
+
+private:
+    FileWriter writer;                  ///< Grava os registros (e aplica a política de flush)
+    IndexOptions options;               ///< Tamanho dos blocos
+
+    std::mutex index_mutex;             ///< Mantém a ordem entre arquivo e índice
+    std::ofstream index;                ///< "<arquivo>.lidx"
+    uint64_t data_bytes;                ///< Tamanho do arquivo de log (offset da próxima escrita)
+    LogIndexEntry open_block;           ///< Resumo do bloco ainda não indexado
+
+    static uint64_t existing_size(const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary | std::ios::ate);
+        if (!in.is_open()) {
+            return 0;
+        }
+        std::streamoff size = in.tellg();
+        return size > 0 ? static_cast<uint64_t>(size) : 0;
+    }
+
+    static void add_to_summary(LogIndexEntry& summary, const char* text, size_t size,
+                               const std::chrono::system_clock::time_point* time, LogLevel level) {
+        int producer_id = 0;
+        bool has_producer = producer_from_text(text, size, producer_id);
+        summary.add(time != nullptr, time != nullptr ? log_index::to_nanos(*time) : 0,
+                    level, has_producer, producer_id);
+    }
+
+    /// Junta ao bloco aberto o que acabou de ser gravado (index_mutex adquirido)
+    void index_written(const LogIndexEntry& summary) {
+        if (open_block.record_count == 0) {
+            open_block = LogIndexEntry();
+            open_block.offset = data_bytes;
+        }
+        open_block.merge(summary);
+        data_bytes += summary.size;
+
+        if (open_block.size >= options.block_bytes()) {
+            close_block();
+        }
+    }
+
+    /// Grava a entrada do bloco aberto (index_mutex adquirido)
+    void close_block() {
+        if (open_block.record_count == 0 || !index.is_open()) {
+            return;
+        }
+        char bytes[LogIndexEntry::ENCODED_SIZE];
+        open_block.encode(bytes);
+        index.write(bytes, sizeof(bytes));
+        open_block = LogIndexEntry();
+    }
+
+    // Desabilita cópia para evitar problemas com mutex
+    IndexedFileWriter(const IndexedFileWriter&) = delete;
+    IndexedFileWriter& operator=(const IndexedFileWriter&) = delete;
+};
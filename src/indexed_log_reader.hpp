@@ -0,0 +1,289 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "log_level.hpp"
+#include "timestamp.hpp"
+#include "indexed_file_writer.hpp"
+
+/**
+ * @brief Filtros de uma consulta ao IndexedLogReader
+ *
+ * Os critérios são combinados (todos precisam valer). Exemplo: erros do
+ * producer 3 nos últimos 5 minutos:
+ * @code
+ * LogQuery::all().with_min_level(LogLevel::ERROR).with_producer(3).with_last(std::chrono::minutes(5))
+ * @endcode
+ */
+class LogQuery {
+public:
+    /// Sem filtros: todos os registros
+    static LogQuery all() {
+        return LogQuery();
+    }
+
+    /// Apenas registros com nível a partir de level
+    LogQuery with_min_level(LogLevel level) const {
+        LogQuery query(*this);
+        query.minimum_level = level;
+        return query;
+    }
+
+    /// Apenas registros de um producer
+    LogQuery with_producer(int producer_id) const {
+        LogQuery query(*this);
+        query.has_producer = true;
+        query.producer = producer_id;
+        return query;
+    }
+
+    /// Apenas registros a partir de time (inclusive)
+    LogQuery with_since(std::chrono::system_clock::time_point time) const {
+        LogQuery query(*this);
+        query.since_nanos = log_index::to_nanos(time);
+        return query;
+    }
+
+    /// Apenas registros até time (inclusive)
+    LogQuery with_until(std::chrono::system_clock::time_point time) const {
+        LogQuery query(*this);
+        query.until_nanos = log_index::to_nanos(time);
+        return query;
+    }
+
+    /// Apenas registros do último período, contado a partir de agora
+    template<typename Rep, typename Period>
+    LogQuery with_last(std::chrono::duration<Rep, Period> period) const {
+        return with_since(std::chrono::system_clock::now() -
+                          std::chrono::duration_cast<std::chrono::system_clock::duration>(period));
+    }
+
+    /// O bloco pode conter registros que atendem à consulta
+    bool may_match(const LogIndexEntry& entry) const {
+        if (entry.max_time < since_nanos || entry.min_time > until_nanos) {
+            return false;
+        }
+        uint32_t wanted_levels = ~(LogIndexEntry::level_bit(minimum_level) - 1);
+        if ((entry.levels & wanted_levels) == 0) {
+            return false;
+        }
+        return !has_producer || (entry.producers & LogIndexEntry::producer_bit(producer)) != 0;
+    }
+
+    /// O registro atende à consulta (campos lidos do texto)
+    bool matches(const char* record, size_t size) const {
+        if (level_from_text(record, size) < minimum_level) {
+            return false;
+        }
+        if (has_producer) {
+            int producer_id = 0;
+            if (!producer_from_text(record, size, producer_id) || producer_id != producer) {
+                return false;
+            }
+        }
+        if (since_nanos != std::numeric_limits<int64_t>::min() || until_nanos != std::numeric_limits<int64_t>::max()) {
+            std::chrono::system_clock::time_point time;
+            if (!time_from_text(record, size, time)) {
+                return false;
+            }
+            int64_t nanos = log_index::to_nanos(time);
+            if (nanos < since_nanos || nanos > until_nanos) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    LogLevel minimum_level;                 ///< Nível mínimo
+    bool has_producer;                      ///< Filtra por producer
+    int producer;                           ///< Producer pedido
+    int64_t since_nanos;                    ///< Início do intervalo (ns desde a época)
+    int64_t until_nanos;                    ///< Fim do intervalo (ns desde a época)
+
+    LogQuery()
+        : minimum_level(LogLevel::INFO),
+          has_producer(false),
+          producer(0),
+          since_nanos(std::numeric_limits<int64_t>::min()),
+          until_nanos(std::numeric_limits<int64_t>::max()) {}
+};
+
+/**
+ * @brief Quanto do arquivo uma consulta precisou ler
+ */
+struct QueryStats {
+    size_t blocks_total;                    ///< Blocos no índice
+    size_t blocks_read;                     ///< Blocos que passaram pelo índice e foram lidos
+    uint64_t bytes_read;                    ///< Bytes do log examinados (blocos lidos e trechos sem índice)
+    uint64_t records_matched;               ///< Registros entregues ao callback
+};
+
+/**
+ * @brief Consulta por tempo, nível e producer em logs gravados pelo IndexedFileWriter
+ *
+ * O arquivo de log é mapeado em memória e o índice "<arquivo>.lidx" é lido
+ * inteiro (44 bytes por bloco). Uma consulta percorre o índice, lê apenas
+ * os blocos cujo resumo é compatível e filtra registro a registro dentro
+ * deles. Trechos do log sem entrada no índice (o bloco que ainda não foi
+ * indexado quando o processo parou, ou um log anterior ao índice) são
+ * lidos por inteiro, então nada fica de fora.
+ *
+ * Os registros são entregues como gravados, em JSON Lines, JSON indentado
+ * ("},") ou logfmt. Apenas POSIX.
+ */
+class IndexedLogReader {
+public:
+    /**
+     * @brief Abre o log e carrega seu índice
+     * @param log_path Arquivo de log; o índice (opcional) é "<log_path>.lidx"
+     * @throws std::runtime_error se não conseguir abrir ou mapear o log
+     */
+    explicit IndexedLogReader(const std::string& log_path)
+        : data(nullptr),
+          size(0) {
+        int fd = ::open(log_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Não foi possível abrir o arquivo de log: " + log_path);
+        }
+        struct stat status;
+        if (::fstat(fd, &status) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Não foi possível ler o tamanho do arquivo de log: " + log_path);
+        }
+        size = static_cast<size_t>(status.st_size);
+        if (size > 0) {
+            void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Não foi possível mapear o arquivo de log: " + log_path);
+            }
+            data = static_cast<const char*>(mapped);
+        }
+        ::close(fd);
+
+        load_index(log_index::index_path(log_path));
+    }
+
+    ~IndexedLogReader() {
+        if (data != nullptr) {
+            ::munmap(const_cast<char*>(data), size);
+        }
+    }
+
+    /**
+     * @brief Entrega ao callback cada registro que atende à consulta, na ordem do arquivo
+     * @param filter Filtros
+     * @param on_record Chamado como on_record(const char* record, size_t size), com o terminador incluído
+     * @return Quanto do arquivo foi lido
+     */
+    template<typename Callback>
+    QueryStats query(const LogQuery& filter, Callback on_record) const {
+        QueryStats stats;
+        stats.blocks_total = entries.size();
+        stats.blocks_read = 0;
+        stats.bytes_read = 0;
+        stats.records_matched = 0;
+
+        uint64_t position = 0;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const LogIndexEntry& entry = entries[i];
+            if (entry.offset > position) {
+                scan(position, entry.offset, filter, on_record, stats);
+            }
+            if (filter.may_match(entry)) {
+                ++stats.blocks_read;
+                scan(entry.offset, entry.offset + entry.size, filter, on_record, stats);
+            }
+            position = entry.offset + entry.size;
+        }
+        scan(position, size, filter, on_record, stats);
+        return stats;
+    }
+
+    /// Blocos no índice
+    size_t block_count() const {
+        return entries.size();
+    }
+
+    /// Tamanho do arquivo de log mapeado
+    size_t file_size() const {
+        return size;
+    }
+
+private:
+    const char* data;                       ///< Arquivo de log mapeado (nullptr se vazio)
+    size_t size;                            ///< Bytes mapeados
+    std::vector<LogIndexEntry> entries;     ///< Índice, em ordem de offset
+
+    /// Carrega o índice, descartando entradas que apontam além do log (ex: log truncado)
+    void load_index(const std::string& index_path) {
+        std::ifstream in(index_path, std::ios::binary);
+        if (!in.is_open()) {
+            return;
+        }
+        char bytes[LogIndexEntry::ENCODED_SIZE];
+        uint64_t position = 0;
+        while (in.read(bytes, sizeof(bytes))) {
+            LogIndexEntry entry = LogIndexEntry::decode(bytes);
+            if (entry.offset < position || entry.offset + entry.size > size) {
+                break;
+            }
+            entries.push_back(entry);
+            position = entry.offset + entry.size;
+        }
+    }
+
+    /**
+     * @brief Filtra os registros entre begin e end
+     *
+     * Um registro indentado começa com "{\n" e termina em "\n},\n"; nos
+     * demais formatos cada linha é um registro.
+     */
+    template<typename Callback>
+    void scan(uint64_t begin, uint64_t end, const LogQuery& filter, Callback& on_record, QueryStats& stats) const {
+        if (begin >= end || end > size) {
+            return;
+        }
+        stats.bytes_read += end - begin;
+
+        static const char pretty_end[] = "\n},\n";
+        const char* cursor = data + begin;
+        const char* limit = data + end;
+        while (cursor < limit) {
+            const char* record_end;
+            if (limit - cursor >= 2 && cursor[0] == '{' && cursor[1] == '\n') {
+                record_end = std::search(cursor, limit, pretty_end, pretty_end + sizeof(pretty_end) - 1);
+                record_end = record_end == limit ? limit : record_end + sizeof(pretty_end) - 1;
+            } else {
+                record_end = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<size_t>(limit - cursor)));
+                record_end = record_end == nullptr ? limit : record_end + 1;
+            }
+
+            size_t record_size = static_cast<size_t>(record_end - cursor);
+            if (filter.matches(cursor, record_size)) {
+                ++stats.records_matched;
+                on_record(cursor, record_size);
+            }
+            cursor = record_end;
+        }
+    }
+
+    // Desabilita cópia, o mapeamento pertence a esta instância
+    IndexedLogReader(const IndexedLogReader&) = delete;
+    IndexedLogReader& operator=(const IndexedLogReader&) = delete;
+};
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define SPD_JSON_ESCAPE_SSE2 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SPD_JSON_ESCAPE_NEON 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Escape de strings JSON com varredura vetorizada
+ *
+ * Procura, 16 ou 32 bytes por vez, os únicos bytes que precisam de escape
+ * em JSON: aspas, barra invertida e caracteres de controle (< 0x20). Os
+ * trechos limpos entre eles são copiados em bloco, então uma mensagem sem
+ * nada a escapar custa praticamente um memcpy.
+ *
+ * O conjunto de instruções é escolhido na compilação: AVX2 (com -mavx2 ou
+ * -march apropriado), SSE2 (todo x86-64), NEON (ARM) ou laço escalar.
+ */
+namespace json_escape {
+    /// Maior expansão possível de um byte (controle vira "\u00XX")
+    static const size_t MAX_EXPANSION = 6;
+
+    namespace detail {
+        inline unsigned count_trailing_zeros(uint32_t mask) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        inline bool needs_escape(unsigned char c) {
+            return c < 0x20 || c == '"' || c == '\\';
+        }
+
+        inline size_t find_scalar(const char* text, size_t begin, size_t size) {
+            for (size_t i = begin; i < size; ++i) {
+                if (needs_escape(static_cast<unsigned char>(text[i]))) {
+                    return i;
+                }
+            }
+            return size;
+        }
+
+        /**
+         * @brief Escreve a sequência de escape de c
+         * @param out Destino com pelo menos MAX_EXPANSION bytes
+         * @return Bytes escritos
+         */
+        inline size_t write_escape(char* out, unsigned char c) {
+            static const char hex[] = "0123456789abcdef";
+
+            out[0] = '\\';
+            switch (c) {
+                case '"': out[1] = '"'; return 2;
+                case '\\': out[1] = '\\'; return 2;
+                case '\b': out[1] = 'b'; return 2;
+                case '\f': out[1] = 'f'; return 2;
+                case '\n': out[1] = 'n'; return 2;
+                case '\r': out[1] = 'r'; return 2;
+                case '\t': out[1] = 't'; return 2;
+                default: break;
+            }
+
+            out[1] = 'u';
+            out[2] = '0';
+            out[3] = '0';
+            out[4] = hex[c >> 4];
+            out[5] = hex[c & 0x0F];
+            return 6;
+        }
+
+        /// Lê quatro dígitos hexadecimais de um "\\uXXXX"
+        inline bool read_hex4(const char* text, const char* end, uint32_t& value) {
+            if (end - text < 4) {
+                return false;
+            }
+            value = 0;
+            for (int i = 0; i < 4; ++i) {
+                char c = text[i];
+                value <<= 4;
+                if (c >= '0' && c <= '9') {
+                    value |= static_cast<uint32_t>(c - '0');
+                } else if (c >= 'a' && c <= 'f') {
+                    value |= static_cast<uint32_t>(c - 'a' + 10);
+                } else if (c >= 'A' && c <= 'F') {
+                    value |= static_cast<uint32_t>(c - 'A' + 10);
+                } else {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<typename Out>
+        void append_utf8(Out& out, uint32_t code) {
+            if (code < 0x80) {
+                out.push_back(static_cast<char>(code));
+            } else if (code < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            } else if (code < 0x10000) {
+                out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            } else {
+                out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+        }
+    }
+
+    /**
+     * @brief Encontra o primeiro byte que precisa de escape
+     * @param text Início do texto
+     * @param size Tamanho do texto
+     * @return Índice do byte, ou size se nenhum precisar de escape
+     */
+    inline size_t find_escape(const char* text, size_t size) {
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        const __m256i quote32 = _mm256_set1_epi8('"');
+        const __m256i backslash32 = _mm256_set1_epi8('\\');
+        const __m256i control32 = _mm256_set1_epi8(0x1F);
+
+        for (; i + 32 <= size; i += 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+            __m256i hits = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote32), _mm256_cmpeq_epi8(chunk, backslash32)),
+                _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control32), chunk));  // chunk <= 0x1F
+
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+            if (mask != 0) {
+                return i + detail::count_trailing_zeros(mask);
+            }
+        }
+#endif
+
+#if defined(SPD_JSON_ESCAPE_SSE2)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1F);
+
+        for (; i + 16 <= size; i += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));          // chunk <= 0x1F
+
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+            if (mask != 0) {
+                return i + detail::count_trailing_zeros(mask);
+            }
+        }
+#elif defined(SPD_JSON_ESCAPE_NEON)
+        const uint8x16_t quote = vdupq_n_u8('"');
+        const uint8x16_t backslash = vdupq_n_u8('\\');
+        const uint8x16_t control = vdupq_n_u8(0x20);
+
+        for (; i + 16 <= size; i += 16) {
+            uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(text + i));
+            uint8x16_t hits = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                                       vcltq_u8(chunk, control));
+
+            // Algum byte marcado: o índice exato sai do laço escalar dentro do bloco
+            uint64x2_t lanes = vreinterpretq_u64_u8(hits);
+            if ((vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) != 0) {
+                return detail::find_scalar(text, i, i + 16);
+            }
+        }
+#endif
+
+        return detail::find_scalar(text, i, size);
+    }
+
+    /**
+     * @brief Escapa texto para dentro de um buffer do chamador
+     * @param out Destino com pelo menos size * MAX_EXPANSION bytes
+     * @param text Texto original
+     * @param size Tamanho do texto original
+     * @return Bytes escritos em out
+     */
+    inline size_t escape_into(char* out, const char* text, size_t size) {
+        size_t written = 0;
+        size_t position = 0;
+
+        while (position < size) {
+            size_t next = position + find_escape(text + position, size - position);
+
+            std::memcpy(out + written, text + position, next - position);
+            written += next - position;
+
+            if (next == size) {
+                break;
+            }
+
+            written += detail::write_escape(out + written, static_cast<unsigned char>(text[next]));
+            position = next + 1;
+        }
+
+        return written;
+    }
+
+    /**
+     * @brief Escapa texto no final de uma saída com append(const char*, size_t)
+     * @param out Saída (std::string, SlabRecord, ...)
+     * @param text Texto original
+     * @param size Tamanho do texto original
+     */
+    template<typename Out>
+    void escape(Out& out, const char* text, size_t size) {
+        size_t position = 0;
+
+        while (position < size) {
+            size_t next = position + find_escape(text + position, size - position);
+
+            if (next > position) {
+                out.append(text + position, next - position);
+            }
+
+            if (next == size) {
+                break;
+            }
+
+            char sequence[MAX_EXPANSION];
+            size_t length = detail::write_escape(sequence, static_cast<unsigned char>(text[next]));
+            out.append(sequence, length);
+            position = next + 1;
+        }
+    }
+
+    /**
+     * @brief Desfaz o escape de uma string JSON (sem as aspas), no final de out
+     * @param out Saída com append(const char*, size_t) e push_back(char)
+     * @param text Texto escapado
+     * @param size Tamanho do texto escapado
+     * @return Fim do texto consumido: a primeira aspa sem escape, ou text + size
+     *
+     * Aceita todas as sequências de JSON; "\\uXXXX" vira UTF-8 (pares
+     * substitutos incluídos). Sequências inválidas são copiadas como estão.
+     */
+    template<typename Out>
+    const char* unescape(Out& out, const char* text, size_t size) {
+        const char* end = text + size;
+        while (text < end) {
+            const char* stop = text;
+            while (stop < end && *stop != '"' && *stop != '\\') {
+                ++stop;
+            }
+            if (stop > text) {
+                out.append(text, static_cast<size_t>(stop - text));
+            }
+            if (stop == end || *stop == '"') {
+                return stop;
+            }
+
+            text = stop + 1;
+            if (text == end) {
+                out.push_back('\\');
+                return end;
+            }
+            char kind = *text++;
+            switch (kind) {
+                case 'b': out.push_back('\b'); continue;
+                case 'f': out.push_back('\f'); continue;
+                case 'n': out.push_back('\n'); continue;
+                case 'r': out.push_back('\r'); continue;
+                case 't': out.push_back('\t'); continue;
+                case 'u': break;
+                default: out.push_back(kind); continue;
+            }
+
+            uint32_t code = 0;
+            if (!detail::read_hex4(text, end, code)) {
+                out.append("\\u", 2);
+                continue;
+            }
+            text += 4;
+            if (code >= 0xD800 && code < 0xDC00 && end - text >= 6 && text[0] == '\\' && text[1] == 'u') {
+                uint32_t low = 0;
+                if (detail::read_hex4(text + 2, end, low) && low >= 0xDC00 && low < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    text += 6;
+                }
+            }
+            detail::append_utf8(out, code);
+        }
+        return end;
+    }
+}
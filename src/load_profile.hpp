@@ -0,0 +1,225 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief Distribuição do tamanho das mensagens geradas pelo Producer
+ *
+ * canned() usa as mensagens prontas de utils.hpp (como templates do
+ * MessageCatalog); as demais geram texto com o tamanho sorteado, em bytes,
+ * copiado pelo Logger como uma mensagem comum.
+ */
+class MessageSizeDistribution {
+public:
+    enum Kind {
+        CANNED,     ///< Mensagens de utils.hpp
+        FIXED,      ///< Sempre o mesmo tamanho
+        UNIFORM,    ///< Uniforme entre mínimo e máximo
+        LOGNORMAL   ///< Log-normal (maioria pequena, cauda longa), limitada ao máximo
+    };
+
+    static const size_t MAX_BYTES = 64 * 1024;      ///< Maior mensagem gerada
+
+    static MessageSizeDistribution canned() {
+        return MessageSizeDistribution(CANNED, 0, 0, 0.0, 0.0);
+    }
+
+    /**
+     * @throws std::invalid_argument se bytes for 0 ou maior que MAX_BYTES
+     */
+    static MessageSizeDistribution fixed(size_t bytes) {
+        check_range(bytes, bytes);
+        return MessageSizeDistribution(FIXED, bytes, bytes, 0.0, 0.0);
+    }
+
+    /**
+     * @throws std::invalid_argument se o intervalo for vazio, começar em 0 ou passar de MAX_BYTES
+     */
+    static MessageSizeDistribution uniform(size_t min_bytes, size_t max_bytes) {
+        check_range(min_bytes, max_bytes);
+        return MessageSizeDistribution(UNIFORM, min_bytes, max_bytes, 0.0, 0.0);
+    }
+
+    /**
+     * @brief Log-normal com mediana median_bytes e desvio sigma no logaritmo
+     * @param max_bytes Tamanhos sorteados acima disso são limitados a ele
+     * @throws std::invalid_argument se median_bytes ou sigma não forem positivos, ou
+     * se max_bytes for menor que median_bytes ou maior que MAX_BYTES
+     */
+    static MessageSizeDistribution lognormal(size_t median_bytes, double sigma, size_t max_bytes = 4096) {
+        check_range(median_bytes, max_bytes);
+        if (!(sigma > 0.0)) {
+            throw std::invalid_argument("Desvio da distribuição log-normal deve ser positivo");
+        }
+        return MessageSizeDistribution(LOGNORMAL, 1, max_bytes, static_cast<double>(median_bytes), sigma);
+    }
+
+    Kind kind() const { return distribution; }
+    size_t min_bytes() const { return minimum; }
+    size_t max_bytes() const { return maximum; }
+    double median_bytes() const { return median; }
+    double sigma() const { return deviation; }
+
+private:
+    Kind distribution;                  ///< Forma da distribuição
+    size_t minimum;                     ///< Menor tamanho (FIXED, UNIFORM)
+    size_t maximum;                     ///< Maior tamanho
+    double median;                      ///< Mediana (LOGNORMAL)
+    double deviation;                   ///< Desvio no logaritmo (LOGNORMAL)
+
+    MessageSizeDistribution(Kind kind, size_t minimum, size_t maximum, double median, double deviation)
+        : distribution(kind), minimum(minimum), maximum(maximum), median(median), deviation(deviation) {}
+
+    static void check_range(size_t minimum, size_t maximum) {
+        if (minimum == 0 || minimum > maximum || maximum > MAX_BYTES) {
+            throw std::invalid_argument("Tamanho de mensagem deve estar entre 1 e 65536 bytes");
+        }
+    }
+};
+
+/**
+ * @brief Como um Producer gera carga
+ *
+ * interactive() é a demonstração original: uma mensagem pronta a cada
+ * 0-2 s. open_loop(taxa) transforma o Producer em gerador de carga para
+ * dimensionar buffer e escritor: cada envio tem um instante previsto,
+ * calculado só a partir da taxa (malha aberta), e nunca a partir de quando
+ * o envio anterior terminou. Se o Logger bloquear (buffer cheio), os envios
+ * atrasados saem em seguida, sem serem pulados, e a latência de envio
+ * (MetricLatency::SEND) é medida a partir do instante previsto; assim a
+ * espera causada pelo próprio sistema medido entra nos percentis, sem o
+ * erro de "omissão coordenada" de um laço que só mede o tempo de cada push.
+ *
+ * Exemplo: 500 registros/s por producer, rajadas de 10x por 200 ms a cada
+ * 5 s, mensagens log-normais em torno de 300 bytes e 10% de erros:
+ * @code
+ * LoadProfile::open_loop(500)
+ *     .with_burst(10.0, std::chrono::milliseconds(200), std::chrono::seconds(5))
+ *     .with_message_size(MessageSizeDistribution::lognormal(300, 0.8))
+ *     .with_level_mix(60, 30, 10)
+ * @endcode
+ */
+class LoadProfile {
+public:
+    /// Demonstração: intervalos aleatórios de 0 a 2 s, mensagens de utils.hpp
+    static LoadProfile interactive() {
+        return LoadProfile();
+    }
+
+    /**
+     * @brief Taxa fixa por producer, em malha aberta
+     * @param records_per_second Envios por segundo deste producer (o total é a soma dos producers)
+     * @throws std::invalid_argument se a taxa não for positiva
+     */
+    static LoadProfile open_loop(double records_per_second) {
+        if (!(records_per_second > 0.0)) {
+            throw std::invalid_argument("Taxa do gerador de carga deve ser positiva");
+        }
+        LoadProfile profile;
+        profile.target_rate = records_per_second;
+        return profile;
+    }
+
+    /// Intervalos exponenciais com a mesma taxa média (chegadas de Poisson) em vez de constantes
+    LoadProfile with_poisson_arrivals() const {
+        LoadProfile profile(*this);
+        profile.poisson = true;
+        return profile;
+    }
+
+    /**
+     * @brief Multiplica a taxa por multiplier durante length no início de cada period
+     * @throws std::invalid_argument se multiplier não for positivo, period for zero ou length > period
+     */
+    LoadProfile with_burst(double multiplier, std::chrono::milliseconds length, std::chrono::milliseconds period) const {
+        if (!(multiplier > 0.0) || period.count() <= 0 || length.count() < 0 || length > period) {
+            throw std::invalid_argument("Rajada deve ter multiplicador positivo e duração dentro do período");
+        }
+        LoadProfile profile(*this);
+        profile.burst_multiplier = multiplier;
+        profile.burst_length = length;
+        profile.burst_period = period;
+        return profile;
+    }
+
+    LoadProfile with_message_size(const MessageSizeDistribution& sizes) const {
+        LoadProfile profile(*this);
+        profile.sizes = sizes;
+        return profile;
+    }
+
+    /**
+     * @brief Pesos relativos de cada nível (padrão 70/25/5)
+     * @throws std::invalid_argument se todos forem zero
+     */
+    LoadProfile with_level_mix(unsigned info, unsigned warning, unsigned error) const {
+        if (info + warning + error == 0) {
+            throw std::invalid_argument("Ao menos um nível deve ter peso maior que zero");
+        }
+        LoadProfile profile(*this);
+        profile.weights[0] = info;
+        profile.weights[1] = warning;
+        profile.weights[2] = error;
+        return profile;
+    }
+
+    /// O producer para sozinho depois de records envios (0 = até stop())
+    LoadProfile with_max_records(uint64_t records) const {
+        LoadProfile profile(*this);
+        profile.record_limit = records;
+        return profile;
+    }
+
+    bool is_open_loop() const { return target_rate > 0.0; }
+    bool poisson_arrivals() const { return poisson; }
+    double rate() const { return target_rate; }
+    const MessageSizeDistribution& message_size() const { return sizes; }
+    unsigned level_weight(size_t level) const { return weights[level]; }
+    uint64_t max_records() const { return record_limit; }
+
+    /// Taxa média considerando as rajadas
+    double mean_rate() const {
+        double burst_share = static_cast<double>(burst_length.count()) / static_cast<double>(burst_period.count());
+        return target_rate * (1.0 + (burst_multiplier - 1.0) * burst_share);
+    }
+
+    /**
+     * @brief Taxa em vigor em um instante do teste
+     * @param elapsed Tempo desde o início do producer
+     */
+    template<typename Rep, typename Period>
+    double rate_at(std::chrono::duration<Rep, Period> elapsed) const {
+        if (burst_multiplier == 1.0 || burst_length.count() == 0) {
+            return target_rate;
+        }
+        std::chrono::milliseconds phase =
+            std::chrono::duration_cast<std::chrono::milliseconds>(elapsed) % burst_period;
+        return phase < burst_length ? target_rate * burst_multiplier : target_rate;
+    }
+
+private:
+    double target_rate;                             ///< Envios/s (0 = modo interativo)
+    bool poisson;                                   ///< Intervalos exponenciais
+    double burst_multiplier;                        ///< Fator da taxa durante a rajada
+    std::chrono::milliseconds burst_length;         ///< Duração da rajada
+    std::chrono::milliseconds burst_period;         ///< Intervalo entre inícios de rajada
+    MessageSizeDistribution sizes;                  ///< Tamanho das mensagens
+    unsigned weights[3];                            ///< Pesos de INFO, WARNING e ERROR
+    uint64_t record_limit;                          ///< Envios até parar (0 = sem limite)
+
+    LoadProfile()
+        : target_rate(0.0),
+          poisson(false),
+          burst_multiplier(1.0),
+          burst_length(0),
+          burst_period(1),
+          sizes(MessageSizeDistribution::canned()),
+          record_limit(0) {
+        weights[0] = 70;
+        weights[1] = 25;
+        weights[2] = 5;
+    }
+};
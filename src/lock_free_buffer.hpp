@@ -0,0 +1,344 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "backoff.hpp"
+#include "event_count.hpp"
+
+/// Tamanho assumido de uma linha de cache, usado para separar índices disputados
+#define SPD_CACHE_LINE_SIZE 64
+
+/**
+ * @brief Buffer circular limitado, sem lock, para múltiplos producers e consumers
+ *
+ * Alternativa ao MessageBuffer com a mesma interface (push, pop, shutdown,
+ * size e capacity). Usa um anel pré-alocado com tamanho potência de dois em
+ * que cada posição carrega um número de sequência (algoritmo de D. Vyukov):
+ * producers e consumers reservam posições com compare-and-swap nos índices
+ * de escrita e leitura, que ficam em linhas de cache separadas.
+ *
+ * Quando o anel está cheio, push aguarda com Backoff. Quando está vazio, pop
+ * gira, cede a CPU e por fim dorme em um EventCount; producers só acordam
+ * um consumer se houver algum dormindo e o anel estava vazio ou passou de
+ * wake_watermark(), então um pipeline ocioso não consome CPU e um
+ * ocupado não faz chamadas de sistema.
+ *
+ * @tparam T Tipo do registro armazenado (texto formatado, SlabRecord, índices, ...)
+ */
+template<typename T>
+class BasicLockFreeMessageBuffer {
+public:
+    typedef T value_type;       ///< Tipo do registro armazenado
+
+    /**
+     * @brief Construtor que define capacidade mínima do buffer
+     * @param capacity Número mínimo de mensagens que o buffer pode armazenar,
+     * arredondado para a próxima potência de dois
+     * @throws std::invalid_argument se capacity for 0
+     */
+    explicit BasicLockFreeMessageBuffer(size_t capacity)
+        : ring_size(round_up_pow2(capacity)),
+          mask(ring_size - 1),
+          cells(),
+          wake_threshold(wake_watermark(ring_size)),
+          is_shutdown(false) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Capacidade do buffer deve ser maior que zero");
+        }
+
+        cells.reset(new Cell[ring_size]);
+        for (size_t i = 0; i < ring_size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        enqueue_pos.store(0, std::memory_order_relaxed);
+        dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    ~BasicLockFreeMessageBuffer() {
+        shutdown();
+    }
+
+    /**
+     * @brief Tenta adicionar mensagem sem bloquear
+     * @param message Mensagem a ser adicionada
+     * @return true se mensagem foi adicionada, false se buffer estava cheio
+     */
+    bool try_push(const T& message) {
+        size_t pos = 0;
+        if (!try_emplace(message, pos)) {
+            return false;
+        }
+        wake_consumer(pos);
+        return true;
+    }
+
+    /**
+     * @brief Tenta adicionar mensagem sem bloquear, transferindo sua posse
+     * @param message Mensagem a ser movida; permanece intacta se o buffer estiver cheio
+     * @return true se mensagem foi adicionada, false se buffer estava cheio
+     */
+    bool try_push(T&& message) {
+        size_t pos = 0;
+        if (!try_emplace(std::move(message), pos)) {
+            return false;
+        }
+        wake_consumer(pos);
+        return true;
+    }
+
+    /**
+     * @brief Tenta remover mensagem sem bloquear
+     * @param message Referência onde mensagem será armazenada
+     * @return true se mensagem foi removida, false se buffer estava vazio
+     */
+    bool try_pop(T& message) {
+        Cell* cell = nullptr;
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        message = std::move(cell->data);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Adiciona mensagem ao buffer (operação de Producer)
+     * @param message Mensagem a ser adicionada
+     * @return true se mensagem foi adicionada, false se buffer foi fechado
+     *
+     * Aguarda se buffer estiver cheio até haver espaço disponível.
+     * Retorna false apenas se shutdown() foi chamado durante a espera.
+     */
+    bool push(const T& message) {
+        Backoff backoff;
+
+        while (!is_shutdown.load(std::memory_order_acquire)) {
+            if (try_push(message)) {
+                return true;
+            }
+            backoff.pause();
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Adiciona mensagem ao buffer transferindo sua posse
+     * @param message Mensagem a ser movida para o buffer
+     * @return true se mensagem foi adicionada, false se buffer foi fechado
+     */
+    bool push(T&& message) {
+        Backoff backoff;
+
+        while (!is_shutdown.load(std::memory_order_acquire)) {
+            if (try_push(std::move(message))) {
+                return true;
+            }
+            backoff.pause();
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Remove mensagem do buffer (operação de Consumer)
+     * @param message Referência onde mensagem será armazenada
+     * @return true se mensagem foi removida, false se buffer foi fechado
+     *
+     * Aguarda se buffer estiver vazio até haver mensagem disponível.
+     * Retorna false apenas se shutdown() foi chamado e buffer está vazio.
+     */
+    bool pop(T& message) {
+        Backoff backoff;
+
+        for (;;) {
+            if (try_pop(message)) {
+                return true;
+            }
+
+            // Após shutdown, última tentativa para não perder mensagens restantes
+            if (is_shutdown.load(std::memory_order_acquire)) {
+                return try_pop(message);
+            }
+
+            if (!backoff.exhausted()) {
+                backoff.pause();
+                continue;
+            }
+
+            // Verificação final já registrado como esperando: nenhum push se perde
+            uint32_t key = not_empty.prepare_wait();
+            if (try_pop(message)) {
+                not_empty.cancel_wait();
+                return true;
+            }
+            if (is_shutdown.load(std::memory_order_acquire)) {
+                not_empty.cancel_wait();
+                return try_pop(message);
+            }
+            not_empty.wait(key);
+        }
+    }
+
+    /**
+     * @brief Remove várias mensagens do buffer de uma vez (operação de Consumer)
+     * @param messages Vetor que recebe as mensagens removidas (é limpo antes)
+     * @param max_messages Número máximo de mensagens a remover
+     * @return Quantidade de mensagens removidas, 0 se buffer foi fechado
+     *
+     * Aguarda até haver ao menos uma mensagem e então remove, sem esperar,
+     * as disponíveis até max_messages.
+     */
+    size_t pop_batch(std::vector<T>& messages, size_t max_messages) {
+        messages.clear();
+        if (max_messages == 0) {
+            return 0;
+        }
+
+        T message;
+        if (!pop(message)) {
+            return 0;
+        }
+        messages.push_back(std::move(message));
+
+        while (messages.size() < max_messages && try_pop(message)) {
+            messages.push_back(std::move(message));
+        }
+
+        return messages.size();
+    }
+
+    /**
+     * @brief Obtém número aproximado de mensagens no buffer
+     * @return Quantidade de mensagens armazenadas
+     * @note Esta informação pode mudar imediatamente após o retorno
+     */
+    size_t size() const {
+        size_t tail = dequeue_pos.load(std::memory_order_acquire);
+        size_t head = enqueue_pos.load(std::memory_order_acquire);
+
+        return head > tail ? head - tail : 0;
+    }
+
+    /**
+     * @brief Obtém capacidade máxima do buffer
+     * @return Número máximo de mensagens (potência de dois)
+     */
+    size_t capacity() const {
+        return ring_size;
+    }
+
+    /**
+     * @brief Inicia processo de shutdown do buffer
+     *
+     * Threads em push() irão retornar false.
+     * Threads em pop() irão processar mensagens restantes e então retornar false.
+     */
+    void shutdown() {
+        is_shutdown.store(true, std::memory_order_release);
+        not_empty.notify_all();
+    }
+
+private:
+    /// Posição do anel: número de sequência indica se está livre ou ocupada
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    const size_t ring_size;                          ///< Número de posições do anel
+    const size_t mask;                               ///< ring_size - 1, para índice módulo
+    std::unique_ptr<Cell[]> cells;                   ///< Anel pré-alocado
+
+    char pad_head[SPD_CACHE_LINE_SIZE];              ///< Separa índices dos campos constantes
+    std::atomic<size_t> enqueue_pos;                 ///< Próxima posição de escrita (producers)
+    char pad_tail[SPD_CACHE_LINE_SIZE - sizeof(size_t)];
+    std::atomic<size_t> dequeue_pos;                 ///< Próxima posição de leitura (consumers)
+    char pad_end[SPD_CACHE_LINE_SIZE - sizeof(size_t)];
+
+    EventCount not_empty;                            ///< Onde consumers ociosos dormem
+    const size_t wake_threshold;                     ///< Ocupação que acorda mais consumers
+    std::atomic<bool> is_shutdown;                   ///< Flag de shutdown thread-safe
+
+    /**
+     * @brief Acorda um consumer após publicar a posição pos, se necessário
+     *
+     * Com consumers ativos (nenhum dormindo) custa uma barreira e uma leitura.
+     */
+    void wake_consumer(size_t pos) {
+        if (!not_empty.has_waiters()) {
+            return;
+        }
+
+        size_t tail = dequeue_pos.load(std::memory_order_relaxed);
+        if (tail >= pos || pos - tail + 1 >= wake_threshold) {
+            not_empty.notify_one();
+        }
+    }
+
+    template<typename U>
+    bool try_emplace(U&& message, size_t& pos) {
+        Cell* cell = nullptr;
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::forward<U>(message);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    static size_t round_up_pow2(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Desabilita cópia, o anel não pode ser compartilhado
+    BasicLockFreeMessageBuffer(const BasicLockFreeMessageBuffer&) = delete;
+    BasicLockFreeMessageBuffer& operator=(const BasicLockFreeMessageBuffer&) = delete;
+};
+
+/// Buffer sem lock de registros já formatados como texto
+typedef BasicLockFreeMessageBuffer<std::string> LockFreeMessageBuffer;
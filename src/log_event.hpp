@@ -0,0 +1,187 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <memory>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include "log_level.hpp"
+#include "formatter.hpp"
+#include "message_catalog.hpp"
+
+/**
+ * @brief Registro binário de log, formatado apenas no consumer
+ *
+ * O producer grava só os campos crus (instante, nível, id e mensagem) e o
+ * texto final é gerado quando o consumer chama append_record(). A mensagem
+ * pode ser:
+ * - um ponteiro para texto com duração estática (ex: utils::info_messages),
+ *   sem cópia nenhuma;
+ * - uma cópia no payload embutido, se couber em INLINE_CAPACITY bytes;
+ * - uma cópia no heap, para mensagens maiores (caminho raro).
+ *
+ * O formato de saída é escolhido por quem cria o evento via render.
+ *
+ * Com template_id diferente de zero a mensagem é um template do
+ * MessageCatalog (message_catalog.hpp) e o texto guardado são apenas os
+ * argumentos empacotados (message_args), expandidos na formatação.
+ */
+class LogEvent {
+public:
+    static const size_t INLINE_CAPACITY = 112;   ///< Bytes de mensagem guardados no próprio evento
+    static const size_t FORMAT_OVERHEAD = 96;    ///< Bytes aproximados do registro formatado além da mensagem
+
+    /// Função que transforma o evento em texto, definida pelo Logger
+    typedef void (*RenderFunction)(std::string& out, const LogEvent& event);
+
+    std::chrono::system_clock::time_point time;  ///< Instante em que o log foi gerado
+    LogLevel level;                              ///< Nível de severidade
+    int producer_id;                             ///< ID do produtor
+    RenderFunction render;                       ///< Formato de saída
+    uint32_t template_id;                        ///< Template do MessageCatalog (0 = mensagem literal)
+
+    LogEvent()
+        : time(), level(LogLevel::INFO), producer_id(0), render(&render_default), template_id(0),
+          external(nullptr), length(0) {}
+
+    LogEvent(LogEvent&& other)
+        : time(other.time), level(other.level), producer_id(other.producer_id), render(other.render),
+          template_id(other.template_id), external(other.external), length(other.length), overflow(std::move(other.overflow)) {
+        copy_payload(other);
+    }
+
+    LogEvent& operator=(LogEvent&& other) {
+        if (this != &other) {
+            time = other.time;
+            level = other.level;
+            producer_id = other.producer_id;
+            render = other.render;
+            template_id = other.template_id;
+            external = other.external;
+            length = other.length;
+            overflow = std::move(other.overflow);
+            copy_payload(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Referencia texto que vive até o fim do programa, sem copiar
+     * @param message Texto com duração estática
+     * @param size Tamanho em bytes
+     */
+    void set_static_message(const char* message, size_t size) {
+        template_id = 0;
+        overflow.reset();
+        external = message;
+        length = static_cast<uint32_t>(size);
+    }
+
+    /**
+     * @brief Copia a mensagem para o evento
+     * @param message Início do texto
+     * @param size Tamanho em bytes
+     */
+    void set_message(const char* message, size_t size) {
+        template_id = 0;
+        external = nullptr;
+
+        if (size <= INLINE_CAPACITY) {
+            overflow.reset();
+            std::memcpy(payload, message, size);
+            length = static_cast<uint32_t>(size);
+        } else {
+            overflow.reset(new std::string(message, size));
+            length = 0;
+        }
+    }
+
+    /**
+     * @brief Usa um template do MessageCatalog, copiando apenas os argumentos
+     * @param id Id do template
+     * @param args Argumentos empacotados (message_args::pack)
+     * @param size Tamanho do bloco de argumentos
+     */
+    void set_template(uint32_t id, const char* args, size_t size) {
+        set_message(args, size);
+        template_id = id;
+    }
+
+    /// Início do texto da mensagem (ou dos argumentos, com template_id)
+    const char* message_data() const {
+        if (external) {
+            return external;
+        }
+        return overflow ? overflow->data() : payload;
+    }
+
+    /// Tamanho do texto da mensagem (ou dos argumentos, com template_id)
+    size_t message_size() const {
+        return overflow ? overflow->size() : length;
+    }
+
+    /// Bytes da cópia no heap (0 para mensagens estáticas ou embutidas)
+    size_t heap_bytes() const {
+        return overflow ? sizeof(std::string) + overflow->capacity() : 0;
+    }
+
+private:
+    const char* external;                        ///< Mensagem estática referenciada
+    uint32_t length;                             ///< Tamanho em external ou payload
+    char payload[INLINE_CAPACITY];               ///< Cópia embutida da mensagem
+    std::unique_ptr<std::string> overflow;       ///< Cópia no heap para mensagens grandes
+
+    void copy_payload(const LogEvent& other) {
+        if (!external && !overflow) {
+            std::memcpy(payload, other.payload, length);
+        }
+    }
+
+    static void render_default(std::string& out, const LogEvent& event) {
+        PrettyJsonFormatter::format(out, event.time, event.level, event.producer_id,
+                                    event.message_data(), event.message_size());
+    }
+
+    LogEvent(const LogEvent&) = delete;
+    LogEvent& operator=(const LogEvent&) = delete;
+};
+
+/// Formata o evento no final de out (executado na thread do consumer)
+inline void append_record(std::string& out, const LogEvent& record) {
+    record.render(out, record);
+}
+
+/// Memória retida pelo evento: o próprio evento e a cópia da mensagem no heap, se houver
+inline size_t record_memory(const LogEvent& record) {
+    return sizeof(LogEvent) + record.heap_bytes();
+}
+
+/**
+ * @brief Tamanho aproximado do texto formatado, sem formatar
+ *
+ * Mensagem (expandida, se for template) mais FORMAT_OVERHEAD; ignora o
+ * escape e as diferenças entre formatadores. Usado nas métricas do Consumer.
+ */
+inline size_t record_size_estimate(const LogEvent& record) {
+    size_t message = record.message_size();
+    if (record.template_id != 0) {
+        const MessageTemplate* found = MessageCatalog::shared().find(record.template_id);
+        if (found != nullptr) {
+            message = found->expanded_size(record.message_data(), record.message_size());
+        }
+    }
+    return LogEvent::FORMAT_OVERHEAD + message;
+}
+
+/// Nível do evento, lido direto do campo binário
+inline LogLevel record_level(const LogEvent& record) {
+    return record.level;
+}
+
+/// Instante do evento, lido direto do campo binário
+inline bool record_time(const LogEvent& record, std::chrono::system_clock::time_point& time) {
+    time = record.time;
+    return true;
+}
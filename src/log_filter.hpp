@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+
+#include "log_level.hpp"
+
+/**
+ * @file log_filter.hpp
+ * @brief Filtro de severidade aplicado antes de qualquer formatação
+ *
+ * Dois limites, ambos checados por Logger antes de ler o relógio, formatar
+ * ou alocar:
+ * - SPD_MIN_LOG_LEVEL (compilação): 0 = INFO, 1 = WARNING, 2 = ERROR.
+ *   Chamadas com nível constante abaixo dele viram código morto; com as
+ *   macros SPD_LOG_* nem os argumentos são avaliados.
+ * - limite em tempo de execução: atômico e global, alterável a qualquer
+ *   momento com set_runtime_min_level() (ex: reduzir verbosidade sob carga).
+ */
+
+#ifndef SPD_MIN_LOG_LEVEL
+#define SPD_MIN_LOG_LEVEL 0
+#endif
+
+namespace log_filter {
+    /**
+     * @brief Indica se o nível sobrevive ao limite de compilação
+     */
+    inline constexpr bool compiled_in(LogLevel level) {
+        return static_cast<int>(level) >= SPD_MIN_LOG_LEVEL;
+    }
+
+    /// Limite em tempo de execução compartilhado por todos os Loggers
+    inline std::atomic<int>& runtime_threshold() {
+        static std::atomic<int> threshold(SPD_MIN_LOG_LEVEL);
+        return threshold;
+    }
+
+    /**
+     * @brief Altera o nível mínimo em tempo de execução
+     * @param level Registros abaixo deste nível são descartados na origem
+     *
+     * Não desce abaixo de SPD_MIN_LOG_LEVEL: um nível menor é gravado
+     * como o de compilação, pois o que foi removido na compilação não volta.
+     */
+    inline void set_runtime_min_level(LogLevel level) {
+        int threshold = static_cast<int>(level);
+        runtime_threshold().store(threshold > SPD_MIN_LOG_LEVEL ? threshold : SPD_MIN_LOG_LEVEL,
+                                  std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Nível mínimo efetivo (o maior entre os dois limites)
+     */
+    inline LogLevel runtime_min_level() {
+        return static_cast<LogLevel>(runtime_threshold().load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Decide se um registro deste nível deve ser gerado
+     *
+     * Custa uma leitura relaxed de um atômico; para nível constante abaixo
+     * do limite de compilação, o compilador elimina a chamada inteira.
+     */
+    inline bool enabled(LogLevel level) {
+        return compiled_in(level) &&
+               static_cast<int>(level) >= runtime_threshold().load(std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Macros de log com nível fixo
+ *
+ * Abaixo de SPD_MIN_LOG_LEVEL expandem para nada (os argumentos não são
+ * avaliados); acima, para logger.emit() após o filtro em tempo de execução.
+ * Devem ser usadas como instrução, não como expressão.
+ * @code
+ * SPD_LOG_INFO(logger, "Conexão aceita", producer_id, buffer);
+ * @endcode
+ */
+#if SPD_MIN_LOG_LEVEL <= 0
+#define SPD_LOG_INFO(logger, message, producer_id, buffer) \
+    ((logger).emit((message), LogLevel::INFO, (producer_id), (buffer)))
+#else
+#define SPD_LOG_INFO(logger, message, producer_id, buffer) ((void)0)
+#endif
+
+#if SPD_MIN_LOG_LEVEL <= 1
+#define SPD_LOG_WARNING(logger, message, producer_id, buffer) \
+    ((logger).emit((message), LogLevel::WARNING, (producer_id), (buffer)))
+#else
+#define SPD_LOG_WARNING(logger, message, producer_id, buffer) ((void)0)
+#endif
+
+#define SPD_LOG_ERROR(logger, message, producer_id, buffer) \
+    ((logger).emit((message), LogLevel::ERROR, (producer_id), (buffer)))
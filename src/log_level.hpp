@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+/**
+ * @brief Níveis de severidade para logs
+ *
+ * Define os diferentes tipos de mensagens que podem ser registradas.
+ * Ordenados por severidade crescente.
+ */
+enum class LogLevel {
+    INFO,     ///< Informações gerais do sistema
+    WARNING,  ///< Avisos que não impedem funcionamento
+    ERROR     ///< Erros que podem afetar funcionamento
+};
+
+/**
+ * @brief Extrai o nível de um registro de texto já formatado
+ * @param record Início do registro em JSON ("level": "...") ou logfmt (level=...)
+ * @param size Tamanho do registro em bytes
+ * @return Nível encontrado, ou LogLevel::INFO se o campo não existir
+ *
+ * Usado por quem recebe apenas o texto do registro (ex: FileWriter) e
+ * precisa decidir algo pela severidade.
+ */
+inline LogLevel level_from_text(const char* record, size_t size) {
+    static const char json_key[] = "\"level\"";
+    static const char logfmt_key[] = "level=";
+
+    const char* end = record + size;
+    const char* pos = std::search(record, end, json_key, json_key + sizeof(json_key) - 1);
+    if (pos != end) {
+        pos += sizeof(json_key) - 1;
+    } else {
+        pos = std::search(record, end, logfmt_key, logfmt_key + sizeof(logfmt_key) - 1);
+        if (pos == end) {
+            return LogLevel::INFO;
+        }
+        pos += sizeof(logfmt_key) - 1;
+    }
+
+    while (pos < end && (*pos == ' ' || *pos == ':' || *pos == '"')) {
+        ++pos;
+    }
+
+    size_t left = static_cast<size_t>(end - pos);
+    if (left >= 5 && std::strncmp(pos, "ERROR", 5) == 0) {
+        return LogLevel::ERROR;
+    }
+    if (left >= 7 && std::strncmp(pos, "WARNING", 7) == 0) {
+        return LogLevel::WARNING;
+    }
+
+    return LogLevel::INFO;
+}
+
+/// Sobrecarga de level_from_text() para std::string
+inline LogLevel level_from_text(const std::string& record) {
+    return level_from_text(record.data(), record.size());
+}
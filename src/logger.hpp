@@ -1,118 +1,505 @@
 #pragma once
 
-#include <cstdio>
-#include <ctime>
+#include <cstring>
+#include <cstdint>
 #include <string>
+#include <vector>
+#include <atomic>
 #include <chrono>
-#include <sstream>
 #include <memory>
-#include <iostream>
-#include <iomanip>
+#include <mutex>
+#include <utility>
 
-/**
- * @brief Níveis de severidade para logs
- *
- * Define os diferentes tipos de mensagens que podem ser registradas.
- * Ordenados por severidade crescente.
- */
-enum class LogLevel {
-    INFO,     ///< Informações gerais do sistema
-    WARNING,  ///< Avisos que não impedem funcionamento
-    ERROR     ///< Erros que podem afetar funcionamento
-};
+#include "log_level.hpp"
+#include "log_filter.hpp"
+#include "staging_policy.hpp"
+#include "metrics.hpp"
+#include "memory_budget.hpp"
+#include "formatter.hpp"
+#include "timestamp.hpp"
+#include "record.hpp"
+#include "record_slab.hpp"
+#include "log_event.hpp"
+#include "message_catalog.hpp"
 
 /**
  * @brief Sistema de logging genérico com formatação JSON
- * @tparam LogBuffer Tipo do buffer que implementa método push(string), idealizado uma fila.
+ * @tparam LogBuffer Tipo do buffer que implementa método push(registro), idealizado uma fila.
+ * @tparam Formatter Política de formatação (JsonLinesFormatter, PrettyJsonFormatter,
+ * LogfmtFormatter ou BinaryFormatter), definida em formatter.hpp
  *
  * Esta classe template permite usar diferentes tipos de buffer para
- * armazenamento dos logs (arquivo, console, memória, etc).
+ * armazenamento dos logs (arquivo, console, memória, etc). O tipo do
+ * registro enviado segue LogBuffer::value_type:
+ * - std::string: texto JSON em uma string própria
+ * - SlabRecord: texto JSON formatado direto em uma posição do RecordSlab,
+ *   sem nenhuma alocação no regime permanente
+ * - LogEvent: apenas os campos crus; o JSON é gerado pela thread do consumer
+ *
+ * Mensagens repetidas podem ser registradas no MessageCatalog e enviadas
+ * com emit_template(): o registro leva só o id e os argumentos.
+ *
+ * Registros abaixo do nível mínimo (log_filter.hpp) são descartados antes
+ * de ler o relógio, formatar ou alocar.
+ *
+ * Com uma StagingPolicy ativa, cada thread acumula os registros em uma área
+ * própria (thread_local, uma por Logger e buffer) e os publica em lote,
+ * com push_batch() quando o buffer oferece (um único lock no MessageBuffer).
+ * Se o buffer tiver um MemoryBudget, os registros acumulados entram na conta
+ * (MemoryArea::STAGING) e, com o orçamento em pressão, o lote é publicado
+ * na hora em vez de continuar crescendo. O prazo max_delay() é verificado
+ * a cada log da thread e também por flush_expired(), que alguém deve
+ * chamar periodicamente para threads que ficaram ociosas.
  */
-template<typename LogBuffer>
+template<typename LogBuffer, typename Formatter = PrettyJsonFormatter>
 class Logger {
 public:
-    explicit Logger() {}
+    typedef typename LogBuffer::value_type record_type;     ///< Registro enviado ao buffer
+
+    /**
+     * @brief Construtor
+     * @param slab Slab de onde saem as posições quando record_type é SlabRecord
+     * @param clock Relógio usado nos timestamps (COARSE troca precisão por custo)
+     */
+    explicit Logger(RecordSlab& slab = RecordSlab::shared(), ClockSource clock = ClockSource::PRECISE)
+        : slab(&slab), clock(clock), staging(StagingPolicy::disabled()), logger_id(next_logger_id()), metrics(nullptr),
+          registry(std::make_shared<AreaRegistry>()) {}
+
+    /**
+     * @brief Construtor com agrupamento de registros por thread
+     * @param staging Quando publicar os registros acumulados
+     * @param slab Slab de onde saem as posições quando record_type é SlabRecord
+     * @param clock Relógio usado nos timestamps e no prazo dos lotes
+     */
+    explicit Logger(const StagingPolicy& staging, RecordSlab& slab = RecordSlab::shared(),
+                    ClockSource clock = ClockSource::PRECISE)
+        : slab(&slab), clock(clock), staging(staging), logger_id(next_logger_id()), metrics(nullptr),
+          registry(std::make_shared<AreaRegistry>()) {}
+
+    /**
+     * @brief Passa a contar registros aceitos e recusados pelo buffer
+     * @param registry Registro de métricas (nullptr desativa)
+     */
+    void set_metrics(MetricsRegistry* registry) {
+        metrics = registry;
+    }
+
+    /**
+     * @brief Indica se registros deste nível passam pelos limites de compilação e de execução
+     *
+     * Útil para evitar montar a mensagem (concatenações, to_string) de um
+     * log que será descartado.
+     */
+    static bool enabled(LogLevel level) {
+        return log_filter::enabled(level);
+    }
 
     /**
     * @brief Registra uma mensagem de log no buffer
     * @param message Texto da mensagem a ser registrada
     * @param level Nível de severidade do log
     * @param producer_id ID numérico do produtor/módulo que gerou o log
+    * @param buffer Buffer que recebe o registro
     * @return Em caso de sucesso, retorna um std::unique_ptr contendo a string de log
-    * formatada em JSON. Em caso de falha (ex: buffer cheio), retorna `nullptr`.
+    * formatada em JSON. Em caso de falha (ex: buffer cheio) ou de nível
+    * filtrado, retorna `nullptr`. Com agrupamento, sucesso significa aceito
+    * na área local ou no lote publicado.
     *
-    * Gera um JSON formatado com timestamp automático e envia para o buffer.
+    * Gera o registro no formato do Formatter com timestamp automático e envia
+    * para o buffer. A cópia devolvida custa uma alocação; quem não precisa dela
+    * deve usar emit().
     *
-    * Formato de saída:
+    * Formato de saída com PrettyJsonFormatter:
     * @code
     * {
     *   "timestamp": "2025-08-31T16:32:01.123Z",
     *   "level": "ERROR",
     *   "producer_id": 3,
     *   "message": "Mensagem do erro"
-    * }
+    * },
     * @endcode
     */
-    std::unique_ptr<std::string> log(const std::string& message, LogLevel level, int producer_id, LogBuffer& stdout) const {
-        std::string formatted = generate_formatted_json_log(message, producer_id, level);
+    std::unique_ptr<std::string> log(const std::string& message, LogLevel level, int producer_id, LogBuffer& buffer) const {
+        if (!enabled(level)) {
+            return nullptr;
+        }
+
+        record_type record;
+        build_record(record, message.data(), message.size(), false, producer_id, level);
+
+        std::unique_ptr<std::string> formatted(new std::string());
+        append_record(*formatted, record);
 
-        if (stdout.push(formatted)) {
-            return std::unique_ptr<std::string>(new std::string(formatted));
+        if (submit(std::move(record), level, buffer)) {
+            return formatted;
         } else {
             return nullptr;
         }
     }
 
-private:
-    std::string level_to_string(LogLevel level) const {
-        switch (level) {
-            case LogLevel::INFO: return "INFO";
-            case LogLevel::WARNING: return "WARNING";
-            case LogLevel::ERROR: return "ERROR";
+    /**
+     * @brief Registra uma mensagem de log no buffer sem devolver cópia
+     * @param message Texto da mensagem a ser registrada
+     * @param level Nível de severidade do log
+     * @param producer_id ID numérico do produtor/módulo que gerou o log
+     * @param buffer Buffer que recebe o registro
+     * @return true se o registro foi aceito pelo buffer (false também para nível filtrado)
+     *
+     * Com record_type SlabRecord e um buffer pré-alocado (ex:
+     * BasicLockFreeMessageBuffer), este caminho não faz nenhum malloc.
+     */
+    bool emit(const std::string& message, LogLevel level, int producer_id, LogBuffer& buffer) const {
+        if (!enabled(level)) {
+            return false;
         }
 
-        return "UNKNOWN";
-    };
+        record_type record;
+        build_record(record, message.data(), message.size(), false, producer_id, level);
+
+        return submit(std::move(record), level, buffer);
+    }
+
+    /**
+     * @brief Registra uma mensagem com duração estática (literal ou tabela global)
+     * @param message Texto que vive até o fim do programa
+     * @param level Nível de severidade do log
+     * @param producer_id ID numérico do produtor/módulo que gerou o log
+     * @param buffer Buffer que recebe o registro
+     * @return true se o registro foi aceito pelo buffer (false também para nível filtrado)
+     *
+     * Com record_type LogEvent o texto não é copiado: o evento guarda apenas
+     * o ponteiro, e o producer paga só pela leitura do relógio e pelo push.
+     */
+    bool emit_static(const char* message, LogLevel level, int producer_id, LogBuffer& buffer) const {
+        if (!enabled(level)) {
+            return false;
+        }
+
+        record_type record;
+        build_record(record, message, std::strlen(message), true, producer_id, level);
+
+        return submit(std::move(record), level, buffer);
+    }
+
+    /**
+     * @brief Registra uma mensagem de template do MessageCatalog
+     * @param id Id devolvido por MessageCatalog::shared().intern()
+     * @param level Nível de severidade do log
+     * @param producer_id ID numérico do produtor/módulo que gerou o log
+     * @param buffer Buffer que recebe o registro
+     * @param args Valores dos marcadores "{}", na ordem (texto ou inteiros)
+     * @return true se o registro foi aceito pelo buffer (false também para
+     * nível filtrado ou id não registrado)
+     *
+     * Com record_type LogEvent o evento guarda só o id e os argumentos
+     * empacotados; o texto fixo, já escapado, entra apenas na formatação
+     * do consumer. Nos registros formatados no producer, só os argumentos
+     * passam pelo escape.
+     */
+    template<typename... Args>
+    bool emit_template(MessageId id, LogLevel level, int producer_id, LogBuffer& buffer, const Args&... args) const {
+        if (!enabled(level)) {
+            return false;
+        }
+        const MessageTemplate* message = MessageCatalog::shared().find(id);
+        if (message == nullptr) {
+            return false;
+        }
+
+        static thread_local std::string packed;
+        packed.clear();
+        message_args::pack(packed, args...);
+
+        record_type record;
+        build_template_record(record, *message, packed, producer_id, level);
+
+        return submit(std::move(record), level, buffer);
+    }
+
+    /**
+     * @brief Publica os registros que a thread atual acumulou para este buffer
+     * @param buffer Buffer que recebe o lote
+     * @return true se todos foram aceitos (ou não havia nenhum)
+     *
+     * Deve ser chamado por cada thread antes de parar de logar; sem
+     * agrupamento não faz nada.
+     */
+    bool flush(LogBuffer& buffer) const {
+        if (!staging.enabled()) {
+            return true;
+        }
+        StagingArea& area = staging_area(buffer);
+        std::lock_guard<std::mutex> lock(area.mutex);
+        return publish(area);
+    }
+
+    /**
+     * @brief Publica os lotes de todas as threads cujo registro mais antigo passou de max_delay()
+     * @return Quantidade de registros publicados
+     *
+     * O prazo do lote só é verificado no próximo log da mesma thread; uma
+     * thread que loga alguns registros e fica ociosa os deixaria parados.
+     * Esta varredura pode ser chamada por qualquer thread, periodicamente
+     * (o Producer a chama enquanto espera o próximo envio, ver
+     * next_expiry()). Áreas em uso pela própria thread são puladas: ela
+     * verifica o prazo por conta própria. Também publica o que threads já
+     * encerradas deixaram sem flush().
+     */
+    size_t flush_expired() const {
+        if (!staging.enabled()) {
+            return 0;
+        }
+
+        std::chrono::system_clock::time_point now = clock_now(clock);
+        size_t published = 0;
+        std::lock_guard<std::mutex> registry_lock(registry->mutex);
+        std::vector<std::shared_ptr<StagingArea> >& areas = registry->areas;
+        for (size_t i = 0; i < areas.size();) {
+            StagingArea& area = *areas[i];
+            std::unique_lock<std::mutex> lock(area.mutex, std::try_to_lock);
+            if (lock.owns_lock() && !area.records.empty() && now - area.oldest >= staging.max_delay()) {
+                published += area.records.size();
+                publish(area);
+            }
+
+            // Área vazia de uma thread que já terminou: só o registro a referencia
+            if (lock.owns_lock() && area.records.empty() && areas[i].use_count() == 1) {
+                lock.unlock();
+                areas.erase(areas.begin() + static_cast<std::ptrdiff_t>(i));
+                continue;
+            }
+            ++i;
+        }
+        return published;
+    }
+
+    /**
+     * @brief Instante em que o lote mais antigo, de qualquer thread, atinge max_delay()
+     * @return time_point::max() se não houver registros acumulados
+     *
+     * Áreas em uso pela própria thread no momento ficam de fora.
+     */
+    std::chrono::system_clock::time_point next_expiry() const {
+        std::chrono::system_clock::time_point earliest = std::chrono::system_clock::time_point::max();
+        if (!staging.enabled()) {
+            return earliest;
+        }
 
-    std::string escape_json_string(const std::string& str) const {
-        std::string escaped;
-
-        for (char c : str) {
-            switch (c) {
-                case '"': escaped += "\\\""; break;
-                case '\\': escaped += "\\\\"; break;
-                case '\b': escaped += "\\b"; break;
-                case '\f': escaped += "\\f"; break;
-                case '\n': escaped += "\\n"; break;
-                case '\r': escaped += "\\r"; break;
-                case '\t': escaped += "\\t"; break;
-                default: escaped += c; break;
+        std::lock_guard<std::mutex> registry_lock(registry->mutex);
+        for (size_t i = 0; i < registry->areas.size(); ++i) {
+            StagingArea& area = *registry->areas[i];
+            std::unique_lock<std::mutex> lock(area.mutex, std::try_to_lock);
+            if (lock.owns_lock() && !area.records.empty() && area.oldest + staging.max_delay() < earliest) {
+                earliest = area.oldest + staging.max_delay();
             }
         }
-        return escaped;
+        return earliest;
+    }
+
+    const StagingPolicy& get_staging_policy() const {
+        return staging;
+    }
+
+private:
+    static const size_t RECORD_OVERHEAD = 128;   ///< Bytes do registro além da mensagem
+
+    /// Registros de uma thread ainda não publicados em um buffer
+    struct StagingArea {
+        std::mutex mutex;                                 ///< Só disputado por flush_expired() e next_expiry()
+        uint64_t logger_id;                               ///< Logger dono da área
+        LogBuffer* buffer;                                ///< Buffer de destino
+        std::vector<record_type> records;                 ///< Registros acumulados, em ordem
+        std::chrono::system_clock::time_point oldest;     ///< Instante do primeiro registro
+        size_t bytes;                                     ///< Memória contada no orçamento do buffer
+    };
+
+    /// Áreas de todas as threads que já logaram por este Logger, para a varredura de prazos
+    struct AreaRegistry {
+        std::mutex mutex;                                           ///< Protege areas
+        std::vector<std::shared_ptr<StagingArea> > areas;           ///< Também referenciadas pelas threads
     };
 
-    std::string get_current_timestamp() const {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()) % 1000;
+    RecordSlab* slab;                             ///< Origem das posições de SlabRecord
+    ClockSource clock;                            ///< Fonte dos timestamps
+    StagingPolicy staging;                        ///< Agrupamento por thread
+    uint64_t logger_id;                           ///< Identifica o Logger nas áreas das threads
+    MetricsRegistry* metrics;                     ///< Contadores de envio (nullptr = desativados)
+    std::shared_ptr<AreaRegistry> registry;       ///< Áreas das threads (compartilhado entre cópias)
+
+    /// Envia o registro ao buffer, direto ou pela área local da thread
+    bool submit(record_type&& record, LogLevel level, LogBuffer& buffer) const {
+        if (!staging.enabled()) {
+            bool accepted = buffer.push(std::move(record));
+            count_published(accepted ? 1 : 0, 1);
+            return accepted;
+        }
+
+        StagingArea& area = staging_area(buffer);
+        std::lock_guard<std::mutex> lock(area.mutex);
+        std::chrono::system_clock::time_point now = clock_now(clock);
+        if (area.records.empty()) {
+            area.oldest = now;
+        }
+        area.records.push_back(std::move(record));
+
+        MemoryBudget* budget = memory_budget::of(buffer);
+        if (budget != nullptr) {
+            size_t bytes = record_memory(area.records.back());
+            area.bytes += bytes;
+            budget->add(MemoryArea::STAGING, bytes);
+        }
+
+        if (area.records.size() >= staging.batch_size() ||
+            staging.publishes_immediately(level) ||
+            now - area.oldest >= staging.max_delay() ||
+            (budget != nullptr && budget->under_pressure())) {
+            return publish(area);
+        }
+        return true;
+    }
+
+    /// Envia o lote da área ao seu buffer (chamado com o mutex da área)
+    bool publish(StagingArea& area) const {
+        if (area.records.empty()) {
+            return true;
+        }
+
+        size_t accepted = push_records(*area.buffer, area.records, 0);
+
+        // Só depois do push: os registros ainda na área contam enquanto o buffer os recusa
+        MemoryBudget* budget = memory_budget::of(*area.buffer);
+        if (budget != nullptr) {
+            budget->release(MemoryArea::STAGING, area.bytes);
+        }
+        area.bytes = 0;
+        count_published(accepted, area.records.size());
+        bool all_accepted = accepted == area.records.size();
+        area.records.clear();
+        return all_accepted;
+    }
+
+    void count_published(size_t accepted, size_t total) const {
+        if (metrics == nullptr) {
+            return;
+        }
+        metrics->add(MetricCounter::RECORDS_ENQUEUED, accepted);
+        if (accepted < total) {
+            metrics->add(MetricCounter::RECORDS_REJECTED, total - accepted);
+        }
+    }
+
+    /**
+     * @brief Obtém a área da thread atual para este Logger e buffer, criando se necessário
+     */
+    StagingArea& staging_area(LogBuffer& buffer) const {
+        // Áreas desta thread, uma por (Logger, buffer) já usados
+        static thread_local std::vector<std::shared_ptr<StagingArea> > areas;
+
+        for (size_t i = 0; i < areas.size(); ++i) {
+            if (areas[i]->logger_id == logger_id && areas[i]->buffer == &buffer) {
+                return *areas[i];
+            }
+        }
+
+        std::shared_ptr<StagingArea> area = std::make_shared<StagingArea>();
+        area->logger_id = logger_id;
+        area->buffer = &buffer;
+        area->records.reserve(staging.batch_size());
+        area->bytes = 0;
+        {
+            std::lock_guard<std::mutex> lock(registry->mutex);
+            registry->areas.push_back(area);
+        }
+        areas.push_back(area);
+        return *areas.back();
+    }
+
+    /// Buffers com push_batch() recebem o lote em uma única operação
+    template<typename Buffer>
+    static auto push_records(Buffer& buffer, std::vector<record_type>& records, int)
+        -> decltype(buffer.push_batch(records)) {
+        return buffer.push_batch(records);
+    }
+
+    template<typename Buffer>
+    static size_t push_records(Buffer& buffer, std::vector<record_type>& records, long) {
+        size_t accepted = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (buffer.push(std::move(records[i]))) {
+                ++accepted;
+            }
+        }
+        return accepted;
+    }
+
+    /// Ids únicos evitam confundir um Logger novo alocado no endereço de outro já destruído
+    static uint64_t next_logger_id() {
+        static std::atomic<uint64_t> counter(0);
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    void build_record(std::string& record, const char* message, size_t message_size, bool,
+                      int producer_id, LogLevel level) const {
+        record.clear();
+        record.reserve(RECORD_OVERHEAD + message_size);
+        Formatter::format(record, clock_now(clock), level,
+                          producer_id, message, message_size);
+    }
+
+    void build_record(SlabRecord& record, const char* message, size_t message_size, bool,
+                      int producer_id, LogLevel level) const {
+        record = slab->acquire(level);
+        Formatter::format(record, clock_now(clock), level,
+                          producer_id, message, message_size);
+    }
+
+    void build_template_record(std::string& record, const MessageTemplate& message, const std::string& args,
+                               int producer_id, LogLevel level) const {
+        record.clear();
+        record.reserve(RECORD_OVERHEAD + message.expanded_size(args.data(), args.size()));
+        Formatter::format_message(record, clock_now(clock), level, producer_id,
+                                  TemplateMessage(message, args.data(), args.size()));
+    }
 
-        std::stringstream ss;
-        ss << std::put_time(std::gmtime(&time_t), "%Y-%m-%dT%H:%M:%S");
-        ss << "." << std::setfill('0') << std::setw(3) << ms.count() << "Z";
-        return ss.str();
+    void build_template_record(SlabRecord& record, const MessageTemplate& message, const std::string& args,
+                               int producer_id, LogLevel level) const {
+        record = slab->acquire(level);
+        Formatter::format_message(record, clock_now(clock), level, producer_id,
+                                  TemplateMessage(message, args.data(), args.size()));
     }
 
-    std::string generate_formatted_json_log(const std::string& message, int producer_id, LogLevel level) const {
-        std::stringstream json;
-        json << "{\n";
-        json << "  \"timestamp\": \"" << escape_json_string(get_current_timestamp()) << "\",\n";
-        json << "  \"level\": \"" << escape_json_string(level_to_string(level)) << "\",\n";
-        json << "  \"producer_id\": " << producer_id << ",\n";
-        json << "  \"message\": \"" << escape_json_string(message) << "\"\n";
-        json << "},";
+    void build_template_record(LogEvent& record, const MessageTemplate& message, const std::string& args,
+                               int producer_id, LogLevel level) const {
+        record.time = clock_now(clock);
+        record.level = level;
+        record.producer_id = producer_id;
+        record.render = &render_event;
+        record.set_template(message.id(), args.data(), args.size());
+    }
+
+    /// Formata um LogEvent na thread do consumer com o mesmo Formatter deste Logger
+    static void render_event(std::string& out, const LogEvent& event) {
+        const MessageTemplate* message = event.template_id != 0 ? MessageCatalog::shared().find(event.template_id) : nullptr;
+        if (message != nullptr) {
+            Formatter::format_message(out, event.time, event.level, event.producer_id,
+                                      TemplateMessage(*message, event.message_data(), event.message_size()));
+            return;
+        }
+        Formatter::format(out, event.time, event.level, event.producer_id,
+                          event.message_data(), event.message_size());
+    }
 
-        return json.str();
+    void build_record(LogEvent& record, const char* message, size_t message_size, bool is_static,
+                      int producer_id, LogLevel level) const {
+        record.time = clock_now(clock);
+        record.level = level;
+        record.producer_id = producer_id;
+        record.render = &render_event;
+
+        if (is_static) {
+            record.set_static_message(message, message_size);
+        } else {
+            record.set_message(message, message_size);
+        }
     }
 };
@@ -0,0 +1,466 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <stdexcept>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(MAP_POPULATE)
+#define SPD_MAP_POPULATE MAP_POPULATE
+#else
+#define SPD_MAP_POPULATE 0
+#endif
+
+#include "log_level.hpp"
+#include "record.hpp"
+#include "flush_policy.hpp"
+
+/**
+ * @brief Escritor append-only sobre um arquivo mapeado em memória
+ *
+ * Mesma interface do FileWriter, mas sem lock no caminho de escrita: cada
+ * append reserva seu trecho com um fetch_add no offset de escrita e copia
+ * os bytes direto para o mapeamento. Um lote de append_batch() ocupa um
+ * único trecho contíguo, então registros de writers diferentes nunca se
+ * intercalam.
+ *
+ * O arquivo cresce em chunks pré-alocados (posix_fallocate) e mapeados
+ * dentro de uma única faixa de endereços reservada na construção, de modo
+ * que o arquivo inteiro é contíguo na memória. Uma thread de fundo mapeia
+ * o próximo chunk antes que ele seja necessário; se um writer alcançar o
+ * fim do mapeamento mesmo assim, ele mesmo mapeia (caminho lento, sob lock).
+ *
+ * Os dados ficam visíveis a outros processos assim que copiados. A política
+ * de flush e flush() controlam quando a gravação em disco é agendada
+ * (msync com MS_ASYNC); sync() grava de forma síncrona (MS_SYNC). O padrão
+ * agenda a cada 100 ms, pela thread de fundo: com FlushPolicy::every_record()
+ * cada append vira uma chamada a msync, e o caminho sem lock passa a ter
+ * uma syscall por registro.
+ *
+ * Em close() o arquivo é truncado para o fim do último trecho realmente
+ * copiado; um trecho reservado cuja escrita falhou (arquivo no tamanho
+ * máximo ou sem espaço para pré-alocar) não entra no tamanho final. Se o
+ * processo terminar sem close(), o final pré-alocado fica com bytes zero,
+ * que são ignorados quando o arquivo é reaberto.
+ *
+ * close() (e o destrutor) só pode ser chamado depois que nenhuma thread
+ * estiver mais escrevendo, como na ordem de encerramento do main.cpp.
+ *
+ * Disponível apenas em sistemas POSIX de 64 bits.
+ */
+class MappedFileWriter {
+public:
+    static const size_t DEFAULT_CHUNK_SIZE = 16 * 1024 * 1024;          ///< Crescimento do arquivo
+    static const uint64_t DEFAULT_MAX_SIZE = 64ULL * 1024 * 1024 * 1024; ///< Faixa de endereços reservada
+
+    /**
+     * @brief Abre (ou cria) o arquivo e mapeia seu final
+     * @param filename Nome do arquivo de log (registros são acrescentados ao final)
+     * @param policy Quando agendar a gravação em disco (padrão: a cada 100 ms)
+     * @param chunk_size Bytes pré-alocados e mapeados por vez (múltiplo do tamanho de página)
+     * @param max_size Tamanho máximo do arquivo
+     * @throws std::invalid_argument se chunk_size não for múltiplo do tamanho de página
+     * @throws std::runtime_error se não conseguir abrir, reservar ou mapear o arquivo
+     */
+    explicit MappedFileWriter(const std::string& filename,
+                              const FlushPolicy& policy = FlushPolicy::every_interval(std::chrono::milliseconds(100)),
+                              size_t chunk_size = DEFAULT_CHUNK_SIZE,
+                              uint64_t max_size = DEFAULT_MAX_SIZE)
+        : filename(filename),
+          flush_policy(policy),
+          chunk_size(chunk_size),
+          max_size(max_size),
+          fd(-1),
+          base(nullptr),
+          write_offset(0),
+          written_end(0),
+          mapped_end(0),
+          synced_end(0),
+          map_requested(false),
+          stop_mapper(false),
+          accepting(false) {
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        if (chunk_size == 0 || chunk_size % page != 0) {
+            throw std::invalid_argument("Tamanho do chunk deve ser múltiplo do tamanho de página");
+        }
+
+        fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Não foi possível abrir o arquivo de log: " + filename);
+        }
+
+        void* region = ::mmap(nullptr, static_cast<size_t>(max_size), PROT_NONE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (region == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Não foi possível reservar endereços para o arquivo de log: " + filename);
+        }
+        base = static_cast<char*>(region);
+
+        try {
+            uint64_t end = find_logical_end();
+            write_offset.store(end);
+            written_end.store(end);
+            synced_end.store(end);
+            ensure_mapped(end + chunk_size, false);
+        } catch (...) {
+            ::munmap(base, static_cast<size_t>(max_size));
+            ::close(fd);
+            throw;
+        }
+
+        accepting.store(true);
+        mapper_thread = std::thread(&MappedFileWriter::mapper_routine, this);
+
+        std::cout << "MappedFileWriter criado para arquivo: " << filename << std::endl;
+    }
+
+    ~MappedFileWriter() {
+        try {
+            close();
+        } catch (const std::exception&) {
+            // Destrutor não propaga falhas
+        }
+    }
+
+    /**
+     * @brief Adiciona registro formatado ao arquivo de log
+     * @param record Registro completo, já com seu terminador
+     * @throws std::runtime_error se o arquivo foi fechado ou não puder crescer
+     */
+    void append(const std::string& record) {
+        LogLevel level = flush_policy.uses_severity() ? level_from_text(record) : LogLevel::INFO;
+        append(record, level);
+    }
+
+    /**
+     * @brief Adiciona registro formatado cujo nível já é conhecido
+     * @param record Registro completo, já com seu terminador
+     * @param level Nível do registro, usado pela política de flush por severidade
+     */
+    void append(const std::string& record, LogLevel level) {
+        write(record.data(), record.size(), level);
+    }
+
+    /**
+     * @brief Adiciona um lote de registros ao arquivo de log
+     * @tparam Record Tipo do registro, acessado via append_record() e record_level()
+     * @param records Registros a serem escritos, na ordem do vetor
+     *
+     * O lote é formatado em um bloco da thread e copiado para um único
+     * trecho reservado do arquivo.
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        static thread_local std::string block;
+        block.clear();
+
+        LogLevel max_level = LogLevel::INFO;
+        for (size_t i = 0; i < records.size(); ++i) {
+            append_record(block, records[i]);
+
+            if (flush_policy.uses_severity()) {
+                LogLevel level = record_level(records[i]);
+                if (level > max_level) {
+                    max_level = level;
+                }
+            }
+        }
+
+        write(block.data(), block.size(), max_level);
+    }
+
+    /**
+     * @brief Verifica se o arquivo está aberto e operacional
+     */
+    bool is_open() const {
+        return accepting.load();
+    }
+
+    /**
+     * @brief Obtém o nome do arquivo associado a esta instância
+     */
+    const std::string& get_filename() const {
+        return filename;
+    }
+
+    /**
+     * @brief Obtém a política de flush configurada
+     */
+    const FlushPolicy& get_flush_policy() const {
+        return flush_policy;
+    }
+
+    /**
+     * @brief Bytes escritos no arquivo (sem contar a pré-alocação)
+     */
+    uint64_t size() const {
+        return written_end.load();
+    }
+
+    /**
+     * @brief Agenda a gravação em disco de tudo o que já foi escrito
+     *
+     * Como no FileWriter, não espera o disco; para isso use sync().
+     */
+    void flush() {
+        if (!accepting.load()) {
+            return;
+        }
+
+        uint64_t end = written_end.load();
+        sync_range(synced_end.load(), end, MS_ASYNC);
+        advance_synced(end);
+    }
+
+    /**
+     * @brief Grava em disco, de forma síncrona, tudo o que já foi escrito
+     */
+    void sync() {
+        if (!accepting.load()) {
+            return;
+        }
+
+        uint64_t end = written_end.load();
+        sync_range(0, end, MS_SYNC);
+        advance_synced(end);
+    }
+
+    /**
+     * @brief Desfaz o mapeamento e trunca o arquivo para o tamanho escrito
+     *
+     * Após a chamada, tentativas de escrita irão falhar com exceção.
+     */
+    void close() {
+        if (!accepting.exchange(false)) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mapper_mutex);
+            stop_mapper = true;
+        }
+        mapper_cv.notify_all();
+        if (mapper_thread.joinable()) {
+            mapper_thread.join();
+        }
+
+        // Não write_offset: reservas cujo mapeamento falhou deixariam um buraco de zeros no final
+        uint64_t end = written_end.load();
+        ::munmap(base, static_cast<size_t>(max_size));
+        base = nullptr;
+
+        int status = ::ftruncate(fd, static_cast<off_t>(end));
+        ::close(fd);
+        fd = -1;
+
+        std::cout << "Arquivo de log fechado: " << filename << std::endl;
+        if (status != 0) {
+            throw std::runtime_error("Não foi possível truncar o arquivo de log: " + filename);
+        }
+    }
+
+private:
+    std::string filename;                   ///< Nome do arquivo associado
+    const FlushPolicy flush_policy;         ///< Quando agendar a gravação em disco
+    const size_t chunk_size;                ///< Bytes pré-alocados por vez
+    const uint64_t max_size;                ///< Tamanho da faixa reservada
+
+    int fd;                                 ///< Descritor do arquivo
+    char* base;                             ///< Início da faixa reservada (offset 0 do arquivo)
+
+    alignas(64) std::atomic<uint64_t> write_offset;   ///< Próximo byte livre (disputado pelos writers)
+    std::atomic<uint64_t> written_end;                ///< Fim do trecho copiado mais adiante no arquivo
+    alignas(64) std::atomic<uint64_t> mapped_end;     ///< Fim do trecho mapeado
+    std::atomic<uint64_t> synced_end;                 ///< Fim do trecho com msync agendado
+    std::atomic<bool> map_requested;                  ///< Writer pediu um novo chunk
+
+    std::mutex grow_mutex;                  ///< Serializa pré-alocação e mapeamento
+    std::thread mapper_thread;              ///< Mapeia chunks à frente e aplica o intervalo
+    std::mutex mapper_mutex;                ///< Protege stop_mapper
+    std::condition_variable mapper_cv;      ///< Acorda a thread de mapeamento
+    bool stop_mapper;                       ///< Sinaliza fim da thread de mapeamento
+
+    std::atomic<bool> accepting;            ///< Aceita novas escritas
+
+    static const int MAPPER_IDLE_MILLIS = 100;   ///< Espera máxima da thread de mapeamento sem intervalo
+
+    /**
+     * @brief Reserva um trecho e copia os dados, sem lock no caso comum
+     */
+    void write(const char* data, size_t size, LogLevel level) {
+        if (!accepting.load(std::memory_order_relaxed)) {
+            throw std::runtime_error("Arquivo de log foi fechado inesperadamente");
+        }
+        if (size == 0) {
+            return;
+        }
+
+        uint64_t begin = write_offset.fetch_add(size, std::memory_order_relaxed);
+        uint64_t end = begin + size;
+
+        if (end > mapped_end.load(std::memory_order_acquire)) {
+            ensure_mapped(end, false);
+        }
+        std::memcpy(base + begin, data, size);
+        advance(written_end, end);
+
+        // Pede o próximo chunk quando passar da metade do último mapeado
+        if (end + chunk_size / 2 > mapped_end.load(std::memory_order_relaxed) && !map_requested.exchange(true)) {
+            mapper_cv.notify_one();
+        }
+
+        uint64_t synced = synced_end.load(std::memory_order_relaxed);
+        if (end > synced && flush_policy.should_flush(static_cast<size_t>(end - synced), level)) {
+            // Desde o último sincronizado, não só este registro: a janela inteira conta para a política
+            sync_range(synced, end, MS_ASYNC);
+            advance_synced(end);
+        }
+    }
+
+    /**
+     * @brief Pré-aloca e mapeia o arquivo até pelo menos end
+     * @param end Offset que precisa estar mapeado
+     * @param populate Carrega as páginas já no mapeamento (só na thread de fundo,
+     * para tirar as faltas de página do caminho de escrita)
+     * @throws std::runtime_error se o arquivo não puder crescer
+     */
+    void ensure_mapped(uint64_t end, bool populate) {
+        std::lock_guard<std::mutex> lock(grow_mutex);
+
+        uint64_t mapped = mapped_end.load(std::memory_order_relaxed);
+        if (end <= mapped) {
+            return;
+        }
+
+        uint64_t target = (end + chunk_size - 1) / chunk_size * chunk_size;
+        if (target > max_size) {
+            throw std::runtime_error("Arquivo de log atingiu o tamanho máximo: " + filename);
+        }
+
+        size_t length = static_cast<size_t>(target - mapped);
+        int status = ::posix_fallocate(fd, static_cast<off_t>(mapped), static_cast<off_t>(length));
+        if (status != 0) {
+            throw std::runtime_error("Não foi possível pré-alocar o arquivo de log " + filename + ": " + std::strerror(status));
+        }
+
+        void* chunk = ::mmap(base + mapped, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED | (populate ? SPD_MAP_POPULATE : 0),
+                             fd, static_cast<off_t>(mapped));
+        if (chunk == MAP_FAILED) {
+            throw std::runtime_error("Não foi possível mapear o arquivo de log " + filename + ": " + std::strerror(errno));
+        }
+
+        mapped_end.store(target, std::memory_order_release);
+    }
+
+    /**
+     * @brief Encontra o fim dos dados reais, ignorando zeros de uma pré-alocação anterior
+     */
+    uint64_t find_logical_end() {
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            throw std::runtime_error("Não foi possível obter o tamanho do arquivo de log: " + filename);
+        }
+
+        uint64_t end = static_cast<uint64_t>(info.st_size);
+        char buffer[4096];
+        while (end > 0) {
+            size_t length = static_cast<size_t>(std::min<uint64_t>(end, sizeof(buffer)));
+            if (::pread(fd, buffer, length, static_cast<off_t>(end - length)) != static_cast<ssize_t>(length)) {
+                throw std::runtime_error("Não foi possível ler o final do arquivo de log: " + filename);
+            }
+
+            size_t i = length;
+            while (i > 0 && buffer[i - 1] == '\0') {
+                --i;
+            }
+            end -= length - i;
+            if (i > 0) {
+                break;
+            }
+        }
+        return end;
+    }
+
+    void sync_range(uint64_t begin, uint64_t end, int flags) {
+        if (end <= begin) {
+            return;
+        }
+
+        // msync exige endereço inicial alinhado à página
+        uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+        uint64_t aligned = begin / page * page;
+        ::msync(base + aligned, static_cast<size_t>(end - aligned), flags);
+    }
+
+    void advance_synced(uint64_t end) {
+        advance(synced_end, end);
+    }
+
+    /// Leva offset até end, se ainda estiver antes
+    static void advance(std::atomic<uint64_t>& offset, uint64_t end) {
+        uint64_t current = offset.load(std::memory_order_relaxed);
+        while (current < end && !offset.compare_exchange_weak(current, end, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Rotina da thread de fundo
+     *
+     * Mantém dois chunks mapeados à frente do offset de escrita e, se a
+     * política tiver intervalo, agenda o msync do que estiver pendente.
+     */
+    void mapper_routine() {
+        std::unique_lock<std::mutex> lock(mapper_mutex);
+        std::chrono::milliseconds interval = flush_policy.interval();
+
+        while (!stop_mapper) {
+            // O pedido é sinalizado sem mapper_mutex, então a espera também expira sozinha
+            mapper_cv.wait_for(lock, interval.count() > 0 ? interval : std::chrono::milliseconds(static_cast<int>(MAPPER_IDLE_MILLIS)),
+                               [this]() { return stop_mapper || map_requested.load(); });
+            if (stop_mapper) {
+                break;
+            }
+
+            map_requested.store(false);
+            lock.unlock();
+
+            try {
+                ensure_mapped(write_offset.load() + 2 * chunk_size, true);
+            } catch (const std::exception& e) {
+                // O writer que precisar do espaço recebe a mesma falha
+                std::cout << "Erro ao mapear chunk de " << filename << " -> " << e.what() << std::endl;
+            }
+
+            uint64_t end = written_end.load();
+            if (interval.count() > 0 && end > synced_end.load()) {
+                sync_range(synced_end.load(), end, MS_ASYNC);
+                advance_synced(end);
+            }
+
+            lock.lock();
+        }
+    }
+
+    // Desabilita cópia para evitar problemas com o mapeamento
+    MappedFileWriter(const MappedFileWriter&) = delete;
+    MappedFileWriter& operator=(const MappedFileWriter&) = delete;
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+/// Partes do pipeline cuja memória é contada pelo MemoryBudget
+enum class MemoryArea {
+    BUFFER,     ///< Registros na fila do MessageBuffer
+    STAGING,    ///< Registros acumulados nas áreas locais do Logger
+    BATCHES,    ///< Lotes retirados pelos consumers e ainda não gravados
+    WRITER      ///< Buffers internos do escritor (filas, spool, buffers de commit)
+};
+
+/**
+ * @brief Orçamento de memória, em bytes, de um pipeline de log
+ *
+ * Buffer, Logger e consumers somam aqui os bytes que seguram e devolvem
+ * quando os liberam; o escritor informa o tamanho dos seus buffers depois
+ * de cada lote. Ao passar da marca alta o orçamento entra em pressão, e o
+ * MessageBuffer passa a tratar push() como se estivesse cheio, aplicando a
+ * OverflowPolicy (esperar, descartar, transbordar para o disco...), assim
+ * como para um registro que passaria do limite (admits()); a
+ * pressão só acaba quando o uso cai até a marca baixa, para o pipeline não
+ * alternar a cada registro.
+ *
+ * Os valores são aproximados: cada registro conta o próprio objeto e a
+ * memória que ele possui no heap (record_memory()), sem o overhead do
+ * alocador. Uma instância atende um pipeline (um buffer e um escritor).
+ *
+ * Exemplo: no máximo 64 MiB, com pressão acima de 90% até voltar a 75%:
+ * @code
+ * MemoryBudget memory(64 * 1024 * 1024);
+ * MessageBuffer buffer(1 << 20, OverflowPolicy::block(), &memory);
+ * @endcode
+ */
+class MemoryBudget {
+public:
+    static const size_t AREA_COUNT = 4;     ///< Valores de MemoryArea
+
+    /**
+     * @brief Construtor
+     * @param limit_bytes Memória total permitida ao pipeline
+     * @param high_ratio Fração do limite que inicia a pressão
+     * @param low_ratio Fração do limite em que a pressão termina
+     * @throws std::invalid_argument se limit_bytes for 0 ou se não valer
+     * 0 < low_ratio < high_ratio <= 1
+     */
+    explicit MemoryBudget(size_t limit_bytes, double high_ratio = 0.9, double low_ratio = 0.75)
+        : limit_bytes(limit_bytes),
+          high_bytes(static_cast<size_t>(static_cast<double>(limit_bytes) * high_ratio)),
+          low_bytes(static_cast<size_t>(static_cast<double>(limit_bytes) * low_ratio)),
+          total(0),
+          peak_bytes(0),
+          pressure(false),
+          pressure_count(0) {
+        if (limit_bytes == 0) {
+            throw std::invalid_argument("Orçamento de memória deve ser maior que zero");
+        }
+        if (!(low_ratio > 0.0 && low_ratio < high_ratio && high_ratio <= 1.0)) {
+            throw std::invalid_argument("Marcas do orçamento devem valer 0 < baixa < alta <= 1");
+        }
+        for (size_t i = 0; i < AREA_COUNT; ++i) {
+            areas[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// Soma bytes que passam a ser retidos pela área
+    void add(MemoryArea area, size_t bytes) {
+        if (bytes == 0) {
+            return;
+        }
+        areas[index(area)].fetch_add(bytes, std::memory_order_relaxed);
+        update(total.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    }
+
+    /// Devolve bytes antes somados com add() na mesma área
+    void release(MemoryArea area, size_t bytes) {
+        if (bytes == 0) {
+            return;
+        }
+        areas[index(area)].fetch_sub(bytes, std::memory_order_relaxed);
+        update(total.fetch_sub(bytes, std::memory_order_relaxed) - bytes);
+    }
+
+    /**
+     * @brief Substitui o valor de uma área medida de fora (ex: buffers do escritor)
+     * @param bytes Bytes que a área retém agora
+     */
+    void set(MemoryArea area, size_t bytes) {
+        size_t previous = areas[index(area)].exchange(bytes, std::memory_order_relaxed);
+        if (bytes >= previous) {
+            update(total.fetch_add(bytes - previous, std::memory_order_relaxed) + (bytes - previous));
+        } else {
+            update(total.fetch_sub(previous - bytes, std::memory_order_relaxed) - (previous - bytes));
+        }
+    }
+
+    /// Bytes retidos pelo pipeline inteiro
+    size_t used() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    /// Bytes retidos por uma área
+    size_t used(MemoryArea area) const {
+        return areas[index(area)].load(std::memory_order_relaxed);
+    }
+
+    /// Maior valor de used() desde a criação
+    size_t peak() const {
+        return peak_bytes.load(std::memory_order_relaxed);
+    }
+
+    size_t limit() const { return limit_bytes; }
+    size_t high_watermark() const { return high_bytes; }
+    size_t low_watermark() const { return low_bytes; }
+
+    /**
+     * @brief Indica se o uso passou da marca alta e ainda não voltou à baixa
+     *
+     * Reavalia a marca baixa a cada chamada, então a pressão termina mesmo
+     * que a última liberação tenha corrido com um add() concorrente.
+     */
+    bool under_pressure() const {
+        if (!pressure.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (used() <= low_bytes) {
+            pressure.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Indica se mais bytes cabem: fora da pressão e sem passar do limite
+     * @param bytes Memória que seria somada (ex: record_memory() de um registro)
+     */
+    bool admits(size_t bytes) const {
+        return !under_pressure() && used() + bytes <= limit_bytes;
+    }
+
+    /// Vezes que o uso passou da marca alta
+    uint64_t pressure_events() const {
+        return pressure_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    const size_t limit_bytes;                   ///< Limite total
+    const size_t high_bytes;                    ///< Marca que inicia a pressão
+    const size_t low_bytes;                     ///< Marca que termina a pressão
+    std::atomic<size_t> areas[AREA_COUNT];      ///< Bytes por área
+    std::atomic<size_t> total;                  ///< Soma das áreas
+    std::atomic<size_t> peak_bytes;             ///< Maior total observado
+    mutable std::atomic<bool> pressure;         ///< Entre a marca alta e a volta à baixa
+    std::atomic<uint64_t> pressure_count;       ///< Entradas em pressão
+
+    static size_t index(MemoryArea area) {
+        return static_cast<size_t>(area);
+    }
+
+    /// Atualiza o pico e a pressão com o total que a operação produziu
+    void update(size_t now) {
+        size_t highest = peak_bytes.load(std::memory_order_relaxed);
+        while (now > highest && !peak_bytes.compare_exchange_weak(highest, now, std::memory_order_relaxed)) {
+        }
+
+        if (now >= high_bytes) {
+            if (!pressure.exchange(true, std::memory_order_relaxed)) {
+                pressure_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else if (now <= low_bytes) {
+            pressure.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // Desabilita cópia, buffer e consumers guardam o endereço
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+};
+
+/**
+ * @brief Ligação do orçamento com buffers e escritores que não o conhecem
+ *
+ * Logger e Consumer encontram o orçamento pelo buffer (memory_budget())
+ * e o escritor informa seus bytes com buffered_bytes(); tipos sem esses
+ * métodos simplesmente não entram na conta.
+ */
+namespace memory_budget {
+    namespace detail {
+        template<typename Buffer>
+        auto of(const Buffer& buffer, int) -> decltype(buffer.memory_budget()) {
+            return buffer.memory_budget();
+        }
+
+        template<typename Buffer>
+        MemoryBudget* of(const Buffer&, long) {
+            return nullptr;
+        }
+
+        template<typename Writer>
+        auto writer_bytes(const Writer& writer, int) -> decltype(static_cast<size_t>(writer.buffered_bytes())) {
+            return writer.buffered_bytes();
+        }
+
+        template<typename Writer>
+        size_t writer_bytes(const Writer&, long) {
+            return 0;
+        }
+    }
+
+    /// Orçamento configurado no buffer (nullptr se não houver ou se o buffer não suportar)
+    template<typename Buffer>
+    MemoryBudget* of(const Buffer& buffer) {
+        return detail::of(buffer, 0);
+    }
+
+    /// Bytes retidos pelos buffers internos do escritor (0 se ele não informar)
+    template<typename Writer>
+    size_t writer_bytes(const Writer& writer) {
+        return detail::writer_bytes(writer, 0);
+    }
+}
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <type_traits>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "formatter.hpp"
+#include "json_escape.hpp"
+
+/// Id estável de um template registrado no MessageCatalog (0 = sem template)
+typedef uint32_t MessageId;
+
+/**
+ * @brief Argumentos de uma mensagem de template, empacotados em um bloco de bytes
+ *
+ * Cada argumento é gravado como tamanho (uint16, little-endian) seguido do
+ * texto; argumentos maiores que MAX_SIZE são truncados. O bloco é o que
+ * viaja no LogEvent e no arquivo binário no lugar da mensagem completa.
+ */
+namespace message_args {
+    static const size_t MAX_SIZE = 0xFFFF;     ///< Maior argumento representável
+
+    template<typename Out>
+    void append(Out& out, const char* text, size_t size) {
+        if (size > MAX_SIZE) {
+            size = MAX_SIZE;
+        }
+        out.push_back(static_cast<char>(size & 0xFF));
+        out.push_back(static_cast<char>(size >> 8));
+        out.append(text, size);
+    }
+
+    template<typename Out>
+    void append_value(Out& out, const std::string& value) {
+        append(out, value.data(), value.size());
+    }
+
+    template<typename Out>
+    void append_value(Out& out, const char* value) {
+        append(out, value, std::strlen(value));
+    }
+
+    /// Inteiros são convertidos para decimal no producer, sem alocar
+    template<typename Out, typename T>
+    typename std::enable_if<std::is_integral<T>::value>::type append_value(Out& out, T value) {
+        char digits[24];
+        char* end = digits + sizeof(digits);
+        char* begin = end;
+        bool negative = value < 0;
+        unsigned long long magnitude = negative ? 0ull - static_cast<unsigned long long>(value)
+                                                : static_cast<unsigned long long>(value);
+        do {
+            *--begin = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (negative) {
+            *--begin = '-';
+        }
+        append(out, begin, static_cast<size_t>(end - begin));
+    }
+
+    template<typename Out>
+    void pack(Out&) {}
+
+    /// Empacota os argumentos em out, na ordem
+    template<typename Out, typename First, typename... Rest>
+    void pack(Out& out, const First& first, const Rest&... rest) {
+        append_value(out, first);
+        pack(out, rest...);
+    }
+
+    /**
+     * @brief Lê o próximo argumento e avança position
+     * @return false quando o bloco acaba (ou está incompleto)
+     */
+    inline bool next(const char*& position, const char* end, const char*& text, size_t& size) {
+        if (end - position < 2) {
+            return false;
+        }
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(position);
+        size_t length = static_cast<size_t>(bytes[0] | (bytes[1] << 8));
+        if (static_cast<size_t>(end - position - 2) < length) {
+            return false;
+        }
+        text = position + 2;
+        size = length;
+        position += 2 + length;
+        return true;
+    }
+}
+
+/**
+ * @brief Template de mensagem registrado, com os trechos fixos já escapados
+ *
+ * O texto é dividido nos marcadores "{}"; cada trecho é guardado como está
+ * e escapado para JSON/logfmt uma única vez, no registro. Argumentos a
+ * mais são ignorados e argumentos a menos deixam o marcador vazio.
+ */
+class MessageTemplate {
+public:
+    MessageTemplate(MessageId id, const std::string& text)
+        : template_id(id), source(text), fixed_size(0) {
+        size_t begin = 0;
+        for (;;) {
+            size_t marker = text.find("{}", begin);
+            std::string part = text.substr(begin, marker == std::string::npos ? std::string::npos : marker - begin);
+            std::string escaped;
+            json_escape::escape(escaped, part.data(), part.size());
+            fixed_size += part.size();
+            parts.push_back(part);
+            escaped_parts.push_back(escaped);
+            if (marker == std::string::npos) {
+                break;
+            }
+            begin = marker + 2;
+        }
+    }
+
+    MessageId id() const {
+        return template_id;
+    }
+
+    /// Texto registrado, com os marcadores
+    const std::string& text() const {
+        return source;
+    }
+
+    /// Quantidade de marcadores "{}"
+    size_t placeholders() const {
+        return parts.size() - 1;
+    }
+
+    /// Tamanho da mensagem expandida com os argumentos de args (sem escape)
+    size_t expanded_size(const char* args, size_t args_size) const {
+        size_t total = fixed_size;
+        const char* position = args;
+        const char* end = args + args_size;
+        const char* text;
+        size_t size;
+        for (size_t i = 0; i < placeholders() && message_args::next(position, end, text, size); ++i) {
+            total += size;
+        }
+        return total;
+    }
+
+    /// Mensagem expandida, sem escape (formato binário, spd_replay)
+    template<typename Out>
+    void expand(Out& out, const char* args, size_t args_size) const {
+        write(out, parts, args, args_size, false);
+    }
+
+    /// Mensagem expandida e escapada: trechos fixos prontos, só os argumentos passam pelo escape
+    template<typename Out>
+    void expand_escaped(Out& out, const char* args, size_t args_size) const {
+        write(out, escaped_parts, args, args_size, true);
+    }
+
+private:
+    MessageId template_id;                  ///< Id no catálogo
+    std::string source;                     ///< Texto registrado
+    std::vector<std::string> parts;         ///< Trechos entre marcadores
+    std::vector<std::string> escaped_parts; ///< Os mesmos trechos escapados para JSON
+    size_t fixed_size;                      ///< Soma dos trechos sem escape
+
+    template<typename Out>
+    void write(Out& out, const std::vector<std::string>& pieces, const char* args, size_t args_size, bool escape) const {
+        const char* position = args;
+        const char* end = args + args_size;
+        out.append(pieces[0].data(), pieces[0].size());
+        for (size_t i = 1; i < pieces.size(); ++i) {
+            const char* text;
+            size_t size;
+            if (message_args::next(position, end, text, size)) {
+                if (escape) {
+                    json_escape::escape(out, text, size);
+                } else {
+                    out.append(text, size);
+                }
+            }
+            out.append(pieces[i].data(), pieces[i].size());
+        }
+    }
+};
+
+/**
+ * @brief Mensagem de template para Formatter::format_message()
+ *
+ * Mesmo modelo de format_detail::PlainMessage, com o texto fixo vindo
+ * pronto do MessageTemplate.
+ */
+struct TemplateMessage {
+    const MessageTemplate* message;     ///< Template registrado
+    const char* args;                   ///< Argumentos empacotados (message_args)
+    size_t args_size;                   ///< Tamanho do bloco de argumentos
+
+    TemplateMessage(const MessageTemplate& message, const char* args, size_t args_size)
+        : message(&message), args(args), args_size(args_size) {}
+
+    size_t size() const {
+        return message->expanded_size(args, args_size);
+    }
+
+    template<typename Out>
+    void append_escaped(Out& out) const {
+        message->expand_escaped(out, args, args_size);
+    }
+
+    template<typename Out>
+    void append_raw(Out& out) const {
+        message->expand(out, args, args_size);
+    }
+};
+
+/**
+ * @brief Dicionário de templates de mensagem com ids estáveis
+ *
+ * Mensagens repetidas (como as tabelas de utils.hpp) são registradas uma
+ * vez com intern() e, dali em diante, cada registro leva apenas o id e os
+ * argumentos: o Logger com LogEvent não copia o texto, os formatadores usam
+ * os trechos já escapados e o BinaryFileWriter grava o texto uma única vez
+ * por arquivo, no dicionário.
+ *
+ * Registrar um texto já conhecido devolve o mesmo id. Os ids valem durante
+ * o processo e começam em 1; find() não usa lock e pode ser chamado de
+ * qualquer thread, inclusive durante um intern() concorrente.
+ *
+ * Exemplo:
+ * @code
+ * static const MessageId batch_done = MessageCatalog::shared().intern("Lote #{} concluído: {} transações.");
+ * logger.emit_template(batch_done, LogLevel::INFO, producer_id, buffer, 54321, 150);
+ * @endcode
+ */
+class MessageCatalog {
+public:
+    static const size_t MAX_TEMPLATES = 4096;  ///< Capacidade do catálogo (ids 1..MAX_TEMPLATES-1)
+
+    MessageCatalog() : count(1) {
+        for (size_t i = 0; i < MAX_TEMPLATES; ++i) {
+            slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    /// Catálogo usado pelo Logger, pelos LogEvent e pelo BinaryFileWriter
+    static MessageCatalog& shared() {
+        static MessageCatalog catalog;
+        return catalog;
+    }
+
+    /**
+     * @brief Registra um template (ou encontra o já registrado)
+     * @param text Texto com marcadores "{}" para os argumentos
+     * @return Id do template
+     * @throws std::length_error se o catálogo estiver cheio
+     */
+    MessageId intern(const std::string& text) {
+        std::lock_guard<std::mutex> lock(intern_mutex);
+
+        std::unordered_map<std::string, MessageId>::const_iterator found = ids.find(text);
+        if (found != ids.end()) {
+            return found->second;
+        }
+        if (count.load(std::memory_order_relaxed) >= MAX_TEMPLATES) {
+            throw std::length_error("Catálogo de mensagens cheio: " + std::to_string(MAX_TEMPLATES - 1) + " templates");
+        }
+
+        MessageId id = static_cast<MessageId>(count.load(std::memory_order_relaxed));
+        owned.push_back(std::unique_ptr<MessageTemplate>(new MessageTemplate(id, text)));
+        ids[text] = id;
+        slots[id].store(owned.back().get(), std::memory_order_release);
+        count.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    MessageId intern(const char* text) {
+        return intern(std::string(text));
+    }
+
+    /**
+     * @brief Template de um id
+     * @return nullptr se o id não estiver registrado
+     */
+    const MessageTemplate* find(MessageId id) const {
+        if (id == 0 || id >= MAX_TEMPLATES) {
+            return nullptr;
+        }
+        return slots[id].load(std::memory_order_acquire);
+    }
+
+    /// Quantidade de templates registrados
+    size_t size() const {
+        return count.load(std::memory_order_acquire) - 1;
+    }
+
+private:
+    std::mutex intern_mutex;                                    ///< Serializa os registros
+    std::unordered_map<std::string, MessageId> ids;             ///< Texto -> id
+    std::vector<std::unique_ptr<MessageTemplate> > owned;       ///< Templates, em ordem de id
+    std::atomic<const MessageTemplate*> slots[MAX_TEMPLATES];   ///< Leitura sem lock por id
+    std::atomic<size_t> count;                                  ///< Próximo id livre
+
+    // Desabilita cópia, os ids pertencem a esta instância
+    MessageCatalog(const MessageCatalog&) = delete;
+    MessageCatalog& operator=(const MessageCatalog&) = delete;
+};
@@ -0,0 +1,469 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "memory_budget.hpp"
+
+/**
+ * @file metrics.hpp
+ * @brief Métricas do pipeline: contadores, histogramas de latência e profundidade da fila
+ *
+ * Cada thread escreve apenas na sua própria parcela (registrada no primeiro
+ * uso), sem operações atômicas de leitura-modificação-escrita nem disputa
+ * de linha de cache; snapshot() soma as parcelas no momento da leitura.
+ * @code
+ * MetricsRegistry metrics;
+ * Consumer<MessageBuffer, FileWriter> consumer(buffer, writer, 1, 64, &metrics);
+ * ...
+ * std::string text = metrics::prometheus_text(metrics.snapshot());
+ * @endcode
+ */
+
+/// Contadores mantidos pelo pipeline
+enum class MetricCounter {
+    RECORDS_ENQUEUED,   ///< Registros aceitos pelo buffer (Logger)
+    RECORDS_REJECTED,   ///< Registros recusados pelo buffer: descartados ou após shutdown (Logger)
+    RECORDS_WRITTEN,    ///< Registros entregues ao escritor (Consumer)
+    BYTES_WRITTEN,      ///< Bytes dos registros entregues ao escritor, estimados para LogEvent (Consumer)
+    BATCHES_WRITTEN     ///< Chamadas a append_batch() (Consumer)
+};
+
+/// Latências medidas pelo pipeline
+enum class MetricLatency {
+    QUEUE,              ///< Do instante do registro até sair do buffer
+    APPEND,             ///< Da saída do buffer até append_batch() retornar; não inclui o que o escritor grava depois
+    SEND                ///< Do instante previsto pelo gerador de carga até o Logger retornar (Producer)
+};
+
+/**
+ * @brief Histograma log-linear de valores em nanossegundos (no estilo HDR)
+ *
+ * Valores até 2^SUB_BUCKET_BITS são exatos; acima, cada potência de dois é
+ * dividida em 2^SUB_BUCKET_BITS faixas, o que limita o erro relativo a
+ * cerca de 3%. Valores acima de 2^MAX_MAGNITUDE ns (~2,4 horas) são
+ * contados na última faixa.
+ *
+ * Escrito por uma única thread (record); lido por qualquer uma.
+ */
+class LatencyHistogram {
+public:
+    static const unsigned SUB_BUCKET_BITS = 5;                          ///< 32 faixas por potência de dois
+    static const unsigned MAX_MAGNITUDE = 43;                           ///< Maior potência de dois representada
+    static const size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static const size_t BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    LatencyHistogram() : buckets(new std::atomic<uint64_t>[BUCKET_COUNT]), total_sum(0), max_value(0) {
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Conta count ocorrências de value (apenas pela thread dona)
+     */
+    void record(uint64_t value, uint64_t count = 1) {
+        bump(buckets[bucket_of(value)], count);
+        bump(total_sum, value * count);
+        if (value > max_value.load(std::memory_order_relaxed)) {
+            max_value.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /// Soma as contagens deste histograma em counts (BUCKET_COUNT posições)
+    void merge_into(std::vector<uint64_t>& counts, uint64_t& sum, uint64_t& max) const {
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            counts[i] += buckets[i].load(std::memory_order_relaxed);
+        }
+        sum += total_sum.load(std::memory_order_relaxed);
+        uint64_t local_max = max_value.load(std::memory_order_relaxed);
+        max = local_max > max ? local_max : max;
+    }
+
+    /// Faixa de um valor
+    static size_t bucket_of(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+
+        unsigned magnitude = highest_bit(value);
+        if (magnitude > MAX_MAGNITUDE) {
+            return BUCKET_COUNT - 1;
+        }
+
+        unsigned shift = magnitude - SUB_BUCKET_BITS;
+        size_t sub = static_cast<size_t>(value >> shift) - SUB_BUCKETS;
+        return (shift + 1) * SUB_BUCKETS + sub;
+    }
+
+    /// Valor representativo (meio) de uma faixa
+    static uint64_t bucket_value(size_t bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+
+        unsigned shift = static_cast<unsigned>(bucket / SUB_BUCKETS) - 1;
+        uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+        return lower + ((uint64_t(1) << shift) >> 1);
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets;  ///< Contagem por faixa
+    std::atomic<uint64_t> total_sum;                    ///< Soma dos valores (para a média)
+    std::atomic<uint64_t> max_value;                    ///< Maior valor visto
+
+    /// Posição do bit mais significativo (value > 0)
+    static unsigned highest_bit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+        unsigned bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    /// Incremento de escritor único: sem RMW atômico, visível para leitores
+    static void bump(std::atomic<uint64_t>& cell, uint64_t amount) {
+        cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+};
+
+/// Resumo de um histograma já somado entre as threads
+struct HistogramSummary {
+    uint64_t count;     ///< Número de amostras
+    uint64_t sum;       ///< Soma em ns
+    uint64_t max;       ///< Maior valor em ns
+    uint64_t p50;       ///< Percentis em ns
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+};
+
+/// Leitura consistente o suficiente de todas as métricas em um instante
+struct MetricsSnapshot {
+    static const size_t COUNTER_COUNT = 5;
+    static const size_t LATENCY_COUNT = 3;
+
+    double uptime_seconds;                      ///< Desde a criação do registro
+    double interval_seconds;                    ///< Desde o snapshot anterior
+    uint64_t counters[COUNTER_COUNT];           ///< Totais, indexados por MetricCounter
+    HistogramSummary latencies[LATENCY_COUNT];  ///< Indexados por MetricLatency
+    uint64_t queue_depth;                       ///< Última profundidade observada
+    uint64_t queue_high_water;                  ///< Maior profundidade observada
+    double records_per_second;                  ///< Registros escritos/s no intervalo
+    double bytes_per_second;                    ///< Bytes escritos/s no intervalo
+
+    uint64_t counter(MetricCounter which) const {
+        return counters[static_cast<size_t>(which)];
+    }
+
+    const HistogramSummary& latency(MetricLatency which) const {
+        return latencies[static_cast<size_t>(which)];
+    }
+};
+
+/**
+ * @brief Registro de métricas compartilhado por Logger e Consumer
+ *
+ * add() e record_latency() escrevem na parcela da thread atual;
+ * observe_queue_depth() atualiza dois atômicos globais (chamado uma vez
+ * por lote). snapshot() pode ser chamado de qualquer thread.
+ */
+class MetricsRegistry {
+public:
+    MetricsRegistry()
+        : registry_id(next_registry_id()),
+          created(std::chrono::steady_clock::now()),
+          last_snapshot(created),
+          last_records(0),
+          last_bytes(0),
+          queue_depth(0),
+          queue_high_water(0) {}
+
+    /// Soma amount a um contador
+    void add(MetricCounter which, uint64_t amount = 1) {
+        std::atomic<uint64_t>& cell = local_shard().counters[static_cast<size_t>(which)];
+        cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Registra uma latência
+     * @param count Número de registros que tiveram essa latência (ex: um lote inteiro)
+     */
+    void record_latency(MetricLatency which, std::chrono::nanoseconds latency, uint64_t count = 1) {
+        uint64_t value = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+        local_shard().latencies[static_cast<size_t>(which)].record(value, count);
+    }
+
+    /// Registra a profundidade atual da fila e atualiza a marca máxima
+    void observe_queue_depth(size_t depth) {
+        uint64_t value = depth;
+        queue_depth.store(value, std::memory_order_relaxed);
+
+        uint64_t high = queue_high_water.load(std::memory_order_relaxed);
+        while (value > high &&
+               !queue_high_water.compare_exchange_weak(high, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Soma as parcelas de todas as threads
+     *
+     * As taxas (registros e bytes por segundo) são calculadas sobre o
+     * intervalo desde o snapshot anterior.
+     */
+    MetricsSnapshot snapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        MetricsSnapshot result;
+        for (size_t i = 0; i < MetricsSnapshot::COUNTER_COUNT; ++i) {
+            result.counters[i] = 0;
+        }
+
+        std::vector<uint64_t> counts(LatencyHistogram::BUCKET_COUNT);
+        for (size_t l = 0; l < MetricsSnapshot::LATENCY_COUNT; ++l) {
+            std::fill(counts.begin(), counts.end(), 0);
+            uint64_t sum = 0;
+            uint64_t max = 0;
+            for (size_t s = 0; s < shards.size(); ++s) {
+                shards[s]->latencies[l].merge_into(counts, sum, max);
+            }
+            result.latencies[l] = summarize(counts, sum, max);
+        }
+
+        for (size_t s = 0; s < shards.size(); ++s) {
+            for (size_t i = 0; i < MetricsSnapshot::COUNTER_COUNT; ++i) {
+                result.counters[i] += shards[s]->counters[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        result.uptime_seconds = std::chrono::duration<double>(now - created).count();
+        result.interval_seconds = std::chrono::duration<double>(now - last_snapshot).count();
+        result.queue_depth = queue_depth.load(std::memory_order_relaxed);
+        result.queue_high_water = queue_high_water.load(std::memory_order_relaxed);
+
+        uint64_t records = result.counter(MetricCounter::RECORDS_WRITTEN);
+        uint64_t bytes = result.counter(MetricCounter::BYTES_WRITTEN);
+        double interval = result.interval_seconds > 0 ? result.interval_seconds : 1.0;
+        result.records_per_second = static_cast<double>(records - last_records) / interval;
+        result.bytes_per_second = static_cast<double>(bytes - last_bytes) / interval;
+
+        last_snapshot = now;
+        last_records = records;
+        last_bytes = bytes;
+        return result;
+    }
+
+private:
+    /// Parcela de uma thread
+    struct Shard {
+        std::atomic<uint64_t> counters[MetricsSnapshot::COUNTER_COUNT];
+        LatencyHistogram latencies[MetricsSnapshot::LATENCY_COUNT];
+
+        Shard() {
+            for (size_t i = 0; i < MetricsSnapshot::COUNTER_COUNT; ++i) {
+                counters[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    const uint64_t registry_id;                         ///< Identifica o registro no cache das threads
+    std::mutex mutex;                                   ///< Protege shards e o estado dos snapshots
+    std::vector<std::unique_ptr<Shard> > shards;        ///< Uma parcela por thread que já escreveu
+
+    const std::chrono::steady_clock::time_point created;
+    std::chrono::steady_clock::time_point last_snapshot;
+    uint64_t last_records;                              ///< RECORDS_WRITTEN no snapshot anterior
+    uint64_t last_bytes;                                ///< BYTES_WRITTEN no snapshot anterior
+
+    std::atomic<uint64_t> queue_depth;                  ///< Última profundidade observada
+    std::atomic<uint64_t> queue_high_water;             ///< Maior profundidade observada
+
+    /**
+     * @brief Obtém a parcela da thread atual, registrando uma nova se necessário
+     */
+    Shard& local_shard() {
+        // (id do registro, parcela) para cada registro em que esta thread já escreveu
+        static thread_local std::vector<std::pair<uint64_t, Shard*> > thread_shards;
+
+        for (size_t i = 0; i < thread_shards.size(); ++i) {
+            if (thread_shards[i].first == registry_id) {
+                return *thread_shards[i].second;
+            }
+        }
+
+        Shard* shard = new Shard();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            shards.push_back(std::unique_ptr<Shard>(shard));
+        }
+        thread_shards.push_back(std::make_pair(registry_id, shard));
+        return *shard;
+    }
+
+    static HistogramSummary summarize(const std::vector<uint64_t>& counts, uint64_t sum, uint64_t max) {
+        HistogramSummary summary = {0, sum, max, 0, 0, 0, 0};
+        for (size_t i = 0; i < counts.size(); ++i) {
+            summary.count += counts[i];
+        }
+        if (summary.count == 0) {
+            return summary;
+        }
+
+        const double quantiles[4] = {0.5, 0.9, 0.99, 0.999};
+        uint64_t* targets[4] = {&summary.p50, &summary.p90, &summary.p99, &summary.p999};
+        size_t next = 0;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size() && next < 4; ++i) {
+            seen += counts[i];
+            while (next < 4 && static_cast<double>(seen) >= quantiles[next] * static_cast<double>(summary.count)) {
+                uint64_t value = LatencyHistogram::bucket_value(i);
+                *targets[next++] = value < max ? value : max;
+            }
+        }
+        return summary;
+    }
+
+    /// Ids únicos evitam confundir um registro novo alocado no endereço de outro já destruído
+    static uint64_t next_registry_id() {
+        static std::atomic<uint64_t> counter(0);
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Desabilita cópia, threads guardam ponteiros para as parcelas
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+};
+
+namespace metrics {
+    namespace detail {
+        inline void append_header(std::string& out, const char* name, const char* type, const char* help) {
+            char line[256];
+            std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+            out += line;
+        }
+
+        inline void append_metric(std::string& out, const char* name, const char* type, const char* help,
+                                  uint64_t value) {
+            append_header(out, name, type, help);
+            char line[128];
+            std::snprintf(line, sizeof(line), "%s %llu\n", name, static_cast<unsigned long long>(value));
+            out += line;
+        }
+
+        inline void append_metric(std::string& out, const char* name, const char* type, const char* help,
+                                  double value) {
+            append_header(out, name, type, help);
+            char line[128];
+            std::snprintf(line, sizeof(line), "%s %.9g\n", name, value);
+            out += line;
+        }
+
+        inline void append_summary(std::string& out, const char* name, const char* help,
+                                   const HistogramSummary& summary) {
+            append_header(out, name, "summary", help);
+            char line[128];
+
+            const char* quantiles[4] = {"0.5", "0.9", "0.99", "0.999"};
+            const uint64_t values[4] = {summary.p50, summary.p90, summary.p99, summary.p999};
+            for (size_t i = 0; i < 4; ++i) {
+                std::snprintf(line, sizeof(line), "%s{quantile=\"%s\"} %.9f\n", name, quantiles[i], values[i] / 1e9);
+                out += line;
+            }
+            std::snprintf(line, sizeof(line), "%s_sum %.9f\n%s_count %llu\n", name, summary.sum / 1e9,
+                          name, static_cast<unsigned long long>(summary.count));
+            out += line;
+        }
+    }
+
+    /**
+     * @brief Converte um snapshot para o formato de texto do Prometheus
+     * @param snapshot Métricas a exportar
+     * @return Texto pronto para ser servido em /metrics
+     *
+     * Latências são exportadas em segundos como summaries (quantis 0.5 a 0.999).
+     */
+    inline std::string prometheus_text(const MetricsSnapshot& snapshot) {
+        std::string out;
+        out.reserve(2048);
+
+        detail::append_metric(out, "spd_records_enqueued_total", "counter",
+                              "Registros aceitos pelo buffer", snapshot.counter(MetricCounter::RECORDS_ENQUEUED));
+        detail::append_metric(out, "spd_records_rejected_total", "counter",
+                              "Registros recusados pelo buffer", snapshot.counter(MetricCounter::RECORDS_REJECTED));
+        detail::append_metric(out, "spd_records_written_total", "counter",
+                              "Registros entregues ao escritor", snapshot.counter(MetricCounter::RECORDS_WRITTEN));
+        detail::append_metric(out, "spd_bytes_written_total", "counter",
+                              "Bytes entregues ao escritor", snapshot.counter(MetricCounter::BYTES_WRITTEN));
+        detail::append_metric(out, "spd_batches_written_total", "counter",
+                              "Lotes entregues ao escritor", snapshot.counter(MetricCounter::BATCHES_WRITTEN));
+        detail::append_metric(out, "spd_queue_depth", "gauge",
+                              "Última profundidade observada da fila", snapshot.queue_depth);
+        detail::append_metric(out, "spd_queue_depth_high_water", "gauge",
+                              "Maior profundidade observada da fila", snapshot.queue_high_water);
+        detail::append_metric(out, "spd_write_records_per_second", "gauge",
+                              "Registros escritos por segundo desde o snapshot anterior", snapshot.records_per_second);
+        detail::append_metric(out, "spd_write_bytes_per_second", "gauge",
+                              "Bytes escritos por segundo desde o snapshot anterior", snapshot.bytes_per_second);
+        detail::append_metric(out, "spd_uptime_seconds", "gauge",
+                              "Tempo desde a criação do registro de métricas", snapshot.uptime_seconds);
+
+        detail::append_summary(out, "spd_queue_latency_seconds",
+                               "Do instante do registro até sair do buffer", snapshot.latency(MetricLatency::QUEUE));
+        detail::append_summary(out, "spd_append_latency_seconds",
+                               "Da saída do buffer até append_batch() retornar", snapshot.latency(MetricLatency::APPEND));
+        if (snapshot.latency(MetricLatency::SEND).count > 0) {
+            detail::append_summary(out, "spd_send_latency_seconds",
+                                   "Do instante previsto pelo gerador de carga até o Logger retornar",
+                                   snapshot.latency(MetricLatency::SEND));
+        }
+        return out;
+    }
+
+    /**
+     * @brief Converte o uso de um MemoryBudget para o formato de texto do Prometheus
+     * @param budget Orçamento a exportar
+     * @return Texto para ser servido em /metrics junto ao do snapshot
+     *
+     * O uso é exportado por área no gauge spd_memory_bytes{area="..."}.
+     */
+    inline std::string prometheus_text(const MemoryBudget& budget) {
+        static const char* const names[MemoryBudget::AREA_COUNT] = {"buffer", "staging", "batches", "writer"};
+
+        std::string out;
+        out.reserve(1024);
+
+        detail::append_header(out, "spd_memory_bytes", "gauge", "Memória retida pelo pipeline, por área");
+        char line[128];
+        for (size_t i = 0; i < MemoryBudget::AREA_COUNT; ++i) {
+            std::snprintf(line, sizeof(line), "spd_memory_bytes{area=\"%s\"} %llu\n", names[i],
+                          static_cast<unsigned long long>(budget.used(static_cast<MemoryArea>(i))));
+            out += line;
+        }
+        detail::append_metric(out, "spd_memory_peak_bytes", "gauge",
+                              "Maior uso de memória do pipeline", static_cast<uint64_t>(budget.peak()));
+        detail::append_metric(out, "spd_memory_limit_bytes", "gauge",
+                              "Orçamento de memória do pipeline", static_cast<uint64_t>(budget.limit()));
+        detail::append_metric(out, "spd_memory_pressure", "gauge",
+                              "1 entre a marca alta e a volta à marca baixa",
+                              static_cast<uint64_t>(budget.under_pressure() ? 1 : 0));
+        detail::append_metric(out, "spd_memory_pressure_events_total", "counter",
+                              "Vezes que o uso passou da marca alta", budget.pressure_events());
+        return out;
+    }
+}
@@ -0,0 +1,757 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <stdexcept>
+#include <iostream>
+#include <memory>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "log_level.hpp"
+#include "record.hpp"
+#include "compression.hpp"
+
+/**
+ * @brief Configuração do NetworkWriter
+ *
+ * Criada com tcp(), udp() ou syslog() e ajustada com os métodos with_*():
+ * @code
+ * NetworkOptions::tcp("collector.local", 9000).with_frame_bytes(256 * 1024).with_compression(1)
+ * @endcode
+ */
+class NetworkOptions {
+public:
+    /// Protocolo de envio
+    enum class Transport {
+        TCP,        ///< Conexão persistente; frames grandes enviados em sequência
+        UDP,        ///< Datagramas com registros inteiros, sem confirmação
+        SYSLOG      ///< Um datagrama syslog (RFC 5424) por registro
+    };
+
+    /**
+     * @brief Envia o JSONL por uma conexão TCP persistente
+     *
+     * Sem compressão o fluxo é o próprio JSONL; com compressão, cada frame
+     * é um membro gzip independente e o fluxo inteiro é um .gz válido.
+     */
+    static NetworkOptions tcp(const std::string& host, uint16_t port) {
+        return NetworkOptions(Transport::TCP, host, port, 64 * 1024);
+    }
+
+    /// Agrupa registros inteiros em datagramas UDP de até frame_bytes (padrão 1400)
+    static NetworkOptions udp(const std::string& host, uint16_t port) {
+        return NetworkOptions(Transport::UDP, host, port, 1400);
+    }
+
+    /// Envia cada registro como uma mensagem syslog por UDP (facility user)
+    static NetworkOptions syslog(const std::string& host, uint16_t port = 514) {
+        return NetworkOptions(Transport::SYSLOG, host, port, 1400);
+    }
+
+    /**
+     * @brief Tamanho a partir do qual o frame em montagem é enviado
+     * @throws std::invalid_argument se bytes for 0
+     */
+    NetworkOptions with_frame_bytes(size_t bytes) const {
+        if (bytes == 0) {
+            throw std::invalid_argument("Tamanho do frame deve ser maior que zero");
+        }
+        NetworkOptions options(*this);
+        options.frame_limit = bytes;
+        return options;
+    }
+
+    /**
+     * @brief Frames entregues ao socket em uma única chamada (TCP)
+     * @throws std::invalid_argument se count for 0 ou maior que 64
+     */
+    NetworkOptions with_max_in_flight(size_t count) const {
+        if (count == 0 || count > 64) {
+            throw std::invalid_argument("Frames em voo devem estar entre 1 e 64");
+        }
+        NetworkOptions options(*this);
+        options.in_flight_limit = count;
+        return options;
+    }
+
+    /**
+     * @brief Comprime cada frame com gzip (apenas TCP, requer zlib)
+     * @param level Nível de compressão do zlib (1 a 9)
+     */
+    NetworkOptions with_compression(int level = 1) const {
+        NetworkOptions options(*this);
+        options.gzip_level = level;
+        return options;
+    }
+
+    /**
+     * @brief Bytes guardados enquanto o coletor está indisponível ou lento
+     *
+     * Acima do limite os frames mais antigos são descartados e contados em
+     * NetworkWriter::dropped_records().
+     */
+    NetworkOptions with_spool_bytes(size_t bytes) const {
+        NetworkOptions options(*this);
+        options.spool_limit = bytes;
+        return options;
+    }
+
+    /// Tempo máximo que um frame parcial espera antes de ser enviado
+    NetworkOptions with_flush_interval(std::chrono::milliseconds interval) const {
+        NetworkOptions options(*this);
+        options.interval = interval;
+        return options;
+    }
+
+    /// Espera inicial entre tentativas de reconexão (dobra a cada falha, até 30 s)
+    NetworkOptions with_reconnect_delay(std::chrono::milliseconds delay) const {
+        NetworkOptions options(*this);
+        options.reconnect = delay;
+        return options;
+    }
+
+    /// Campo APP-NAME das mensagens syslog
+    NetworkOptions with_app_name(const std::string& name) const {
+        NetworkOptions options(*this);
+        options.app = name;
+        return options;
+    }
+
+    Transport transport() const { return protocol; }
+    const std::string& host() const { return host_name; }
+    uint16_t port() const { return port_number; }
+    size_t frame_bytes() const { return frame_limit; }
+    size_t max_in_flight() const { return in_flight_limit; }
+    int compression_level() const { return gzip_level; }
+    size_t spool_bytes() const { return spool_limit; }
+    std::chrono::milliseconds flush_interval() const { return interval; }
+    std::chrono::milliseconds reconnect_delay() const { return reconnect; }
+    const std::string& app_name() const { return app; }
+
+private:
+    Transport protocol;                     ///< TCP, UDP ou syslog
+    std::string host_name;                  ///< Endereço do coletor
+    uint16_t port_number;                   ///< Porta do coletor
+    size_t frame_limit;                     ///< Bytes por frame/datagrama
+    size_t in_flight_limit;                 ///< Frames por chamada de envio
+    int gzip_level;                         ///< 0 = sem compressão
+    size_t spool_limit;                     ///< Bytes guardados sem enviar
+    std::chrono::milliseconds interval;     ///< Espera máxima de um frame parcial
+    std::chrono::milliseconds reconnect;    ///< Espera inicial entre reconexões
+    std::string app;                        ///< APP-NAME do syslog
+
+    NetworkOptions(Transport protocol, const std::string& host, uint16_t port, size_t frame_bytes)
+        : protocol(protocol),
+          host_name(host),
+          port_number(port),
+          frame_limit(frame_bytes),
+          in_flight_limit(4),
+          gzip_level(0),
+          spool_limit(8 * 1024 * 1024),
+          interval(200),
+          reconnect(100),
+          app("spd") {}
+};
+
+/**
+ * @brief Escritor que envia os registros diretamente a um coletor pela rede
+ *
+ * Mesma interface de escrita do FileWriter (append, append_batch, flush,
+ * close), para ser usado como escritor de um Consumer ou como sink de um
+ * FanOutConsumer, sem passar pelo disco. Os consumers apenas acrescentam
+ * os registros ao frame em montagem; uma thread própria comprime os frames
+ * (se configurado) e os entrega ao socket não bloqueante, até max_in_flight
+ * frames por chamada de sendmsg().
+ *
+ * No TCP a conexão é persistente; se cair, os frames ainda não entregues
+ * ao kernel ficam guardados (até spool_bytes) e a thread reconecta com
+ * espera crescente. Como não há confirmação do coletor, o que já estava no
+ * buffer do kernel quando a conexão caiu pode se perder. No UDP e no syslog
+ * o envio é "dispare e esqueça": datagramas que o kernel recusa são
+ * descartados e contados.
+ *
+ * Disponível apenas em sistemas POSIX.
+ */
+class NetworkWriter {
+public:
+    /**
+     * @brief Inicia a thread de envio; a conexão é feita por ela, em segundo plano
+     * @param options Coletor, protocolo, tamanho dos frames, compressão e spool
+     * @throws std::invalid_argument se a compressão for pedida para UDP/syslog
+     * @throws std::runtime_error se a compressão for pedida sem zlib
+     */
+    explicit NetworkWriter(const NetworkOptions& options)
+        : options(options),
+          fd(-1),
+          frame_records(0),
+          spooled_bytes(0),
+          sending(false),
+          connected(false),
+          accepting(true),
+          close_deadline(0),
+          sent_frames(0),
+          sent_bytes(0),
+          dropped(0),
+          reconnect_count(0) {
+        if (options.compression_level() > 0) {
+            if (options.transport() != NetworkOptions::Transport::TCP) {
+                throw std::invalid_argument("Compressão disponível apenas no modo TCP");
+            }
+            compressor.reset(new compression::FrameCompressor(options.compression_level()));
+        }
+
+        sender_thread = std::thread(&NetworkWriter::sender_routine, this);
+
+        std::cout << "NetworkWriter criado para " << options.host() << ":" << options.port()
+                  << " (" << transport_name() << ")" << std::endl;
+    }
+
+    ~NetworkWriter() {
+        close();
+    }
+
+    /// Envia um registro formatado (nível extraído do texto)
+    void append(const std::string& record) {
+        LogLevel level = options.transport() == NetworkOptions::Transport::SYSLOG
+            ? level_from_text(record) : LogLevel::INFO;
+        append(record, level);
+    }
+
+    /// Envia um registro formatado cujo nível já é conhecido (usado pelo syslog)
+    void append(const std::string& record, LogLevel level) {
+        std::lock_guard<std::mutex> lock(mutex);
+        add_locked(record.data(), record.size(), level);
+    }
+
+    /**
+     * @brief Acrescenta um lote de registros aos frames
+     * @tparam Record Tipo do registro, acessado via append_record() e record_level()
+     *
+     * Os registros são formatados fora da seção crítica; sob o lock há
+     * apenas a cópia para o frame em montagem.
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        static thread_local std::string block;
+        static thread_local std::vector<size_t> ends;
+        static thread_local std::vector<LogLevel> levels;
+        block.clear();
+        ends.clear();
+        levels.clear();
+
+        for (size_t i = 0; i < records.size(); ++i) {
+            append_record(block, records[i]);
+            ends.push_back(block.size());
+            levels.push_back(record_level(records[i]));
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (options.transport() == NetworkOptions::Transport::TCP) {
+            // No TCP os limites entre registros não importam: um único bloco
+            add_locked(block.data(), block.size(), LogLevel::INFO, records.size());
+            return;
+        }
+
+        size_t begin = 0;
+        for (size_t i = 0; i < ends.size(); ++i) {
+            add_locked(block.data() + begin, ends[i] - begin, levels[i]);
+            begin = ends[i];
+        }
+    }
+
+    bool is_open() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return accepting;
+    }
+
+    const NetworkOptions& get_options() const {
+        return options;
+    }
+
+    /// Indica se o socket está conectado ao coletor
+    bool is_connected() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return connected;
+    }
+
+    uint64_t frames_sent() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sent_frames;
+    }
+
+    uint64_t bytes_sent() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sent_bytes;
+    }
+
+    /// Registros descartados (spool cheio, datagramas recusados ou fechamento sem coletor)
+    uint64_t dropped_records() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dropped;
+    }
+
+    uint64_t reconnects() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reconnect_count;
+    }
+
+    /**
+     * @brief Bytes retidos pelo frame em montagem e pelo spool (usado pelo MemoryBudget)
+     */
+    size_t buffered_bytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return frame.size() + spooled_bytes;
+    }
+
+    /**
+     * @brief Envia o frame parcial e espera o spool esvaziar
+     *
+     * Não espera por um coletor indisponível: retorna assim que não houver
+     * conexão, deixando os frames no spool para depois da reconexão.
+     */
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        seal_locked();
+        wake.notify_one();
+        drained.wait(lock, [this]() { return (pending.empty() && !sending) || !connected || !accepting; });
+    }
+
+    /**
+     * @brief Envia o que estiver pendente e encerra a thread de envio
+     *
+     * Desiste na primeira falha de conexão ou após close_timeout() esperando
+     * o coletor, inclusive no meio de um envio já em andamento; o que não
+     * puder ser enviado é contado como descartado.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!accepting) {
+                return;
+            }
+            seal_locked();
+            close_deadline.store((std::chrono::steady_clock::now() + close_timeout()).time_since_epoch().count());
+            accepting = false;
+        }
+        wake.notify_all();
+
+        if (sender_thread.joinable()) {
+            sender_thread.join();
+        }
+        drained.notify_all();
+
+        if (dropped > 0) {
+            std::cout << "NetworkWriter " << options.host() << ":" << options.port()
+                      << " descartou " << dropped << " registros" << std::endl;
+        }
+    }
+
+    /// Espera máxima pelo coletor no close()
+    static std::chrono::milliseconds close_timeout() {
+        return std::chrono::milliseconds(5000);
+    }
+
+private:
+    /// Bytes prontos para envio e quantos registros contêm
+    struct Frame {
+        std::string data;
+        size_t records;
+        bool compressed;        ///< data já passou pelo compressor
+    };
+
+    const NetworkOptions options;                   ///< Configuração
+    std::unique_ptr<compression::FrameCompressor> compressor;   ///< Usado só pela thread de envio
+    int fd;                                         ///< Socket (só a thread de envio o acessa)
+
+    mutable std::mutex mutex;                       ///< Protege frames, estado e contadores
+    std::condition_variable wake;                   ///< Acorda a thread de envio
+    std::condition_variable drained;                ///< Sinaliza spool vazio (flush)
+
+    std::string frame;                              ///< Frame em montagem
+    size_t frame_records;                           ///< Registros no frame em montagem
+    std::chrono::steady_clock::time_point frame_started;   ///< Primeiro registro do frame em montagem
+    std::deque<Frame> pending;                      ///< Frames completos aguardando envio (spool)
+    size_t spooled_bytes;                           ///< Bytes em pending e em envio
+
+    bool sending;                                   ///< Thread de envio com frames fora de pending
+    bool connected;                                 ///< Socket conectado
+    bool accepting;                                 ///< false após close()
+    std::atomic<std::chrono::steady_clock::rep> close_deadline;    ///< Prazo do close() (0 = sem prazo), lido também durante o envio
+
+    uint64_t sent_frames;                           ///< Frames entregues ao kernel
+    uint64_t sent_bytes;                            ///< Bytes entregues ao kernel
+    uint64_t dropped;                               ///< Registros descartados
+    uint64_t reconnect_count;                       ///< Conexões refeitas após falha
+
+    std::thread sender_thread;                      ///< Thread que envia os frames
+
+    const char* transport_name() const {
+        switch (options.transport()) {
+            case NetworkOptions::Transport::TCP: return "tcp";
+            case NetworkOptions::Transport::UDP: return "udp";
+            default: return "syslog";
+        }
+    }
+
+    /**
+     * @brief Acrescenta registros ao frame em montagem (chamado com mutex)
+     * @param count Quantos registros data contém
+     */
+    void add_locked(const char* data, size_t size, LogLevel level, size_t count = 1) {
+        if (!accepting || size == 0) {
+            return;
+        }
+
+        if (options.transport() == NetworkOptions::Transport::SYSLOG) {
+            frame = syslog_header(level);
+            // Sem o terminador do JSONL: o datagrama delimita a mensagem
+            frame.append(data, data[size - 1] == '\n' ? size - 1 : size);
+            frame_records = 1;
+            seal_locked();
+            return;
+        }
+
+        // Datagramas só contêm registros inteiros
+        if (options.transport() == NetworkOptions::Transport::UDP && !frame.empty() &&
+            frame.size() + size > options.frame_bytes()) {
+            seal_locked();
+        }
+
+        if (frame.empty()) {
+            frame_started = std::chrono::steady_clock::now();
+        }
+        frame.append(data, size);
+        frame_records += count;
+
+        if (frame.size() >= options.frame_bytes()) {
+            seal_locked();
+        }
+    }
+
+    /// Cabeçalho RFC 5424 com facility user; horário e host ficam a cargo do coletor
+    std::string syslog_header(LogLevel level) const {
+        int severity = level == LogLevel::ERROR ? 3 : (level == LogLevel::WARNING ? 4 : 6);
+        return "<" + std::to_string(8 + severity) + ">1 - - " + options.app_name() + " - - - ";
+    }
+
+    /**
+     * @brief Move o frame em montagem para o spool, descartando os mais antigos se exceder o limite
+     */
+    void seal_locked() {
+        if (frame.empty()) {
+            return;
+        }
+
+        Frame sealed;
+        sealed.data.swap(frame);
+        sealed.records = frame_records;
+        sealed.compressed = false;
+        frame_records = 0;
+
+        spooled_bytes += sealed.data.size();
+        pending.push_back(std::move(sealed));
+
+        while (spooled_bytes > options.spool_bytes() && !pending.empty()) {
+            dropped += pending.front().records;
+            spooled_bytes -= pending.front().data.size();
+            pending.pop_front();
+        }
+
+        if (pending.size() == 1) {
+            wake.notify_one();
+        }
+    }
+
+    /**
+     * @brief Rotina da thread de envio: fecha frames antigos, conecta e envia o spool
+     */
+    void sender_routine() {
+        std::vector<Frame> in_flight;
+        std::chrono::milliseconds backoff = options.reconnect_delay();
+        bool closing = false;
+        bool ever_connected = false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait_for(lock, options.flush_interval(), [this]() { return !pending.empty() || !accepting; });
+
+            if (!frame.empty() && std::chrono::steady_clock::now() - frame_started >= options.flush_interval()) {
+                seal_locked();
+            }
+            closing = !accepting;
+            if (pending.empty()) {
+                if (closing) {
+                    break;
+                }
+                continue;
+            }
+
+            if (fd < 0) {
+                lock.unlock();
+                int socket_fd = open_socket();
+                lock.lock();
+
+                if (socket_fd < 0) {
+                    if (closing) {
+                        break;
+                    }
+                    wake.wait_for(lock, backoff, [this]() { return !accepting; });
+                    backoff = std::min(backoff * 2, std::chrono::milliseconds(30000));
+                    continue;
+                }
+
+                fd = socket_fd;
+                connected = true;
+                backoff = options.reconnect_delay();
+                if (ever_connected) {
+                    ++reconnect_count;
+                }
+                ever_connected = true;
+            }
+
+            // Retira do spool os frames desta rodada; compressão e envio sem lock
+            size_t count = std::min(pending.size(), options.max_in_flight());
+            for (size_t i = 0; i < count; ++i) {
+                in_flight.push_back(std::move(pending.front()));
+                pending.pop_front();
+            }
+            sending = true;
+            lock.unlock();
+
+            size_t original_bytes = 0;
+            for (size_t i = 0; i < in_flight.size(); ++i) {
+                original_bytes += in_flight[i].data.size();
+                compress_frame(in_flight[i]);
+            }
+
+            size_t delivered = 0;
+            uint64_t delivered_bytes = 0;
+            uint64_t lost_records = 0;
+            bool ok = send_frames(in_flight, delivered, delivered_bytes, lost_records);
+
+            lock.lock();
+            sending = false;
+            spooled_bytes -= original_bytes;
+            sent_frames += delivered;
+            sent_bytes += delivered_bytes;
+            dropped += lost_records;
+
+            if (!ok) {
+                // Frames não entregues voltam para o início do spool, já comprimidos
+                for (size_t i = in_flight.size(); i > delivered; --i) {
+                    Frame& frame_back = in_flight[i - 1];
+                    spooled_bytes += frame_back.data.size();
+                    pending.push_front(std::move(frame_back));
+                }
+                ::close(fd);
+                fd = -1;
+                connected = false;
+                if (close_expired()) {
+                    break;
+                }
+            }
+            in_flight.clear();
+            drained.notify_all();
+        }
+
+        // Encerramento: descarta o que o coletor não recebeu
+        for (size_t i = 0; i < pending.size(); ++i) {
+            dropped += pending[i].records;
+        }
+        pending.clear();
+        spooled_bytes = 0;
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        connected = false;
+    }
+
+    /// Comprime o frame uma única vez (frames que voltam ao spool após falha já estão comprimidos)
+    void compress_frame(Frame& pending_frame) {
+        if (!compressor || pending_frame.compressed) {
+            return;
+        }
+
+        static thread_local std::string packed;
+        if (compressor->compress(pending_frame.data.data(), pending_frame.data.size(), packed)) {
+            pending_frame.data.swap(packed);
+            pending_frame.compressed = true;
+        }
+    }
+
+    /**
+     * @brief Resolve o coletor e abre o socket não bloqueante
+     * @return Descritor conectado, ou -1 se falhar
+     */
+    int open_socket() const {
+        bool stream = options.transport() == NetworkOptions::Transport::TCP;
+
+        struct addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = stream ? SOCK_STREAM : SOCK_DGRAM;
+
+        struct addrinfo* addresses = nullptr;
+        std::string port = std::to_string(options.port());
+        if (::getaddrinfo(options.host().c_str(), port.c_str(), &hints, &addresses) != 0) {
+            return -1;
+        }
+
+        int result = -1;
+        for (struct addrinfo* address = addresses; address != nullptr && result < 0; address = address->ai_next) {
+            int socket_fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (socket_fd < 0) {
+                continue;
+            }
+            ::fcntl(socket_fd, F_SETFD, FD_CLOEXEC);
+            ::fcntl(socket_fd, F_SETFL, ::fcntl(socket_fd, F_GETFL) | O_NONBLOCK);
+
+            if (stream) {
+                int enabled = 1;
+                ::setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+            }
+
+            if (::connect(socket_fd, address->ai_addr, address->ai_addrlen) == 0 ||
+                (errno == EINPROGRESS && wait_connected(socket_fd))) {
+                result = socket_fd;
+            } else {
+                ::close(socket_fd);
+            }
+        }
+
+        ::freeaddrinfo(addresses);
+        return result;
+    }
+
+    /// Espera o connect() não bloqueante terminar
+    static bool wait_connected(int socket_fd) {
+        struct pollfd descriptor;
+        descriptor.fd = socket_fd;
+        descriptor.events = POLLOUT;
+        descriptor.revents = 0;
+        if (::poll(&descriptor, 1, CONNECT_TIMEOUT_MS) != 1) {
+            return false;
+        }
+
+        int error = 0;
+        socklen_t length = sizeof(error);
+        return ::getsockopt(socket_fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0;
+    }
+
+    /**
+     * @brief Entrega os frames ao socket
+     * @param delivered Recebe quantos frames (do início) foram entregues por completo
+     * @param delivered_bytes Recebe os bytes desses frames
+     * @param lost_records Recebe os registros de datagramas recusados (UDP/syslog)
+     * @return false se a conexão TCP falhou ou o prazo do close() acabou
+     *
+     * O prazo é relido a cada espera pelo socket, então um close() chamado
+     * com o envio em andamento também o interrompe.
+     */
+    bool send_frames(std::vector<Frame>& frames, size_t& delivered, uint64_t& delivered_bytes,
+                     uint64_t& lost_records) {
+        if (options.transport() != NetworkOptions::Transport::TCP) {
+            // Dispare e esqueça: um datagrama por frame, sem esperar o socket
+            for (size_t i = 0; i < frames.size(); ++i) {
+                if (::send(fd, frames[i].data.data(), frames[i].data.size(), MSG_DONTWAIT | MSG_NOSIGNAL) ==
+                    static_cast<ssize_t>(frames[i].data.size())) {
+                    delivered_bytes += frames[i].data.size();
+                } else {
+                    lost_records += frames[i].records;
+                }
+                ++delivered;
+            }
+            return true;
+        }
+
+        struct iovec vectors[64];
+        size_t offset = 0;      // Bytes já enviados do frame frames[delivered]
+        while (delivered < frames.size()) {
+            size_t count = 0;
+            for (size_t i = delivered; i < frames.size(); ++i, ++count) {
+                size_t skip = i == delivered ? offset : 0;
+                vectors[count].iov_base = const_cast<char*>(frames[i].data.data() + skip);
+                vectors[count].iov_len = frames[i].data.size() - skip;
+            }
+
+            struct msghdr message;
+            std::memset(&message, 0, sizeof(message));
+            message.msg_iov = vectors;
+            message.msg_iovlen = count;
+
+            ssize_t written = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    return false;
+                }
+
+                struct pollfd descriptor;
+                descriptor.fd = fd;
+                descriptor.events = POLLOUT;
+                descriptor.revents = 0;
+                int ready = ::poll(&descriptor, 1, SEND_POLL_MS);
+                if (ready < 0 && errno != EINTR) {
+                    return false;
+                }
+                if ((descriptor.revents & (POLLERR | POLLHUP)) != 0 || close_expired()) {
+                    return false;
+                }
+                continue;
+            }
+
+            size_t remaining = static_cast<size_t>(written);
+            while (remaining > 0) {
+                size_t left = frames[delivered].data.size() - offset;
+                if (remaining < left) {
+                    offset += remaining;
+                    break;
+                }
+                remaining -= left;
+                delivered_bytes += frames[delivered].data.size();
+                ++delivered;
+                offset = 0;
+            }
+        }
+        return true;
+    }
+
+    /// close() foi chamado e seu prazo já passou
+    bool close_expired() const {
+        std::chrono::steady_clock::rep deadline = close_deadline.load();
+        return deadline != 0 && std::chrono::steady_clock::now().time_since_epoch().count() >= deadline;
+    }
+
+    static const int CONNECT_TIMEOUT_MS = 2000;     ///< Espera máxima do connect()
+    static const int SEND_POLL_MS = 100;            ///< Espera por espaço no buffer do socket
+
+    // Desabilita cópia, a thread de envio referencia esta instância
+    NetworkWriter(const NetworkWriter&) = delete;
+    NetworkWriter& operator=(const NetworkWriter&) = delete;
+};
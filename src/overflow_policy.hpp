@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <stdexcept>
+
+#include "log_level.hpp"
+
+/**
+ * @brief Define o que o MessageBuffer faz com um push quando está cheio
+ *
+ * Exemplo: descarta os registros mais antigos, mas nunca um ERROR (que
+ * espera por espaço como no modo bloqueante):
+ * @code
+ * OverflowPolicy::drop_oldest().preserving(LogLevel::ERROR)
+ * @endcode
+ */
+class OverflowPolicy {
+public:
+    enum class Mode {
+        BLOCK,          ///< Espera por espaço (comportamento original)
+        BLOCK_FOR,      ///< Espera no máximo um tempo e então descarta o novo
+        DROP_NEWEST,    ///< Descarta o registro novo
+        DROP_OLDEST,    ///< Descarta o registro mais antigo do buffer
+        SAMPLE,         ///< Aceita o novo com uma probabilidade (descartando o mais antigo)
+        SPILL           ///< Grava o excedente em uma fila em disco
+    };
+
+    /// Espera por espaço
+    static OverflowPolicy block() {
+        return OverflowPolicy(Mode::BLOCK);
+    }
+
+    /**
+     * @brief Espera por espaço até um tempo limite
+     * @param timeout Tempo máximo de espera; depois o registro novo é descartado
+     */
+    static OverflowPolicy block_for(std::chrono::milliseconds timeout) {
+        OverflowPolicy policy(Mode::BLOCK_FOR);
+        policy.wait_timeout = timeout;
+        return policy;
+    }
+
+    /// Descarta o registro novo sem esperar
+    static OverflowPolicy drop_newest() {
+        return OverflowPolicy(Mode::DROP_NEWEST);
+    }
+
+    /// Abre espaço descartando o registro mais antigo do buffer
+    static OverflowPolicy drop_oldest() {
+        return OverflowPolicy(Mode::DROP_OLDEST);
+    }
+
+    /**
+     * @brief Com o buffer cheio, aceita uma fração dos registros novos
+     * @param keep_ratio Probabilidade (0 a 1) de aceitar o novo, descartando o mais antigo
+     * @throws std::invalid_argument se keep_ratio estiver fora de [0, 1]
+     */
+    static OverflowPolicy sample(double keep_ratio) {
+        if (!(keep_ratio >= 0.0 && keep_ratio <= 1.0)) {
+            throw std::invalid_argument("Fração de amostragem deve estar entre 0 e 1");
+        }
+        OverflowPolicy policy(Mode::SAMPLE);
+        policy.keep_ratio = keep_ratio;
+        return policy;
+    }
+
+    /**
+     * @brief Grava o excedente em uma fila em disco, lida pelos consumers depois da memória
+     * @param path Arquivo da fila (recriado a cada execução)
+     *
+     * Suportado para registros de texto (std::string).
+     */
+    static OverflowPolicy spill(const std::string& path) {
+        OverflowPolicy policy(Mode::SPILL);
+        policy.spill_file = path;
+        return policy;
+    }
+
+    /**
+     * @brief Registros deste nível ou acima nunca são descartados: esperam por espaço
+     */
+    OverflowPolicy preserving(LogLevel level) const {
+        OverflowPolicy policy(*this);
+        policy.preserve_enabled = true;
+        policy.preserve_level = level;
+        return policy;
+    }
+
+    Mode mode() const { return overflow_mode; }
+    std::chrono::milliseconds timeout() const { return wait_timeout; }
+    double sample_ratio() const { return keep_ratio; }
+    const std::string& spill_path() const { return spill_file; }
+
+    /**
+     * @brief Indica se um registro deste nível deve esperar em vez de ser descartado
+     */
+    bool preserves(LogLevel level) const {
+        return preserve_enabled && level >= preserve_level;
+    }
+
+    /// Indica se o modo pode descartar registros (e precisa saber seu nível)
+    bool may_drop() const {
+        return overflow_mode != Mode::BLOCK && overflow_mode != Mode::SPILL;
+    }
+
+private:
+    Mode overflow_mode;                         ///< Ação com o buffer cheio
+    std::chrono::milliseconds wait_timeout;     ///< Espera máxima em BLOCK_FOR
+    double keep_ratio;                          ///< Fração aceita em SAMPLE
+    std::string spill_file;                     ///< Arquivo da fila em SPILL
+    bool preserve_enabled;                      ///< Ativa a proteção por nível
+    LogLevel preserve_level;                    ///< Nível mínimo protegido
+
+    explicit OverflowPolicy(Mode mode)
+        : overflow_mode(mode),
+          wait_timeout(0),
+          keep_ratio(1.0),
+          preserve_enabled(false),
+          preserve_level(LogLevel::ERROR) {}
+};
@@ -2,6 +2,7 @@
 
 #include "logger.hpp"
 #include "utils.hpp"
+#include "load_profile.hpp"
 
 #include <iostream>
 #include <exception>
@@ -9,24 +10,62 @@
 #include <array>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <random>
 #include <chrono>
 #include <string>
+#include <cmath>
 
-template<typename LogBuffer>
+/**
+ * @brief Gerador de logs de teste
+ * @tparam LogBuffer Tipo do buffer onde os registros são enviados
+ * @tparam Formatter Formato dos registros (ver formatter.hpp)
+ *
+ * No modo interativo (padrão) envia uma mensagem pronta a cada 0-2 s. Com
+ * LoadProfile::open_loop() vira gerador de carga com taxa, rajadas,
+ * tamanhos e mistura de níveis configuráveis (ver load_profile.hpp).
+ *
+ * Cada Producer tem seu próprio gerador aleatório, semeado com o
+ * producer_id, e as distribuições são montadas uma vez na construção,
+ * então milhares de producers não disputam nenhum estado.
+ */
+template<typename LogBuffer, typename Formatter = PrettyJsonFormatter>
 class Producer {
 public:
     /**
      * @brief Construtor que inicializa producer com buffer e ID
      * @param buffer Referência para buffer onde logs serão armazenados
      * @param producer_id ID único deste producer
+     * @param staging Agrupamento dos registros antes do envio ao buffer
+     * @param metrics Registro opcional de métricas (registros aceitos e recusados e,
+     * no modo de carga, a latência de envio)
+     * @param profile Modo de geração dos registros
      */
-    explicit Producer(LogBuffer& buffer, int producer_id)
-        : logger(),
+    explicit Producer(LogBuffer& buffer, int producer_id, const StagingPolicy& staging = StagingPolicy::disabled(),
+                      MetricsRegistry* metrics = nullptr, const LoadProfile& profile = LoadProfile::interactive())
+        : logger(staging),
           buffer_ref(buffer),
           producer_id(producer_id),
+          profile(profile),
+          metrics(metrics),
           is_running(false),
-          generator(std::random_device{}()) {}
+          stop_requested(false),
+          sent(0),
+          rejected(0),
+          max_latency_nanos(0),
+          generator(make_generator(producer_id)),
+          interval_distribution(0, 2000),
+          message_distribution(0, utils::info_messages.size() - 1),
+          level_distribution({static_cast<double>(profile.level_weight(0)),
+                              static_cast<double>(profile.level_weight(1)),
+                              static_cast<double>(profile.level_weight(2))}),
+          size_distribution(profile.message_size().min_bytes(), profile.message_size().max_bytes()),
+          lognormal_distribution(std::log(profile.message_size().median_bytes() > 0 ? profile.message_size().median_bytes() : 1.0),
+                                 profile.message_size().sigma() > 0 ? profile.message_size().sigma() : 1.0) {
+        logger.set_metrics(metrics);
+        intern_messages();
+    }
 
     ~Producer() {
         stop();
@@ -35,7 +74,7 @@ public:
     /**
      * @brief Inicia a rotina de logging automático
      *
-     * Cria uma thread separada que gera logs em intervalos de 3-10 segundos.
+     * Cria uma thread separada que gera logs conforme o LoadProfile.
      * Não faz nada se já estiver rodando.
      */
     void start() {
@@ -44,16 +83,24 @@ public:
             return;
         }
 
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex);
+            stop_requested = false;
+        }
         is_running.store(true);
         worker_thread = std::thread(&Producer::logging_routine, this);
 
-        std::cout << "Producer [" << producer_id << "] iniciado..." << std::endl;
+        // No modo de carga seriam milhares de linhas
+        if (!profile.is_open_loop()) {
+            std::cout << "Producer [" << producer_id << "] iniciado..." << std::endl;
+        }
     }
 
     /**
      * @brief Para a rotina de logging
      *
-     * Sinaliza para a thread parar e aguarda sua finalização.
+     * Sinaliza para a thread parar (interrompendo a espera pelo próximo
+     * envio) e aguarda sua finalização.
      * Operação segura - pode ser chamada múltiplas vezes.
      */
     void stop() {
@@ -61,44 +108,107 @@ public:
             return;
         }
 
-        is_running.store(false);
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex);
+            stop_requested = true;
+        }
+        stop_cv.notify_all();
 
         if (worker_thread.joinable()) {
             worker_thread.join();
         }
+        is_running.store(false);
+
+        if (!profile.is_open_loop()) {
+            std::cout << "Producer [" << producer_id << "] parado..." << std::endl;
+        }
+    }
+
+    /// Envios tentados (aceitos ou recusados)
+    uint64_t records_sent() const {
+        return sent.load(std::memory_order_relaxed);
+    }
 
-        std::cout << "Producer [" << producer_id << "] parado..." << std::endl;
+    /// Envios recusados pelo buffer
+    uint64_t records_rejected() const {
+        return rejected.load(std::memory_order_relaxed);
+    }
+
+    /// Maior latência de envio, contada a partir do instante previsto (modo de carga)
+    std::chrono::nanoseconds max_send_latency() const {
+        return std::chrono::nanoseconds(max_latency_nanos.load(std::memory_order_relaxed));
+    }
+
+    const LoadProfile& get_load_profile() const {
+        return profile;
     }
 
 private:
-    Logger<LogBuffer> logger;           ///< Logger interno para gerar mensagens
+    typedef std::chrono::steady_clock schedule_clock;
+
+    Logger<LogBuffer, Formatter> logger;  ///< Logger interno para gerar mensagens
     LogBuffer& buffer_ref;              ///< Referência ao buffer
     int producer_id;                    ///< ID único deste producer
+    const LoadProfile profile;          ///< Modo de geração
+    MetricsRegistry* metrics;           ///< Latência de envio (nullptr = desativada)
     std::atomic<bool> is_running;       ///< Flag thread-safe para controle
     std::thread worker_thread;          ///< Thread dedicada para logging
-    mutable std::mt19937 generator;     ///< Gerador de números aleatórios
+    std::mutex stop_mutex;              ///< Protege stop_requested
+    std::condition_variable stop_cv;    ///< Interrompe a espera do próximo envio
+    bool stop_requested;                ///< Sinaliza fim da thread
+
+    std::atomic<uint64_t> sent;         ///< Envios tentados
+    std::atomic<uint64_t> rejected;     ///< Envios recusados
+    std::atomic<int64_t> max_latency_nanos; ///< Maior latência de envio
+
+    // Estado aleatório, usado apenas pela thread do producer
+    std::mt19937 generator;                                         ///< Gerador deste producer
+    std::uniform_int_distribution<int> interval_distribution;       ///< Intervalo do modo interativo (ms)
+    std::uniform_int_distribution<size_t> message_distribution;     ///< Índice da mensagem pronta
+    std::discrete_distribution<int> level_distribution;             ///< Mistura de níveis
+    std::uniform_int_distribution<size_t> size_distribution;        ///< Tamanho FIXED/UNIFORM
+    std::lognormal_distribution<double> lognormal_distribution;     ///< Tamanho LOGNORMAL
+    std::exponential_distribution<double> arrival_distribution;     ///< Intervalo de Poisson (média 1)
+    std::array<std::array<MessageId, 5>, 3> message_ids;           ///< Ids das mensagens de utils.hpp, por nível
+    std::string synthetic;                                          ///< Mensagem gerada, reaproveitada
+
+    /// Sementes distintas por producer mesmo com random_device determinístico
+    static std::mt19937 make_generator(int producer_id) {
+        std::random_device device;
+        std::seed_seq seeds{device(), device(), static_cast<unsigned>(producer_id)};
+        return std::mt19937(seeds);
+    }
 
     /**
      * @brief Gera intervalo aleatório entre 0 e 2 segundos
      * @return Duração em milissegundos para próximo log
      */
-    std::chrono::milliseconds get_random_interval() const {
-        std::uniform_int_distribution<int> distribution(0, 2000);
-        return std::chrono::milliseconds(distribution(generator));
+    std::chrono::milliseconds get_random_interval() {
+        return std::chrono::milliseconds(interval_distribution(generator));
+    }
+
+    /**
+     * @brief Registra as mensagens de utils.hpp no MessageCatalog
+     *
+     * Textos já registrados (por outro Producer) devolvem o mesmo id.
+     */
+    void intern_messages() {
+        const LogLevel levels[] = {LogLevel::INFO, LogLevel::WARNING, LogLevel::ERROR};
+        for (size_t i = 0; i < message_ids.size(); ++i) {
+            const std::array<const char*, 5>* messages = get_messages_for_level(levels[i]);
+            for (size_t j = 0; j < messages->size(); ++j) {
+                message_ids[i][j] = MessageCatalog::shared().intern((*messages)[j]);
+            }
+        }
     }
 
     /**
      * @brief Seleciona mensagem aleatória baseada no nível
      * @param level Nível do log para filtrar mensagens apropriadas
-     * @return Mensagem correspondente ao nível
+     * @return Id do template da mensagem correspondente ao nível
      */
-    std::string get_random_message(LogLevel level) const {
-        const std::array<const char*, 5>* messages = get_messages_for_level(level);
-
-        if (!messages) return "Mensagem de teste do producer " + std::to_string(producer_id);
-
-        std::uniform_int_distribution<size_t> dist(0, messages->size() - 1);
-        return std::string((*messages)[dist(generator)]);
+    MessageId get_random_message(LogLevel level) {
+        return message_ids[static_cast<size_t>(level)][message_distribution(generator)];
     }
 
     /**
@@ -120,54 +230,119 @@ private:
     }
 
     /**
-     * @brief Seleciona nível de log aleatório com pesos realistas
+     * @brief Seleciona nível de log aleatório com os pesos do LoadProfile
      * @return Nível de log selecionado
      *
-     * Distribuição: ~70% INFO, ~25% WARNING, ~5% ERROR
+     * Distribuição padrão: ~70% INFO, ~25% WARNING, ~5% ERROR
+     */
+    LogLevel get_random_log_level() {
+        return static_cast<LogLevel>(level_distribution(generator));
+    }
+
+    /// Tamanho sorteado para a próxima mensagem gerada
+    size_t get_random_size() {
+        const MessageSizeDistribution& sizes = profile.message_size();
+        if (sizes.kind() != MessageSizeDistribution::LOGNORMAL) {
+            return size_distribution(generator);
+        }
+        double bytes = lognormal_distribution(generator);
+        if (bytes < 1.0) {
+            return 1;
+        }
+        return bytes > static_cast<double>(sizes.max_bytes()) ? sizes.max_bytes() : static_cast<size_t>(bytes);
+    }
+
+    /**
+     * @brief Envia um registro conforme o LoadProfile
+     * @return true se o buffer aceitou
+     */
+    bool send(LogLevel level) {
+        if (profile.message_size().kind() == MessageSizeDistribution::CANNED) {
+            return logger.emit_template(get_random_message(level), level, producer_id, buffer_ref);
+        }
+
+        // Texto de tamanho sorteado, cortado de um trecho fixo de mensagens reais
+        static const std::string filler = make_filler();
+        size_t size = get_random_size();
+        synthetic.assign(filler, 0, size);
+        return logger.emit(synthetic, level, producer_id, buffer_ref);
+    }
+
+    static std::string make_filler() {
+        std::string text;
+        text.reserve(MessageSizeDistribution::MAX_BYTES + 256);
+        for (size_t i = 0; text.size() < MessageSizeDistribution::MAX_BYTES; ++i) {
+            text += utils::info_messages[i % utils::info_messages.size()];
+            text += ' ';
+        }
+        return text;
+    }
+
+    /**
+     * @brief Espera até time ou até stop(); devolve false se foi pedido para parar
+     *
+     * Se houver registros acumulados pelo agrupamento, acorda quando o lote
+     * vence o max_delay() e o publica (Logger::flush_expired()), em vez de
+     * deixá-lo parado até o próximo envio.
      */
-    LogLevel get_random_log_level() const {
-        // std::uniform_int_distribution<T> tem sobrecarga do operator()
-        // template<class URNG>
-        // result_type operator()(URNG& g);
-        std::uniform_int_distribution<int> dist(1, 100);
-        int random_int = dist(generator);
+    bool wait_until(schedule_clock::time_point time) {
+        for (;;) {
+            schedule_clock::time_point wake = time;
+            std::chrono::system_clock::time_point expiry = logger.next_expiry();
+            if (expiry != std::chrono::system_clock::time_point::max()) {
+                schedule_clock::time_point staged = schedule_clock::now() +
+                    std::chrono::duration_cast<schedule_clock::duration>(expiry - std::chrono::system_clock::now());
+                if (staged < wake) {
+                    wake = staged;
+                }
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(stop_mutex);
+                if (stop_cv.wait_until(lock, wake, [this]() { return stop_requested; })) {
+                    return false;
+                }
+            }
+            if (wake == time) {
+                return true;
+            }
+            logger.flush_expired();
+        }
+    }
 
-        if (random_int <= 70) {
-            return LogLevel::INFO;
-        } else if (random_int <= 95) {
-            return LogLevel::WARNING;
-        } else {
-            return LogLevel::ERROR;
+    bool should_stop() {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        return stop_requested;
+    }
+
+    /// Conta um envio (só a thread do producer escreve)
+    void count_sent(bool accepted) {
+        sent.store(sent.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (!accepted) {
+            rejected.store(rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
         }
     }
 
+    bool reached_limit() const {
+        return profile.max_records() != 0 && sent.load(std::memory_order_relaxed) >= profile.max_records();
+    }
+
     /**
      * @brief Rotina principal executada na thread separada
      *
-     * Loop que gera logs em intervalos aleatórios até receber sinal de parada.
-     * Trata exceções para evitar crash da thread.
+     * Loop que gera logs até receber sinal de parada (ou atingir
+     * with_max_records()). Trata exceções para evitar crash da thread.
      */
     void logging_routine() {
         try {
-            while (is_running.load()) {
-                // Gera dados alearórios
-                LogLevel level = get_random_log_level();
-                std::string message = get_random_message(level);
-
-                // Registra o log
-                std::unique_ptr<std::string> log = logger.log(message, level, producer_id, buffer_ref);
-
-                if (log) {
-                    // Log no terminal sem quebrar a mensagem
-                    std::ostringstream oss;
-                    oss << "\n[PRODUCER " << producer_id <<  "] enviando: \n" << *log;
-                    std::cout << oss.str() << std::endl;
-                }
-
-                // Aguarda intervalo aleatório
-                std::chrono::milliseconds interval = get_random_interval();
-                std::this_thread::sleep_for(interval);
+            if (profile.is_open_loop()) {
+                load_routine();
+            } else {
+                interactive_routine();
             }
+
+            // Publica o que ficou acumulado na área desta thread
+            logger.flush(buffer_ref);
         } catch (const std::exception& e) {
             std::cout
                 << "Erro em producer [" << producer_id << "] -> "
@@ -175,4 +350,82 @@ private:
                 << std::endl;
         }
     }
+
+    /// Modo interativo: um log e uma espera aleatória de 0 a 2 s
+    void interactive_routine() {
+        while (!reached_limit()) {
+            // Gera dados alearórios
+            LogLevel level = get_random_log_level();
+            if (Logger<LogBuffer, Formatter>::enabled(level)) {
+                // Registra o log; a exibição no terminal fica a cargo do ConsoleWriter
+                count_sent(send(level));
+            }
+            // Nível filtrado: nem a mensagem é montada
+
+            // Aguarda intervalo aleatório
+            if (!wait_until(schedule_clock::now() + get_random_interval())) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Modo de carga: envios em instantes previstos pela taxa, em malha aberta
+     *
+     * O próximo instante vem do anterior previsto, nunca do fim do envio,
+     * então um Logger bloqueado não reduz a carga oferecida. Esperas curtas
+     * (menos de SPIN_SLACK) não chamam o sistema: o envio sai na hora.
+     */
+    void load_routine() {
+        static const std::chrono::microseconds SPIN_SLACK(50);   ///< Abaixo disso não vale dormir
+
+        schedule_clock::time_point start = schedule_clock::now();
+        // Fase inicial aleatória: producers criados juntos não disparam em sincronia
+        schedule_clock::time_point intended = start + std::chrono::duration_cast<schedule_clock::duration>(
+            next_interval(schedule_clock::duration::zero()) * std::generate_canonical<double, 32>(generator));
+        size_t checks = 0;
+
+        while (!reached_limit()) {
+            schedule_clock::time_point now = schedule_clock::now();
+            if (intended - now > SPIN_SLACK) {
+                if (!wait_until(intended)) {
+                    return;
+                }
+            } else if ((++checks & 63) == 0 && should_stop()) {
+                // Atrasado: verifica a parada sem dormir, a cada 64 envios
+                return;
+            }
+
+            // Nível filtrado consome o instante previsto, mas não é enviado nem medido
+            LogLevel level = get_random_log_level();
+            if (Logger<LogBuffer, Formatter>::enabled(level)) {
+                count_sent(send(level));
+                record_latency(intended, schedule_clock::now());
+            }
+            intended += next_interval(intended - start);
+        }
+    }
+
+    /// Intervalo até o próximo envio, pela taxa em vigor nesse ponto do teste
+    schedule_clock::duration next_interval(schedule_clock::duration elapsed) {
+        double seconds = 1.0 / profile.rate_at(elapsed);
+        if (profile.poisson_arrivals()) {
+            seconds *= arrival_distribution(generator);
+        }
+        return std::chrono::duration_cast<schedule_clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    void record_latency(schedule_clock::time_point intended, schedule_clock::time_point done) {
+        std::chrono::nanoseconds latency = std::chrono::duration_cast<std::chrono::nanoseconds>(done - intended);
+        if (latency.count() > max_latency_nanos.load(std::memory_order_relaxed)) {
+            max_latency_nanos.store(latency.count(), std::memory_order_relaxed);
+        }
+        if (metrics != nullptr) {
+            metrics->record_latency(MetricLatency::SEND, latency);
+        }
+    }
+
+    // Desabilita cópia, a thread guarda this
+    Producer(const Producer&) = delete;
+    Producer& operator=(const Producer&) = delete;
 };
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <algorithm>
+
+#include "log_level.hpp"
+#include "timestamp.hpp"
+
+/**
+ * @file record.hpp
+ * @brief Acesso uniforme aos registros que trafegam pelos buffers
+ *
+ * Consumers e escritores são genéricos sobre o tipo do registro
+ * (LogBuffer::value_type). Todo tipo de registro fornece as funções
+ * livres append_record(), record_level() e record_time(); registros já
+ * formatados também fornecem record_data() e record_size(), e os demais,
+ * record_size_estimate() (métricas do Consumer). Aqui ficam as de std::string, o
+ * registro já formatado como texto. Outros tipos (ex: SlabRecord,
+ * LogEvent) definem suas sobrecargas no próprio header.
+ *
+ * record_memory() estima a memória que o registro retém, usada pelo
+ * MemoryBudget; tipos sem sobrecarga contam apenas o próprio objeto.
+ */
+
+/// Início do texto formatado do registro
+inline const char* record_data(const std::string& record) {
+    return record.data();
+}
+
+/// Tamanho em bytes do texto formatado do registro
+inline size_t record_size(const std::string& record) {
+    return record.size();
+}
+
+/// Memória retida pelo registro: o objeto e a capacidade reservada do texto
+inline size_t record_memory(const std::string& record) {
+    return sizeof(std::string) + record.capacity();
+}
+
+/// Registros sem sobrecarga própria (ex: referências) contam só o objeto
+template<typename Record>
+size_t record_memory(const Record&) {
+    return sizeof(Record);
+}
+
+/// Acrescenta o texto do registro ao final de out
+inline void append_record(std::string& out, const std::string& record) {
+    out.append(record);
+}
+
+/// Nível do registro (extraído do texto, que não carrega o enum)
+inline LogLevel record_level(const std::string& record) {
+    return level_from_text(record);
+}
+
+/// Instante do registro (extraído do texto; false se não houver)
+inline bool record_time(const std::string& record, std::chrono::system_clock::time_point& time) {
+    return time_from_text(record, time);
+}
+
+/**
+ * @brief Extrai o producer_id de um registro de texto já formatado
+ * @param record Início do registro em JSON ("producer_id": 3) ou logfmt (producer_id=3)
+ * @param size Tamanho do registro em bytes
+ * @param producer_id Recebe o valor encontrado
+ * @return false se o campo não existir
+ */
+inline bool producer_from_text(const char* record, size_t size, int& producer_id) {
+    static const char json_key[] = "\"producer_id\"";
+    static const char logfmt_key[] = "producer_id=";
+
+    const char* end = record + size;
+    const char* pos = std::search(record, end, json_key, json_key + sizeof(json_key) - 1);
+    if (pos != end) {
+        pos += sizeof(json_key) - 1;
+    } else {
+        pos = std::search(record, end, logfmt_key, logfmt_key + sizeof(logfmt_key) - 1);
+        if (pos == end) {
+            return false;
+        }
+        pos += sizeof(logfmt_key) - 1;
+    }
+
+    while (pos < end && (*pos == ' ' || *pos == ':')) {
+        ++pos;
+    }
+    bool negative = pos < end && *pos == '-';
+    if (negative) {
+        ++pos;
+    }
+    if (pos == end || *pos < '0' || *pos > '9') {
+        return false;
+    }
+
+    int value = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+        value = value * 10 + (*pos - '0');
+        ++pos;
+    }
+    producer_id = negative ? -value : value;
+    return true;
+}
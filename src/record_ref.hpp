@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+
+#include "log_level.hpp"
+#include "record.hpp"
+
+/**
+ * @brief Referência a um registro que pertence a outro vetor
+ * @tparam T Tipo do registro referenciado (std::string, SlabRecord, LogEvent, ...)
+ *
+ * Implementa a interface de registro (append_record, record_level,
+ * record_time e, quando T os tem, record_data/record_size) repassando ao
+ * original, então um lote de RecordRef pode ser entregue a qualquer
+ * append_batch() sem copiar os registros. Usado pelo FanOutConsumer para
+ * entregar a um sink apenas parte de um lote compartilhado.
+ */
+template<typename T>
+struct RecordRef {
+    const T* record;        ///< Registro original (deve viver mais que a referência)
+
+    RecordRef() : record(nullptr) {}
+    explicit RecordRef(const T& record) : record(&record) {}
+};
+
+template<typename T>
+inline void append_record(std::string& out, const RecordRef<T>& ref) {
+    append_record(out, *ref.record);
+}
+
+template<typename T>
+inline LogLevel record_level(const RecordRef<T>& ref) {
+    return record_level(*ref.record);
+}
+
+template<typename T>
+inline bool record_time(const RecordRef<T>& ref, std::chrono::system_clock::time_point& time) {
+    return record_time(*ref.record, time);
+}
+
+template<typename T>
+inline auto record_data(const RecordRef<T>& ref) -> decltype(record_data(*ref.record)) {
+    return record_data(*ref.record);
+}
+
+template<typename T>
+inline auto record_size(const RecordRef<T>& ref) -> decltype(record_size(*ref.record)) {
+    return record_size(*ref.record);
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "log_level.hpp"
+#include "timestamp.hpp"
+#include "lock_free_buffer.hpp"
+
+class RecordSlab;
+
+/**
+ * @brief Registro de log formatado dentro de uma posição de um RecordSlab
+ *
+ * Funciona como handle com posse exclusiva (apenas movível): o producer
+ * formata o texto diretamente na posição via append()/push_back(), o
+ * handle trafega pelo buffer e a posição volta ao slab quando o consumer
+ * descarta o registro após escrevê-lo.
+ *
+ * Se o texto não couber na posição, ou se o slab estiver esgotado, o
+ * registro passa a usar uma string alocada no heap. Esse caminho é raro e
+ * não faz parte do regime permanente.
+ */
+class SlabRecord {
+public:
+    SlabRecord()
+        : slab(nullptr), slot(nullptr), index(0), slot_capacity(0), length(0), level_value(LogLevel::INFO) {}
+
+    SlabRecord(SlabRecord&& other)
+        : slab(other.slab),
+          slot(other.slot),
+          index(other.index),
+          slot_capacity(other.slot_capacity),
+          length(other.length),
+          level_value(other.level_value),
+          overflow(std::move(other.overflow)) {
+        other.detach();
+    }
+
+    SlabRecord& operator=(SlabRecord&& other) {
+        if (this != &other) {
+            reset();
+            slab = other.slab;
+            slot = other.slot;
+            index = other.index;
+            slot_capacity = other.slot_capacity;
+            length = other.length;
+            level_value = other.level_value;
+            overflow = std::move(other.overflow);
+            other.detach();
+        }
+        return *this;
+    }
+
+    ~SlabRecord() {
+        reset();
+    }
+
+    /**
+     * @brief Acrescenta bytes ao texto do registro
+     * @param text Início dos bytes
+     * @param count Quantidade de bytes
+     */
+    void append(const char* text, size_t count) {
+        if (!overflow && length + count <= slot_capacity) {
+            std::memcpy(slot + length, text, count);
+            length += count;
+            return;
+        }
+
+        spill();
+        overflow->append(text, count);
+    }
+
+    /// Acrescenta um caractere ao texto do registro
+    void push_back(char c) {
+        if (!overflow && length < slot_capacity) {
+            slot[length++] = c;
+            return;
+        }
+
+        spill();
+        overflow->push_back(c);
+    }
+
+    /// Descarta o texto já escrito
+    void clear() {
+        length = 0;
+        overflow.reset();
+    }
+
+    /// Início do texto formatado
+    const char* data() const {
+        return overflow ? overflow->data() : slot;
+    }
+
+    /// Tamanho do texto formatado
+    size_t size() const {
+        return overflow ? overflow->size() : length;
+    }
+
+    LogLevel level() const {
+        return level_value;
+    }
+
+    void set_level(LogLevel level) {
+        level_value = level;
+    }
+
+    /// Informa se o texto foi para o heap (registro grande ou slab esgotado)
+    bool spilled() const {
+        return static_cast<bool>(overflow);
+    }
+
+    /**
+     * @brief Devolve a posição ao slab e esvazia o handle
+     */
+    void reset();
+
+private:
+    friend class RecordSlab;
+
+    RecordSlab* slab;                        ///< Slab de origem (nullptr se não houver posição)
+    char* slot;                              ///< Início da posição reservada
+    uint32_t index;                          ///< Índice da posição no slab
+    size_t slot_capacity;                    ///< Bytes disponíveis na posição
+    size_t length;                           ///< Bytes usados na posição
+    LogLevel level_value;                    ///< Nível do registro
+    std::unique_ptr<std::string> overflow;   ///< Texto no heap quando não cabe na posição
+
+    void detach() {
+        slab = nullptr;
+        slot = nullptr;
+        slot_capacity = 0;
+        length = 0;
+    }
+
+    /// Move o texto já escrito para o heap e devolve a posição ao slab
+    void spill();
+
+    SlabRecord(const SlabRecord&) = delete;
+    SlabRecord& operator=(const SlabRecord&) = delete;
+};
+
+/**
+ * @brief Conjunto pré-alocado de posições de tamanho fixo para registros
+ *
+ * Toda a memória é reservada na construção. As posições livres ficam em
+ * um anel sem lock (BasicLockFreeMessageBuffer de índices), então
+ * producers reservam e consumers devolvem posições sem malloc e sem mutex.
+ */
+class RecordSlab {
+public:
+    static const size_t DEFAULT_SLOT_COUNT = 4096;   ///< Posições do slab compartilhado
+    static const size_t DEFAULT_SLOT_SIZE = 512;     ///< Bytes por posição do slab compartilhado
+
+    /**
+     * @brief Construtor que reserva toda a memória do slab
+     * @param slot_count Número de posições
+     * @param slot_size Bytes de cada posição
+     * @throws std::invalid_argument se slot_count ou slot_size for 0
+     */
+    RecordSlab(size_t slot_count, size_t slot_size)
+        : slot_count(slot_count),
+          slot_size(slot_size),
+          free_slots(slot_count == 0 ? 1 : slot_count) {
+        if (slot_count == 0 || slot_size == 0) {
+            throw std::invalid_argument("Número e tamanho das posições do slab devem ser maiores que zero");
+        }
+
+        storage.reset(new char[slot_count * slot_size]);
+        for (size_t i = 0; i < slot_count; ++i) {
+            free_slots.try_push(static_cast<uint32_t>(i));
+        }
+    }
+
+    /**
+     * @brief Slab usado por padrão pelos Loggers
+     *
+     * Criado no primeiro uso e destruído apenas após o fim de main(), depois
+     * dos buffers e consumers locais que ainda guardam registros.
+     */
+    static RecordSlab& shared() {
+        static RecordSlab instance(DEFAULT_SLOT_COUNT, DEFAULT_SLOT_SIZE);
+        return instance;
+    }
+
+    /**
+     * @brief Reserva uma posição para um novo registro
+     * @param level Nível do registro
+     * @return Registro vazio pronto para receber o texto
+     *
+     * Nunca bloqueia: se não houver posição livre, o registro usa o heap.
+     */
+    SlabRecord acquire(LogLevel level) {
+        SlabRecord record;
+        record.level_value = level;
+
+        uint32_t index = 0;
+        if (free_slots.try_pop(index)) {
+            record.slab = this;
+            record.index = index;
+            record.slot = storage.get() + static_cast<size_t>(index) * slot_size;
+            record.slot_capacity = slot_size;
+        }
+
+        return record;
+    }
+
+    /// Número de posições do slab
+    size_t capacity() const {
+        return slot_count;
+    }
+
+    /// Número aproximado de posições livres
+    size_t available() const {
+        return free_slots.size();
+    }
+
+    /// Bytes de cada posição
+    size_t get_slot_size() const {
+        return slot_size;
+    }
+
+private:
+    friend class SlabRecord;
+
+    const size_t slot_count;                           ///< Número de posições
+    const size_t slot_size;                            ///< Bytes por posição
+    std::unique_ptr<char[]> storage;                   ///< Memória de todas as posições
+    BasicLockFreeMessageBuffer<uint32_t> free_slots;   ///< Índices das posições livres
+
+    void release(uint32_t index) {
+        // Nunca falha: o anel comporta todos os índices
+        free_slots.try_push(index);
+    }
+
+    RecordSlab(const RecordSlab&) = delete;
+    RecordSlab& operator=(const RecordSlab&) = delete;
+};
+
+inline void SlabRecord::spill() {
+    if (overflow) {
+        return;
+    }
+
+    overflow.reset(slot ? new std::string(slot, length) : new std::string());
+    if (slab) {
+        slab->release(index);
+    }
+    detach();
+}
+
+inline void SlabRecord::reset() {
+    if (slab) {
+        slab->release(index);
+    }
+    overflow.reset();
+    detach();
+}
+
+/// Início do texto formatado do registro
+inline const char* record_data(const SlabRecord& record) {
+    return record.data();
+}
+
+/// Tamanho em bytes do texto formatado do registro
+inline size_t record_size(const SlabRecord& record) {
+    return record.size();
+}
+
+/// Memória retida pelo registro: o objeto e o texto ocupado na posição (ou no heap)
+inline size_t record_memory(const SlabRecord& record) {
+    return sizeof(SlabRecord) + record.size();
+}
+
+/// Acrescenta o texto do registro ao final de out
+inline void append_record(std::string& out, const SlabRecord& record) {
+    out.append(record.data(), record.size());
+}
+
+/// Nível do registro, guardado junto à posição
+inline LogLevel record_level(const SlabRecord& record) {
+    return record.level();
+}
+
+/// Instante do registro (extraído do texto; false se não houver)
+inline bool record_time(const SlabRecord& record, std::chrono::system_clock::time_point& time) {
+    return time_from_text(record.data(), record.size(), time);
+}
@@ -0,0 +1,363 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <stdexcept>
+#include <iostream>
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+#include "log_level.hpp"
+#include "record.hpp"
+#include "flush_policy.hpp"
+#include "rotation_policy.hpp"
+#include "compression.hpp"
+#include "file_writer.hpp"
+
+/**
+ * @brief Escritor que divide o log em arquivos por tamanho ou tempo
+ * @tparam SegmentWriter Escritor de cada arquivo (FileWriter, AsyncFileWriter,
+ * MappedFileWriter), construído com (nome, FlushPolicy)
+ *
+ * Mesma interface do FileWriter. Cada arquivo (segmento) recebe o nome
+ * "<base>-AAAAMMDDTHHMMSS-<n><extensão>"; para "logs.jsonl", por exemplo,
+ * "logs-20250831T163201-0.jsonl".
+ *
+ * A troca é atômica: o novo segmento é aberto e publicado com um
+ * std::atomic_store do shared_ptr, e writers que ainda seguram o segmento
+ * antigo terminam sua escrita nele. O fechamento do segmento antigo e sua
+ * compressão (gzip, se RotationPolicy::with_compression() e zlib
+ * disponível) ficam com uma thread de fundo de baixa prioridade, nunca
+ * com as threads consumer.
+ */
+template<typename SegmentWriter>
+class BasicRotatingFileWriter {
+public:
+    /**
+     * @brief Abre o primeiro segmento e inicia a thread de fundo
+     * @param filename Nome base dos arquivos de log
+     * @param rotation Quando trocar de arquivo e se comprime os antigos
+     * @param policy Política de flush de cada segmento
+     * @throws std::runtime_error se não conseguir abrir o primeiro segmento
+     */
+    BasicRotatingFileWriter(const std::string& filename, const RotationPolicy& rotation,
+                            const FlushPolicy& policy = FlushPolicy::every_record())
+        : filename(filename),
+          rotation_policy(rotation),
+          flush_policy(policy),
+          next_index(0),
+          stop_retire(false) {
+        split_filename();
+        current = open_segment();
+        retire_thread = std::thread(&BasicRotatingFileWriter::retire_routine, this);
+    }
+
+    ~BasicRotatingFileWriter() {
+        try {
+            close();
+        } catch (const std::exception&) {
+            // Destrutor não propaga falhas
+        }
+    }
+
+    /**
+     * @brief Adiciona registro formatado ao segmento atual
+     * @param record Registro completo, já com seu terminador
+     */
+    void append(const std::string& record) {
+        LogLevel level = flush_policy.uses_severity() ? level_from_text(record) : LogLevel::INFO;
+        append(record, level);
+    }
+
+    /**
+     * @brief Adiciona registro formatado cujo nível já é conhecido
+     * @param record Registro completo, já com seu terminador
+     * @param level Nível do registro, usado pela política de flush por severidade
+     */
+    void append(const std::string& record, LogLevel level) {
+        std::shared_ptr<Segment> segment = std::atomic_load(&current);
+        segment->writer.append(record, level);
+        after_write(segment, record.size());
+    }
+
+    /**
+     * @brief Adiciona um lote de registros ao segmento atual
+     * @tparam Record Tipo do registro, acessado via append_record() e record_level()
+     * @param records Registros a serem escritos, na ordem do vetor
+     *
+     * O lote inteiro vai para um único segmento; a rotação só é avaliada
+     * depois da escrita.
+     */
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        if (records.empty()) {
+            return;
+        }
+
+        static thread_local std::string block;
+        block.clear();
+
+        LogLevel max_level = LogLevel::INFO;
+        for (size_t i = 0; i < records.size(); ++i) {
+            append_record(block, records[i]);
+
+            if (flush_policy.uses_severity()) {
+                LogLevel level = record_level(records[i]);
+                if (level > max_level) {
+                    max_level = level;
+                }
+            }
+        }
+
+        append(block, max_level);
+    }
+
+    /**
+     * @brief Verifica se o segmento atual está aberto
+     */
+    bool is_open() const {
+        return std::atomic_load(&current)->writer.is_open();
+    }
+
+    /**
+     * @brief Obtém o nome base dos arquivos de log
+     */
+    const std::string& get_filename() const {
+        return filename;
+    }
+
+    /**
+     * @brief Obtém o nome do segmento que está recebendo os registros
+     */
+    std::string current_filename() const {
+        return std::atomic_load(&current)->path;
+    }
+
+    const FlushPolicy& get_flush_policy() const {
+        return flush_policy;
+    }
+
+    const RotationPolicy& get_rotation_policy() const {
+        return rotation_policy;
+    }
+
+    /**
+     * @brief Força flush do segmento atual
+     */
+    void flush() {
+        std::atomic_load(&current)->writer.flush();
+    }
+
+    /**
+     * @brief Fecha o segmento atual, após fechar e comprimir os já rotacionados
+     *
+     * O segmento atual não é comprimido. Após a chamada, tentativas de
+     * escrita irão falhar com exceção.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(retire_mutex);
+            stop_retire = true;
+        }
+        retire_cv.notify_all();
+        if (retire_thread.joinable()) {
+            retire_thread.join();
+        }
+
+        std::atomic_load(&current)->writer.close();
+    }
+
+private:
+    /// Um arquivo da sequência, com o escritor e o volume já escrito
+    struct Segment {
+        SegmentWriter writer;                           ///< Escritor do arquivo
+        std::string path;                               ///< Nome do arquivo
+        std::chrono::steady_clock::time_point opened;   ///< Instante de abertura
+        std::atomic<uint64_t> written;                  ///< Bytes escritos
+
+        Segment(const std::string& path, const FlushPolicy& policy)
+            : writer(path, policy),
+              path(path),
+              opened(std::chrono::steady_clock::now()),
+              written(0) {}
+    };
+
+    std::string filename;                       ///< Nome base
+    std::string stem;                           ///< Nome base sem a extensão
+    std::string extension;                      ///< Extensão, com o ponto (pode ser vazia)
+    const RotationPolicy rotation_policy;       ///< Quando trocar de arquivo
+    const FlushPolicy flush_policy;             ///< Política de flush de cada segmento
+
+    std::shared_ptr<Segment> current;           ///< Segmento atual (acesso via atomic_load/atomic_store)
+    unsigned next_index;                        ///< Número do próximo segmento
+    std::mutex rotate_mutex;                    ///< Garante uma rotação por vez
+
+    std::thread retire_thread;                  ///< Fecha e comprime segmentos antigos
+    std::mutex retire_mutex;                    ///< Protege retired e stop_retire
+    std::condition_variable retire_cv;          ///< Acorda a thread de fundo
+    std::deque<std::shared_ptr<Segment> > retired;   ///< Segmentos aguardando fechamento
+    bool stop_retire;                           ///< Sinaliza fim da thread de fundo
+
+    void split_filename() {
+        size_t slash = filename.find_last_of("/\\");
+        size_t dot = filename.find_last_of('.');
+        if (dot != std::string::npos && (slash == std::string::npos || dot > slash + 1)) {
+            stem = filename.substr(0, dot);
+            extension = filename.substr(dot);
+        } else {
+            stem = filename;
+        }
+    }
+
+    std::shared_ptr<Segment> open_segment() {
+        std::time_t now = std::time(nullptr);
+        std::tm utc;
+#ifdef _WIN32
+        gmtime_s(&utc, &now);
+#else
+        gmtime_r(&now, &utc);
+#endif
+
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%S", &utc);
+
+        std::string path = stem + "-" + stamp + "-" + std::to_string(next_index++) + extension;
+        return std::make_shared<Segment>(path, flush_policy);
+    }
+
+    void after_write(const std::shared_ptr<Segment>& segment, size_t size) {
+        uint64_t written = segment->written.fetch_add(size, std::memory_order_relaxed) + size;
+        if (rotation_policy.should_rotate(written, age_of(*segment))) {
+            rotate(segment);
+        }
+    }
+
+    std::chrono::steady_clock::duration age_of(const Segment& segment) const {
+        if (rotation_policy.interval().count() == 0) {
+            return std::chrono::steady_clock::duration::zero();
+        }
+        return std::chrono::steady_clock::now() - segment.opened;
+    }
+
+    /**
+     * @brief Troca o segmento atual, se ainda for expected
+     *
+     * Se outra thread já estiver rotacionando, retorna sem esperar.
+     */
+    void rotate(const std::shared_ptr<Segment>& expected) {
+        std::unique_lock<std::mutex> lock(rotate_mutex, std::try_to_lock);
+        if (!lock.owns_lock() || std::atomic_load(&current) != expected) {
+            return;
+        }
+
+        std::shared_ptr<Segment> next;
+        try {
+            next = open_segment();
+        } catch (const std::exception& e) {
+            // Continua no segmento atual; a próxima escrita tenta de novo
+            std::cout << "Erro ao rotacionar " << filename << " -> " << e.what() << std::endl;
+            return;
+        }
+
+        std::atomic_store(&current, next);
+
+        {
+            std::lock_guard<std::mutex> retire_lock(retire_mutex);
+            retired.push_back(expected);
+        }
+        retire_cv.notify_one();
+    }
+
+    /**
+     * @brief Fecha o segmento quando nenhum writer o usa mais e o comprime
+     */
+    void retire(std::shared_ptr<Segment>& segment) {
+        // Writers que leram o ponteiro antes da troca ainda podem estar escrevendo
+        while (segment.use_count() > 1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::string path = segment->path;
+        try {
+            segment->writer.close();
+        } catch (const std::exception& e) {
+            std::cout << "Erro ao fechar " << path << " -> " << e.what() << std::endl;
+        }
+        segment.reset();
+
+        if (rotation_policy.compresses() && compression::available()) {
+            if (compression::gzip_file(path, path + ".gz")) {
+                std::remove(path.c_str());
+            } else {
+                std::cout << "Erro ao comprimir " << path << std::endl;
+            }
+        }
+    }
+
+    static void lower_thread_priority() {
+#if defined(__linux__)
+        // No Linux a prioridade (nice) vale por thread
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+    }
+
+    /**
+     * @brief Rotina da thread de fundo
+     *
+     * Processa os segmentos rotacionados e, com rotação por tempo, troca o
+     * segmento atual mesmo sem novas escritas.
+     */
+    void retire_routine() {
+        lower_thread_priority();
+
+        std::unique_lock<std::mutex> lock(retire_mutex);
+        while (true) {
+            if (rotation_policy.interval().count() > 0) {
+                retire_cv.wait_for(lock, std::chrono::seconds(1),
+                                   [this]() { return stop_retire || !retired.empty(); });
+            } else {
+                retire_cv.wait(lock, [this]() { return stop_retire || !retired.empty(); });
+            }
+
+            while (!retired.empty()) {
+                std::shared_ptr<Segment> segment = retired.front();
+                retired.pop_front();
+
+                lock.unlock();
+                retire(segment);
+                lock.lock();
+            }
+
+            if (stop_retire) {
+                return;
+            }
+
+            lock.unlock();
+            std::shared_ptr<Segment> segment = std::atomic_load(&current);
+            if (rotation_policy.should_rotate(segment->written.load(), age_of(*segment))) {
+                rotate(segment);
+            }
+            lock.lock();
+        }
+    }
+
+    // Desabilita cópia para evitar problemas com mutex
+    BasicRotatingFileWriter(const BasicRotatingFileWriter&) = delete;
+    BasicRotatingFileWriter& operator=(const BasicRotatingFileWriter&) = delete;
+};
+
+typedef BasicRotatingFileWriter<FileWriter> RotatingFileWriter;
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Define quando o RotatingFileWriter troca de arquivo
+ *
+ * Os critérios podem ser combinados; a rotação acontece quando qualquer um
+ * deles é atingido. Exemplo: arquivos de no máximo 64 MiB ou 1 hora,
+ * comprimidos em segundo plano:
+ * @code
+ * RotationPolicy::by_size(64 * 1024 * 1024).with_interval(std::chrono::hours(1)).with_compression()
+ * @endcode
+ */
+class RotationPolicy {
+public:
+    /**
+     * @brief Rotação quando o arquivo atual atingir um tamanho
+     * @param bytes Bytes escritos no arquivo que disparam a troca
+     */
+    static RotationPolicy by_size(uint64_t bytes) {
+        return RotationPolicy().with_size(bytes);
+    }
+
+    /**
+     * @brief Rotação periódica, contada a partir da abertura de cada arquivo
+     * @param interval Tempo máximo de uso de um arquivo
+     */
+    static RotationPolicy by_interval(std::chrono::seconds interval) {
+        return RotationPolicy().with_interval(interval);
+    }
+
+    /// Adiciona critério por tamanho
+    RotationPolicy with_size(uint64_t bytes) const {
+        RotationPolicy policy(*this);
+        policy.max_bytes = bytes;
+        return policy;
+    }
+
+    /// Adiciona critério por tempo
+    RotationPolicy with_interval(std::chrono::seconds interval) const {
+        RotationPolicy policy(*this);
+        policy.max_age = interval;
+        return policy;
+    }
+
+    /// Comprime (gzip) os arquivos já rotacionados, se o zlib estiver disponível
+    RotationPolicy with_compression(bool enabled = true) const {
+        RotationPolicy policy(*this);
+        policy.compress = enabled;
+        return policy;
+    }
+
+    uint64_t size_limit() const { return max_bytes; }
+    std::chrono::seconds interval() const { return max_age; }
+    bool compresses() const { return compress; }
+
+    /**
+     * @brief Decide se o arquivo atual deve ser trocado
+     * @param written Bytes escritos no arquivo atual
+     * @param age Tempo desde a abertura do arquivo atual
+     */
+    bool should_rotate(uint64_t written, std::chrono::steady_clock::duration age) const {
+        if (written == 0) {
+            return false;
+        }
+        if (max_bytes > 0 && written >= max_bytes) {
+            return true;
+        }
+        return max_age.count() > 0 && age >= max_age;
+    }
+
+private:
+    uint64_t max_bytes;                 ///< 0 desativa o critério por tamanho
+    std::chrono::seconds max_age;       ///< 0 desativa o critério por tempo
+    bool compress;                      ///< Comprime arquivos rotacionados
+
+    RotationPolicy()
+        : max_bytes(0),
+          max_age(0),
+          compress(false) {}
+};
@@ -0,0 +1,481 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "backoff.hpp"
+#include "event_count.hpp"
+#include "lock_free_buffer.hpp"
+
+/**
+ * @brief Buffer particionado com uma fila SPSC por producer
+ *
+ * Cada thread producer recebe, no primeiro push(), uma lane exclusiva: um anel
+ * single-producer/single-consumer em que o push nunca disputa com outros
+ * producers (wait-free). Consumers percorrem as lanes em round-robin a partir
+ * de um cursor compartilhado; uma lane só é drenada por um consumer de cada
+ * vez, então a ordem das mensagens de um mesmo producer é preservada.
+ *
+ * Consumers sem trabalho giram, cedem a CPU e então dormem em um EventCount;
+ * um push só acorda alguém se houver consumer dormindo e a lane estava
+ * vazia ou passou de wake_watermark().
+ *
+ * Mesma interface do MessageBuffer (push, pop, shutdown, size e capacity),
+ * podendo ser usado como LogBuffer em Producer e Consumer.
+ *
+ * @note A lane é devolvida quando a thread termina e pode ser ocupada por
+ * outra; mensagens que ainda estiverem nela são entregues antes das do novo
+ * dono. O número de lanes limita apenas as threads que fazem push() ao
+ * mesmo tempo.
+ *
+ * @tparam T Tipo do registro armazenado (texto formatado, SlabRecord, ...)
+ */
+template<typename T>
+class BasicShardedMessageBuffer {
+public:
+    typedef T value_type;       ///< Tipo do registro armazenado
+
+    /**
+     * @brief Construtor que define número de lanes e capacidade de cada uma
+     * @param lane_count Número máximo de producers simultâneos (uma lane por thread)
+     * @param lane_capacity Capacidade mínima de cada lane, arredondada para potência de dois
+     * @throws std::invalid_argument se lane_count ou lane_capacity for 0
+     */
+    BasicShardedMessageBuffer(size_t lane_count, size_t lane_capacity)
+        : lane_count(lane_count),
+          lanes(),
+          buffer_id(next_buffer_id()),
+          owners(),
+          next_lane(0),
+          is_shutdown(false),
+          wake_threshold(1) {
+        if (lane_count == 0 || lane_capacity == 0) {
+            throw std::invalid_argument("Número e capacidade das lanes devem ser maiores que zero");
+        }
+
+        lanes.reset(new Lane[lane_count]);
+        owners = std::make_shared<LaneOwners>(lane_count);
+        for (size_t i = 0; i < lane_count; ++i) {
+            lanes[i].init(lane_capacity);
+        }
+        wake_threshold = wake_watermark(lanes[0].capacity());
+    }
+
+    ~BasicShardedMessageBuffer() {
+        shutdown();
+    }
+
+    /**
+     * @brief Adiciona mensagem à lane da thread atual (operação de Producer)
+     * @param message Mensagem a ser adicionada
+     * @return true se mensagem foi adicionada, false se buffer foi fechado
+     * @throws std::runtime_error se todas as lanes estiverem com threads ativas
+     *
+     * Aguarda se a lane estiver cheia até haver espaço disponível.
+     */
+    bool push(const T& message) {
+        Lane& lane = lanes[lane_for_current_thread()];
+        Backoff backoff;
+
+        while (!is_shutdown.load(std::memory_order_acquire)) {
+            size_t pos = 0;
+            if (lane.try_push(message, pos)) {
+                wake_consumer(lane, pos);
+                return true;
+            }
+            backoff.pause();
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Adiciona mensagem à lane da thread atual transferindo sua posse
+     * @param message Mensagem a ser movida para o buffer
+     * @return true se mensagem foi adicionada, false se buffer foi fechado
+     * @throws std::runtime_error se todas as lanes estiverem com threads ativas
+     */
+    bool push(T&& message) {
+        Lane& lane = lanes[lane_for_current_thread()];
+        Backoff backoff;
+
+        while (!is_shutdown.load(std::memory_order_acquire)) {
+            size_t pos = 0;
+            if (lane.try_push(std::move(message), pos)) {
+                wake_consumer(lane, pos);
+                return true;
+            }
+            backoff.pause();
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Remove a próxima mensagem de alguma lane (operação de Consumer)
+     * @param message Referência onde mensagem será armazenada
+     * @return true se mensagem foi removida, false se buffer foi fechado
+     *
+     * Aguarda se todas as lanes estiverem vazias. Retorna false apenas se
+     * shutdown() foi chamado e não há mais mensagens.
+     */
+    bool pop(T& message) {
+        Backoff backoff;
+
+        for (;;) {
+            if (try_pop(message)) {
+                return true;
+            }
+
+            // Após shutdown, última varredura para não perder mensagens restantes
+            if (is_shutdown.load(std::memory_order_acquire)) {
+                return try_pop(message);
+            }
+
+            if (!backoff.exhausted()) {
+                backoff.pause();
+                continue;
+            }
+
+            uint32_t key = not_empty.prepare_wait();
+            if (try_pop(message)) {
+                not_empty.cancel_wait();
+                return true;
+            }
+            if (is_shutdown.load(std::memory_order_acquire)) {
+                not_empty.cancel_wait();
+                return try_pop(message);
+            }
+            not_empty.wait(key);
+        }
+    }
+
+    /**
+     * @brief Tenta remover mensagem de alguma lane sem bloquear
+     * @param message Referência onde mensagem será armazenada
+     * @return true se mensagem foi removida, false se nenhuma lane tinha mensagem
+     *
+     * Percorre as lanes a partir do cursor compartilhado; lanes ocupadas por
+     * outro consumer são puladas.
+     */
+    bool try_pop(T& message) {
+        size_t start = next_lane.fetch_add(1, std::memory_order_relaxed);
+
+        for (size_t i = 0; i < lane_count; ++i) {
+            Lane& lane = lanes[(start + i) % lane_count];
+
+            if (!lane.try_claim()) {
+                continue;
+            }
+
+            bool popped = lane.try_pop(message);
+            lane.release();
+
+            if (popped) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Remove várias mensagens de uma vez (operação de Consumer)
+     * @param messages Vetor que recebe as mensagens removidas (é limpo antes)
+     * @param max_messages Número máximo de mensagens a remover
+     * @return Quantidade de mensagens removidas, 0 se buffer foi fechado
+     *
+     * Aguarda até haver ao menos uma mensagem. Cada lane é drenada em bloco
+     * enquanto está reservada, mantendo a ordem de cada producer no lote.
+     */
+    size_t pop_batch(std::vector<T>& messages, size_t max_messages) {
+        messages.clear();
+        if (max_messages == 0) {
+            return 0;
+        }
+
+        Backoff backoff;
+
+        for (;;) {
+            if (try_pop_batch(messages, max_messages) > 0) {
+                return messages.size();
+            }
+
+            // Após shutdown, última varredura para não perder mensagens restantes
+            if (is_shutdown.load(std::memory_order_acquire)) {
+                return try_pop_batch(messages, max_messages);
+            }
+
+            if (!backoff.exhausted()) {
+                backoff.pause();
+                continue;
+            }
+
+            uint32_t key = not_empty.prepare_wait();
+            if (try_pop_batch(messages, max_messages) > 0) {
+                not_empty.cancel_wait();
+                return messages.size();
+            }
+            if (is_shutdown.load(std::memory_order_acquire)) {
+                not_empty.cancel_wait();
+                return try_pop_batch(messages, max_messages);
+            }
+            not_empty.wait(key);
+        }
+    }
+
+    /**
+     * @brief Obtém número aproximado de mensagens somando todas as lanes
+     * @return Quantidade de mensagens armazenadas
+     * @note Esta informação pode mudar imediatamente após o retorno
+     */
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < lane_count; ++i) {
+            total += lanes[i].size();
+        }
+        return total;
+    }
+
+    /**
+     * @brief Obtém capacidade total do buffer
+     * @return Soma das capacidades de todas as lanes
+     */
+    size_t capacity() const {
+        return lane_count * lanes[0].capacity();
+    }
+
+    /**
+     * @brief Inicia processo de shutdown do buffer
+     *
+     * Threads em push() irão retornar false.
+     * Threads em pop() irão processar mensagens restantes e então retornar false.
+     */
+    void shutdown() {
+        is_shutdown.store(true, std::memory_order_release);
+        not_empty.notify_all();
+    }
+
+private:
+    /// Anel SPSC de uma lane, com índices de producer e consumer em linhas de cache separadas
+    struct Lane {
+        std::unique_ptr<T[]> slots;                   ///< Posições pré-alocadas
+        size_t ring_size;                            ///< Número de posições
+        size_t mask;                                 ///< ring_size - 1
+
+        char pad_head[SPD_CACHE_LINE_SIZE];
+        std::atomic<size_t> head;                    ///< Escrito apenas pelo producer
+        size_t cached_tail;                          ///< Cópia local do tail (producer)
+        char pad_tail[SPD_CACHE_LINE_SIZE - 2 * sizeof(size_t)];
+        std::atomic<size_t> tail;                    ///< Escrito apenas pelo consumer atual
+        size_t cached_head;                          ///< Cópia local do head (consumer)
+        std::atomic<bool> consumer_busy;             ///< Exclusão entre consumers
+        char pad_end[SPD_CACHE_LINE_SIZE];
+
+        void init(size_t capacity) {
+            ring_size = 1;
+            while (ring_size < capacity) {
+                ring_size <<= 1;
+            }
+            mask = ring_size - 1;
+            slots.reset(new T[ring_size]);
+
+            head.store(0, std::memory_order_relaxed);
+            tail.store(0, std::memory_order_relaxed);
+            cached_head = 0;
+            cached_tail = 0;
+            consumer_busy.store(false, std::memory_order_relaxed);
+        }
+
+        /// @param pos Recebe a posição escrita
+        template<typename U>
+        bool try_push(U&& message, size_t& pos) {
+            size_t h = head.load(std::memory_order_relaxed);
+
+            if (h - cached_tail >= ring_size) {
+                cached_tail = tail.load(std::memory_order_acquire);
+                if (h - cached_tail >= ring_size) {
+                    return false;
+                }
+            }
+
+            slots[h & mask] = std::forward<U>(message);
+            head.store(h + 1, std::memory_order_release);
+            pos = h;
+            return true;
+        }
+
+        bool try_pop(T& message) {
+            size_t t = tail.load(std::memory_order_relaxed);
+
+            if (t == cached_head) {
+                cached_head = head.load(std::memory_order_acquire);
+                if (t == cached_head) {
+                    return false;
+                }
+            }
+
+            message = std::move(slots[t & mask]);
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_claim() {
+            return !consumer_busy.load(std::memory_order_relaxed) &&
+                   !consumer_busy.exchange(true, std::memory_order_acquire);
+        }
+
+        void release() {
+            consumer_busy.store(false, std::memory_order_release);
+        }
+
+        size_t size() const {
+            size_t t = tail.load(std::memory_order_acquire);
+            size_t h = head.load(std::memory_order_acquire);
+            return h > t ? h - t : 0;
+        }
+
+        size_t capacity() const {
+            return ring_size;
+        }
+    };
+
+    /// Dono de cada lane; compartilhado com as threads, que podem terminar depois do buffer
+    struct LaneOwners {
+        std::unique_ptr<std::atomic<bool>[]> owned;  ///< true enquanto uma thread ocupa a lane
+
+        explicit LaneOwners(size_t lane_count) : owned(new std::atomic<bool>[lane_count]) {
+            for (size_t i = 0; i < lane_count; ++i) {
+                owned[i].store(false, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    /// Lanes ocupadas pela thread, uma por buffer; devolvidas quando a thread termina
+    struct ThreadLanes {
+        struct Entry {
+            uint64_t buffer_id;                      ///< Buffer da lane
+            size_t lane;                             ///< Índice da lane no buffer
+            std::weak_ptr<LaneOwners> owners;        ///< Expira quando o buffer é destruído
+        };
+
+        std::vector<Entry> entries;
+
+        ~ThreadLanes() {
+            for (size_t i = 0; i < entries.size(); ++i) {
+                std::shared_ptr<LaneOwners> owners = entries[i].owners.lock();
+                if (owners) {
+                    // release: o próximo dono vê o head e o cached_tail deixados por esta thread
+                    owners->owned[entries[i].lane].store(false, std::memory_order_release);
+                }
+            }
+        }
+    };
+
+    const size_t lane_count;                         ///< Número de lanes
+    std::unique_ptr<Lane[]> lanes;                   ///< Lanes pré-alocadas
+    const uint64_t buffer_id;                        ///< Identifica o buffer no cache das threads
+
+    std::shared_ptr<LaneOwners> owners;              ///< Lanes ocupadas por threads vivas
+    std::atomic<size_t> next_lane;                   ///< Cursor round-robin dos consumers
+    std::atomic<bool> is_shutdown;                   ///< Flag de shutdown thread-safe
+    EventCount not_empty;                            ///< Onde consumers ociosos dormem
+    size_t wake_threshold;                           ///< Ocupação da lane que acorda mais consumers
+
+    /**
+     * @brief Acorda um consumer após publicar a posição pos da lane, se necessário
+     */
+    void wake_consumer(const Lane& lane, size_t pos) {
+        if (!not_empty.has_waiters()) {
+            return;
+        }
+
+        size_t t = lane.tail.load(std::memory_order_relaxed);
+        if (t >= pos || pos - t + 1 >= wake_threshold) {
+            not_empty.notify_one();
+        }
+    }
+
+    /**
+     * @brief Percorre as lanes uma vez, drenando cada uma em bloco
+     * @return Quantidade de mensagens adicionadas a messages
+     */
+    size_t try_pop_batch(std::vector<T>& messages, size_t max_messages) {
+        size_t start = next_lane.fetch_add(1, std::memory_order_relaxed);
+        size_t before = messages.size();
+        T message;
+
+        for (size_t i = 0; i < lane_count && messages.size() < max_messages; ++i) {
+            Lane& lane = lanes[(start + i) % lane_count];
+
+            if (!lane.try_claim()) {
+                continue;
+            }
+
+            while (messages.size() < max_messages && lane.try_pop(message)) {
+                messages.push_back(std::move(message));
+            }
+            lane.release();
+        }
+
+        return messages.size() - before;
+    }
+
+    /**
+     * @brief Obtém a lane da thread atual, ocupando uma livre se necessário
+     * @return Índice da lane exclusiva da thread
+     * @throws std::runtime_error se todas as lanes estiverem com threads ativas
+     */
+    size_t lane_for_current_thread() {
+        static thread_local ThreadLanes thread_lanes;
+        std::vector<typename ThreadLanes::Entry>& entries = thread_lanes.entries;
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].buffer_id == buffer_id) {
+                return entries[i].lane;
+            }
+        }
+
+        for (size_t lane = 0; lane < lane_count; ++lane) {
+            bool expected = false;
+            if (owners->owned[lane].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                // Aproveita para esquecer buffers já destruídos
+                size_t kept = 0;
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    if (!entries[i].owners.expired()) {
+                        entries[kept++] = entries[i];
+                    }
+                }
+                entries.resize(kept);
+
+                typename ThreadLanes::Entry entry;
+                entry.buffer_id = buffer_id;
+                entry.lane = lane;
+                entry.owners = owners;
+                entries.push_back(entry);
+                return lane;
+            }
+        }
+
+        throw std::runtime_error("Número de producers simultâneos excede o número de lanes do buffer");
+    }
+
+    /// Ids únicos evitam confundir um buffer novo alocado no endereço de outro já destruído
+    static uint64_t next_buffer_id() {
+        static std::atomic<uint64_t> counter(0);
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Desabilita cópia, as lanes não podem ser compartilhadas
+    BasicShardedMessageBuffer(const BasicShardedMessageBuffer&) = delete;
+    BasicShardedMessageBuffer& operator=(const BasicShardedMessageBuffer&) = delete;
+};
+
+/// Buffer particionado de registros já formatados como texto
+typedef BasicShardedMessageBuffer<std::string> ShardedMessageBuffer;
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief Fila FIFO de registros de texto em um arquivo
+ *
+ * Usada pelo MessageBuffer no modo OverflowPolicy::spill(). Cada registro
+ * é gravado como [tamanho uint32 little-endian][bytes]. Quando a leitura
+ * alcança a escrita, o arquivo volta a ser escrito do início, então seu
+ * tamanho fica limitado ao maior acúmulo.
+ *
+ * Os registros são acumulados em memória e gravados em blocos de
+ * BLOCK_BYTES; a leitura também busca um bloco por vez, por um segundo
+ * FILE* só de leitura, então push() e pop() não fazem syscall por registro
+ * nem precisam de fflush para alternar entre escrita e leitura. Até dois
+ * blocos ficam em memória; enquanto não há nada no arquivo, pop() consome
+ * direto do bloco em montagem.
+ *
+ * Não é thread-safe: o MessageBuffer a acessa sob seu próprio mutex.
+ */
+class SpillQueue {
+public:
+    static const size_t BLOCK_BYTES = 64 * 1024;   ///< Tamanho dos blocos gravados e lidos de uma vez
+
+    /**
+     * @param path Arquivo da fila (conteúdo anterior é descartado)
+     * @throws std::runtime_error se não conseguir criar o arquivo
+     */
+    explicit SpillQueue(const std::string& path)
+        : path(path),
+          writer(std::fopen(path.c_str(), "wb")),
+          reader(nullptr),
+          tail_head(0),
+          block_head(0),
+          disk_read(0),
+          disk_end(0),
+          count(0) {
+        if (writer != nullptr) {
+            reader = std::fopen(path.c_str(), "rb");
+        }
+        if (reader == nullptr) {
+            if (writer != nullptr) {
+                std::fclose(writer);
+            }
+            throw std::runtime_error("Não foi possível criar a fila em disco: " + path);
+        }
+
+        // Os blocos já são montados aqui; o buffer do stdio só copiaria de novo
+        std::setvbuf(writer, nullptr, _IONBF, 0);
+        std::setvbuf(reader, nullptr, _IONBF, 0);
+    }
+
+    ~SpillQueue() {
+        std::fclose(reader);
+        std::fclose(writer);
+        std::remove(path.c_str());
+    }
+
+    /**
+     * @brief Acrescenta um registro ao final da fila
+     * @throws std::runtime_error se a gravação do bloco falhar (o registro não entra na fila)
+     */
+    void push(const char* data, size_t size) {
+        size_t mark = tail.size();
+        unsigned char header[4];
+        encode_length(static_cast<uint32_t>(size), header);
+        tail.append(reinterpret_cast<const char*>(header), sizeof(header));
+        tail.append(data, size);
+
+        if (tail.size() - tail_head >= BLOCK_BYTES) {
+            try {
+                write_tail();
+            } catch (...) {
+                tail.resize(mark);
+                throw;
+            }
+        }
+        ++count;
+    }
+
+    /**
+     * @brief Remove o registro mais antigo
+     * @param record Recebe o texto do registro
+     * @return false se a fila estiver vazia
+     * @throws std::runtime_error se a leitura falhar
+     */
+    bool pop(std::string& record) {
+        if (count == 0) {
+            return false;
+        }
+
+        // O que já foi para o arquivo é mais antigo que o bloco em montagem
+        if (block_head < block.size() || disk_read < disk_end) {
+            take_from_disk(record);
+        } else {
+            take(tail, tail_head, record);
+            if (tail_head == tail.size()) {
+                tail.clear();
+                tail_head = 0;
+            }
+        }
+
+        if (--count == 0) {
+            reset();
+        }
+        return true;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+private:
+    std::string path;           ///< Arquivo da fila
+    std::FILE* writer;          ///< Arquivo aberto para gravar os blocos
+    std::FILE* reader;          ///< Mesmo arquivo, aberto só para leitura
+    std::string tail;           ///< Registros mais recentes, ainda não gravados
+    size_t tail_head;           ///< Início do primeiro registro de tail ainda na fila
+    std::string block;          ///< Bytes já lidos do arquivo
+    size_t block_head;          ///< Próximo registro a consumir em block
+    uint64_t disk_read;         ///< Offset do arquivo logo após block
+    uint64_t disk_end;          ///< Fim dos dados gravados no arquivo
+    size_t count;               ///< Registros na fila
+
+    static void encode_length(uint32_t length, unsigned char* header) {
+        for (size_t i = 0; i < 4; ++i) {
+            header[i] = static_cast<unsigned char>((length >> (8 * i)) & 0xFF);
+        }
+    }
+
+    static uint32_t decode_length(const std::string& buffer, size_t offset) {
+        uint32_t length = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            length |= static_cast<uint32_t>(static_cast<unsigned char>(buffer[offset + i])) << (8 * i);
+        }
+        return length;
+    }
+
+    /// Copia o registro em buffer[head] para record e avança head
+    static void take(const std::string& buffer, size_t& head, std::string& record) {
+        uint32_t length = decode_length(buffer, head);
+        record.assign(buffer, head + 4, length);
+        head += 4 + length;
+    }
+
+    /// Grava o bloco em montagem no fim do arquivo
+    void write_tail() {
+        size_t size = tail.size() - tail_head;
+        if (std::fseek(writer, static_cast<long>(disk_end), SEEK_SET) != 0 ||
+            std::fwrite(tail.data() + tail_head, 1, size, writer) != size) {
+            throw std::runtime_error("Falha ao gravar na fila em disco: " + path);
+        }
+
+        disk_end += size;
+        tail.clear();
+        tail_head = 0;
+    }
+
+    void take_from_disk(std::string& record) {
+        fill(4);
+        fill(4 + static_cast<size_t>(decode_length(block, block_head)));
+        take(block, block_head, record);
+
+        // Arquivo todo consumido: o próximo bloco volta a ser gravado no início
+        if (block_head == block.size() && disk_read == disk_end) {
+            block.clear();
+            block_head = 0;
+            disk_read = 0;
+            disk_end = 0;
+        }
+    }
+
+    /// Garante ao menos needed bytes em block a partir de block_head, lendo um bloco do arquivo
+    void fill(size_t needed) {
+        size_t available = block.size() - block_head;
+        if (available >= needed) {
+            return;
+        }
+
+        block.erase(0, block_head);
+        block_head = 0;
+
+        uint64_t want = needed - available < BLOCK_BYTES ? BLOCK_BYTES : needed - available;
+        if (want > disk_end - disk_read) {
+            want = disk_end - disk_read;
+        }
+
+        size_t length = static_cast<size_t>(want);
+        block.resize(available + length);
+        if (available + length < needed ||
+            std::fseek(reader, static_cast<long>(disk_read), SEEK_SET) != 0 ||
+            std::fread(&block[available], 1, length, reader) != length) {
+            throw std::runtime_error("Falha ao ler a fila em disco: " + path);
+        }
+        disk_read += length;
+    }
+
+    /// Fila vazia: volta ao início, sobrescrevendo, para o arquivo não crescer sem limite
+    void reset() {
+        tail.clear();
+        tail_head = 0;
+        block.clear();
+        block_head = 0;
+        disk_read = 0;
+        disk_end = 0;
+    }
+
+    SpillQueue(const SpillQueue&) = delete;
+    SpillQueue& operator=(const SpillQueue&) = delete;
+};
+
+/**
+ * @brief Conversão de registros para a fila em disco
+ *
+ * Especializada para os tipos de registro que podem ser gravados e lidos
+ * de volta; hoje apenas std::string.
+ */
+template<typename T>
+struct SpillCodec {
+    static const bool supported = false;
+
+    static void encode(const T&, std::string&) {}
+    static void decode(std::string&, T&) {}
+};
+
+template<>
+struct SpillCodec<std::string> {
+    static const bool supported = true;
+
+    static void encode(const std::string& record, std::string& text) { text = record; }
+    static void decode(std::string& text, std::string& record) { record.swap(text); }
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+
+#include "log_level.hpp"
+
+/**
+ * @brief Define se e quando o Logger agrupa registros antes de enviá-los ao buffer
+ *
+ * Com o agrupamento ativo, cada thread acumula seus registros em uma área
+ * local e os publica no LogBuffer de uma vez (um único lock no
+ * MessageBuffer) quando qualquer critério é atingido. Exemplo: lotes de 32
+ * registros, nenhum esperando mais que 500 us, e erros publicados na hora:
+ * @code
+ * StagingPolicy::batch(32).with_max_delay(std::chrono::microseconds(500))
+ * @endcode
+ *
+ * O tempo é verificado no próximo log da mesma thread e por
+ * Logger::flush_expired(), que publica os lotes de threads ociosas (o
+ * Producer a chama enquanto espera o próximo envio). Uma thread que para de
+ * logar pode chamar Logger::flush() para publicar o que restou na hora.
+ */
+class StagingPolicy {
+public:
+    /// Cada registro vai direto para o buffer (comportamento original)
+    static StagingPolicy disabled() {
+        return StagingPolicy();
+    }
+
+    /**
+     * @brief Agrupa até records registros por publicação
+     * @throws std::invalid_argument se records for 0
+     */
+    static StagingPolicy batch(size_t records) {
+        if (records == 0) {
+            throw std::invalid_argument("Tamanho do lote deve ser maior que zero");
+        }
+
+        StagingPolicy policy;
+        policy.max_records = records;
+        policy.delay = std::chrono::microseconds(static_cast<long>(DEFAULT_DELAY_MICROS));
+        return policy;
+    }
+
+    /// Tempo máximo que o registro mais antigo do lote pode esperar
+    StagingPolicy with_max_delay(std::chrono::microseconds max_delay) const {
+        StagingPolicy policy(*this);
+        policy.delay = max_delay;
+        return policy;
+    }
+
+    /// Registros deste nível ou acima publicam o lote imediatamente (padrão: ERROR)
+    StagingPolicy with_immediate_level(LogLevel level) const {
+        StagingPolicy policy(*this);
+        policy.immediate_level = level;
+        return policy;
+    }
+
+    bool enabled() const { return max_records > 1; }
+    size_t batch_size() const { return max_records; }
+    std::chrono::microseconds max_delay() const { return delay; }
+
+    /**
+     * @brief Indica se um registro deste nível deve ser publicado sem esperar o lote
+     */
+    bool publishes_immediately(LogLevel level) const {
+        return level >= immediate_level;
+    }
+
+private:
+    static const long DEFAULT_DELAY_MICROS = 1000;  ///< Espera máxima padrão do lote
+
+    size_t max_records;                             ///< Registros por publicação (1 = sem agrupamento)
+    std::chrono::microseconds delay;                ///< Espera máxima do registro mais antigo
+    LogLevel immediate_level;                       ///< Nível que publica na hora
+
+    StagingPolicy() : max_records(1), delay(0), immediate_level(LogLevel::ERROR) {}
+};
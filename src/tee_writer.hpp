@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "log_level.hpp"
+#include "memory_budget.hpp"
+
+/**
+ * @brief Escritor que repassa cada registro a dois escritores
+ * @tparam Primary Escritor principal (ex: FileWriter)
+ * @tparam Secondary Escritor adicional (ex: ConsoleWriter)
+ *
+ * Permite que um mesmo Consumer alimente o arquivo e o console:
+ * @code
+ * TeeWriter<FileWriter, ConsoleWriter> writer(file_writer, console_writer);
+ * Consumer<MessageBuffer, TeeWriter<FileWriter, ConsoleWriter> > consumer(buffer, writer, 1);
+ * @endcode
+ * O primário recebe o lote primeiro; is_open() reflete apenas o primário.
+ * Os escritores não pertencem ao TeeWriter e devem viver mais que ele.
+ */
+template<typename Primary, typename Secondary>
+class TeeWriter {
+public:
+    TeeWriter(Primary& primary, Secondary& secondary) : primary(primary), secondary(secondary) {}
+
+    void append(const std::string& record) {
+        primary.append(record);
+        secondary.append(record);
+    }
+
+    void append(const std::string& record, LogLevel level) {
+        primary.append(record, level);
+        secondary.append(record, level);
+    }
+
+    template<typename Record>
+    void append_batch(const std::vector<Record>& records) {
+        primary.append_batch(records);
+        secondary.append_batch(records);
+    }
+
+    bool is_open() const {
+        return primary.is_open();
+    }
+
+    /// Soma dos buffers internos dos dois escritores (os que informam buffered_bytes())
+    size_t buffered_bytes() const {
+        return memory_budget::writer_bytes(primary) + memory_budget::writer_bytes(secondary);
+    }
+
+    void flush() {
+        primary.flush();
+        secondary.flush();
+    }
+
+    void close() {
+        primary.close();
+        secondary.close();
+    }
+
+private:
+    Primary& primary;           ///< Escritor principal
+    Secondary& secondary;       ///< Escritor adicional
+};
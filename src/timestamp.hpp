@@ -0,0 +1,205 @@
+#pragma once
+
+#include <ctime>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+/**
+ * @brief Fonte do relógio usado para carimbar os logs
+ */
+enum class ClockSource {
+    PRECISE,  ///< std::chrono::system_clock::now()
+    COARSE    ///< CLOCK_REALTIME_COARSE no Linux (resolução de ~1-4 ms, bem mais barato)
+};
+
+/**
+ * @brief Lê o relógio de parede conforme a fonte escolhida
+ * @param source Fonte do relógio
+ * @return Instante atual
+ *
+ * Fora do Linux, COARSE usa o relógio preciso.
+ */
+inline std::chrono::system_clock::time_point clock_now(ClockSource source) {
+#if defined(__linux__) && defined(CLOCK_REALTIME_COARSE)
+    if (source == ClockSource::COARSE) {
+        struct timespec ts;
+        if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) == 0) {
+            return std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                    std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+        }
+    }
+#else
+    (void)source;
+#endif
+
+    return std::chrono::system_clock::now();
+}
+
+/**
+ * @brief Formatador de timestamps ISO 8601 com cache por segundo
+ *
+ * O prefixo "YYYY-MM-DDTHH:MM:SS" só é recalculado (com gmtime_r) quando o
+ * segundo muda; dentro do mesmo segundo apenas os dígitos de milissegundo
+ * são escritos. Cada thread usa sua própria instância via format_cached(),
+ * então não há estado compartilhado.
+ */
+class TimestampCache {
+public:
+    static const size_t SIZE = 24;          ///< "YYYY-MM-DDTHH:MM:SS.mmmZ"
+
+    TimestampCache() : cached_second(INT64_MIN) {}
+
+    /**
+     * @brief Formata um instante em UTC
+     * @param out Destino com pelo menos SIZE bytes
+     * @param time Instante a ser formatado
+     * @return Quantidade de bytes escritos
+     */
+    size_t format(char* out, std::chrono::system_clock::time_point time) {
+        int64_t millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            time.time_since_epoch()).count();
+        int64_t second = millis >= 0 ? millis / 1000 : (millis - 999) / 1000;
+        unsigned ms = static_cast<unsigned>(millis - second * 1000);
+
+        if (second != cached_second) {
+            refresh(second);
+        }
+
+        std::memcpy(out, prefix, PREFIX_SIZE);
+        out[19] = '.';
+        out[20] = static_cast<char>('0' + ms / 100);
+        out[21] = static_cast<char>('0' + ms / 10 % 10);
+        out[22] = static_cast<char>('0' + ms % 10);
+        out[23] = 'Z';
+
+        return SIZE;
+    }
+
+    /**
+     * @brief Formata usando o cache da thread atual
+     * @param out Destino com pelo menos SIZE bytes
+     * @param time Instante a ser formatado
+     * @return Quantidade de bytes escritos
+     */
+    static size_t format_cached(char* out, std::chrono::system_clock::time_point time) {
+        static thread_local TimestampCache cache;
+        return cache.format(out, time);
+    }
+
+private:
+    static const size_t PREFIX_SIZE = 19;   ///< "YYYY-MM-DDTHH:MM:SS"
+
+    int64_t cached_second;                  ///< Segundo (desde a época) do prefixo em cache
+    char prefix[PREFIX_SIZE];               ///< Prefixo formatado
+
+    void refresh(int64_t second) {
+        std::time_t seconds = static_cast<std::time_t>(second);
+        std::tm utc;
+#ifdef _WIN32
+        gmtime_s(&utc, &seconds);
+#else
+        gmtime_r(&seconds, &utc);
+#endif
+
+        write_digits(prefix, static_cast<unsigned>(utc.tm_year + 1900), 4);
+        prefix[4] = '-';
+        write_digits(prefix + 5, static_cast<unsigned>(utc.tm_mon + 1), 2);
+        prefix[7] = '-';
+        write_digits(prefix + 8, static_cast<unsigned>(utc.tm_mday), 2);
+        prefix[10] = 'T';
+        write_digits(prefix + 11, static_cast<unsigned>(utc.tm_hour), 2);
+        prefix[13] = ':';
+        write_digits(prefix + 14, static_cast<unsigned>(utc.tm_min), 2);
+        prefix[16] = ':';
+        write_digits(prefix + 17, static_cast<unsigned>(utc.tm_sec), 2);
+
+        cached_second = second;
+    }
+
+    /// Escreve value com exatamente width dígitos, completando com zeros
+    static void write_digits(char* out, unsigned value, int width) {
+        for (int i = width - 1; i >= 0; --i) {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+};
+
+/**
+ * @brief Extrai o instante de um registro de texto já formatado
+ * @param record Registro em JSON ("timestamp": "...") ou logfmt (ts=...)
+ * @param size Tamanho do registro
+ * @param time Recebe o instante, com precisão de milissegundos
+ * @return false se o campo não existir ou não estiver no formato
+ * "YYYY-MM-DDTHH:MM:SS.mmmZ"
+ *
+ * Contraparte de level_from_text() para quem recebe apenas o texto.
+ */
+inline bool time_from_text(const char* record, size_t size, std::chrono::system_clock::time_point& time) {
+    static const char json_key[] = "\"timestamp\"";
+    static const char logfmt_key[] = "ts=";
+
+    const char* end = record + size;
+    const char* pos = std::search(record, end, json_key, json_key + sizeof(json_key) - 1);
+    if (pos != end) {
+        pos += sizeof(json_key) - 1;
+    } else {
+        pos = std::search(record, end, logfmt_key, logfmt_key + sizeof(logfmt_key) - 1);
+        if (pos == end) {
+            return false;
+        }
+        pos += sizeof(logfmt_key) - 1;
+    }
+
+    while (pos < end && (*pos == ' ' || *pos == ':' || *pos == '"')) {
+        ++pos;
+    }
+    if (static_cast<size_t>(end - pos) < TimestampCache::SIZE) {
+        return false;
+    }
+
+    const char* text = pos;
+    static const char layout[] = "0000-00-00T00:00:00.000Z";
+    int fields[7] = {0, 0, 0, 0, 0, 0, 0};     // ano, mês, dia, hora, minuto, segundo, ms
+    int field = 0;
+    for (size_t i = 0; i < TimestampCache::SIZE; ++i) {
+        if (layout[i] == '0') {
+            if (text[i] < '0' || text[i] > '9') {
+                return false;
+            }
+            fields[field] = fields[field] * 10 + (text[i] - '0');
+        } else if (text[i] != layout[i]) {
+            return false;
+        } else {
+            ++field;
+        }
+    }
+
+    // Dias desde 1970-01-01 no calendário gregoriano (algoritmo "days from civil")
+    int year = fields[1] <= 2 ? fields[0] - 1 : fields[0];
+    int era = (year >= 0 ? year : year - 399) / 400;
+    unsigned year_of_era = static_cast<unsigned>(year - era * 400);
+    unsigned month = static_cast<unsigned>(fields[1] > 2 ? fields[1] - 3 : fields[1] + 9);
+    unsigned day_of_year = (153 * month + 2) / 5 + static_cast<unsigned>(fields[2]) - 1;
+    unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    int64_t days = static_cast<int64_t>(era) * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+
+    int64_t millis = ((days * 24 + fields[3]) * 60 + fields[4]) * 60 * 1000 + fields[5] * 1000 + fields[6];
+    time = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(millis)));
+    return true;
+}
+
+/// Sobrecarga de time_from_text() para std::string
+inline bool time_from_text(const std::string& record, std::chrono::system_clock::time_point& time) {
+    return time_from_text(record.data(), record.size(), time);
+}
@@ -0,0 +1,419 @@
+// Gerador de carga para dimensionar buffer, consumers e escritor antes do deploy.
+//
+// Uso: spd_load [--producers N] [--rate R] [--duration S] [--poisson]
+//               [--burst FATOR:DURACAO_MS:PERIODO_MS]
+//               [--size canned|fixed:N|uniform:MIN:MAX|lognormal:MEDIANA:SIGMA[:MAX]]
+//               [--mix INFO:WARNING:ERROR] [--buffer N] [--overflow block|drop_newest|drop_oldest]
+//               [--consumers N] [--staging N]
+//               [--writer null|file|rotating|commit|tcp:HOST:PORTA|udp:HOST:PORTA] [--output ARQUIVO]
+//               [--budget BYTES] [--fan-out]
+//
+// Cada producer envia R registros/s em malha aberta (o total oferecido é
+// producers x R); a latência de envio é medida a partir do instante
+// previsto de cada envio, então inclui o tempo em que o buffer cheio
+// segurou o producer. Ao final imprime a carga oferecida e a alcançada e
+// as métricas do pipeline no formato do Prometheus. Com --budget, o buffer
+// também fica limitado pela memória do pipeline (MemoryBudget) e o
+// relatório mostra o pico de memória. O escritor rotating divide a saída
+// em segmentos de 64 MiB (RotatingFileWriter), commit dá a cada consumer
+// um buffer próprio gravado por uma thread de commit (CommitFileWriter), e
+// tcp e udp enviam a um coletor pelo NetworkWriter (apenas POSIX). Com
+// --fan-out, um FanOutConsumer substitui os consumers e entrega cada
+// registro ao escritor e a um sink de alertas (só ERROR, lossy) que apenas
+// conta.
+//
+// Ex: 2000 producers a 50 registros/s, rajadas de 4x por 250 ms a cada 2 s:
+//     spd_load --producers 2000 --rate 50 --burst 4:250:2000 --duration 10
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer.hpp"
+#include "commit_file_writer.hpp"
+#include "consumer_pool.hpp"
+#include "drain.hpp"
+#include "fan_out_consumer.hpp"
+#include "file_writer.hpp"
+#include "load_profile.hpp"
+#include "memory_budget.hpp"
+#include "metrics.hpp"
+#include "producer.hpp"
+#include "rotating_file_writer.hpp"
+#if !defined(_WIN32)
+#include "network_writer.hpp"
+#endif
+
+namespace {
+    /// Opções da linha de comando
+    struct LoadConfig {
+        size_t producers;
+        double rate;
+        double duration_seconds;
+        size_t buffer_capacity;
+        std::string overflow;
+        size_t consumers;
+        size_t staging;
+        std::string writer;
+        std::string output;
+        size_t budget_bytes;
+        bool fan_out;
+    };
+
+    /// Escritor que só conta registros e bytes: mede o pipeline sem o disco
+    class NullWriter {
+    public:
+        NullWriter() : records(0), bytes(0) {}
+
+        void append(const std::string& record) {
+            records.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(record.size(), std::memory_order_relaxed);
+        }
+
+        void append(const std::string& record, LogLevel) {
+            append(record);
+        }
+
+        template<typename Record>
+        void append_batch(const std::vector<Record>& batch) {
+            size_t total = 0;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                total += record_size(batch[i]);
+            }
+            records.fetch_add(batch.size(), std::memory_order_relaxed);
+            bytes.fetch_add(total, std::memory_order_relaxed);
+        }
+
+        bool is_open() const { return true; }
+        void flush() {}
+        void close() {}
+
+        const std::string& get_filename() const {
+            static const std::string name = "(null)";
+            return name;
+        }
+
+        uint64_t records_received() const {
+            return records.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<uint64_t> records;      ///< Registros recebidos
+        std::atomic<uint64_t> bytes;        ///< Bytes recebidos
+    };
+
+    void print_usage(const char* program) {
+        std::fprintf(stderr,
+                     "uso: %s [--producers N] [--rate R] [--duration S] [--poisson] [--burst FATOR:MS:PERIODO_MS]\n"
+                     "       [--size canned|fixed:N|uniform:MIN:MAX|lognormal:MEDIANA:SIGMA[:MAX]] [--mix I:W:E]\n"
+                     "       [--buffer N] [--overflow block|drop_newest|drop_oldest] [--consumers N] [--staging N]\n"
+                     "       [--writer null|file|rotating|commit|tcp:HOST:PORTA|udp:HOST:PORTA] [--output ARQUIVO]\n"
+                     "       [--budget BYTES] [--fan-out]\n",
+                     program);
+    }
+
+    /// Divide "a:b:c" em números; false se algum campo não for numérico
+    bool split_numbers(const std::string& text, std::vector<double>& values) {
+        values.clear();
+        size_t begin = 0;
+        for (;;) {
+            size_t end = text.find(':', begin);
+            std::string field = text.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+            char* rest = nullptr;
+            double value = std::strtod(field.c_str(), &rest);
+            if (field.empty() || *rest != '\0') {
+                return false;
+            }
+            values.push_back(value);
+            if (end == std::string::npos) {
+                return true;
+            }
+            begin = end + 1;
+        }
+    }
+
+    bool parse_size(const std::string& text, MessageSizeDistribution& sizes) {
+        std::vector<double> values;
+        if (text == "canned") {
+            sizes = MessageSizeDistribution::canned();
+        } else if (text.compare(0, 6, "fixed:") == 0 && split_numbers(text.substr(6), values) && values.size() == 1) {
+            sizes = MessageSizeDistribution::fixed(static_cast<size_t>(values[0]));
+        } else if (text.compare(0, 8, "uniform:") == 0 && split_numbers(text.substr(8), values) && values.size() == 2) {
+            sizes = MessageSizeDistribution::uniform(static_cast<size_t>(values[0]), static_cast<size_t>(values[1]));
+        } else if (text.compare(0, 10, "lognormal:") == 0 && split_numbers(text.substr(10), values) &&
+                   (values.size() == 2 || values.size() == 3)) {
+            size_t max_bytes = values.size() == 3 ? static_cast<size_t>(values[2]) : 4096;
+            sizes = MessageSizeDistribution::lognormal(static_cast<size_t>(values[0]), values[1], max_bytes);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /// Lê "tcp:HOST:PORTA" ou "udp:HOST:PORTA"; false se não for um coletor de rede
+    bool parse_collector(const std::string& text, std::string& transport, std::string& host, uint16_t& port) {
+        size_t colon = text.rfind(':');
+        if (text.size() < 5 || (text.compare(0, 4, "tcp:") != 0 && text.compare(0, 4, "udp:") != 0) ||
+            colon <= 4 || colon + 1 >= text.size()) {
+            return false;
+        }
+        char* rest = nullptr;
+        unsigned long value = std::strtoul(text.c_str() + colon + 1, &rest, 10);
+        if (*rest != '\0' || value == 0 || value > 65535) {
+            return false;
+        }
+        transport = text.substr(0, 3);
+        host = text.substr(4, colon - 4);
+        port = static_cast<uint16_t>(value);
+        return true;
+    }
+
+    OverflowPolicy parse_overflow(const std::string& text) {
+        if (text == "drop_newest") {
+            return OverflowPolicy::drop_newest();
+        }
+        if (text == "drop_oldest") {
+            return OverflowPolicy::drop_oldest();
+        }
+        return OverflowPolicy::block();
+    }
+
+    template<typename Writer>
+    int run(const LoadConfig& config, const LoadProfile& profile, Writer& writer) {
+        typedef Producer<MessageBuffer, JsonLinesFormatter> LoadProducer;
+
+        std::unique_ptr<MemoryBudget> memory;
+        if (config.budget_bytes > 0) {
+            memory.reset(new MemoryBudget(config.budget_bytes));
+        }
+        MessageBuffer buffer(config.buffer_capacity, parse_overflow(config.overflow), memory.get());
+        MetricsRegistry metrics;
+        StagingPolicy staging = config.staging > 1 ? StagingPolicy::batch(config.staging) : StagingPolicy::disabled();
+
+        std::vector<std::unique_ptr<LoadProducer> > producers;
+        producers.reserve(config.producers);
+        for (size_t i = 0; i < config.producers; ++i) {
+            producers.push_back(std::unique_ptr<LoadProducer>(
+                new LoadProducer(buffer, static_cast<int>(i + 1), staging, &metrics, profile)));
+        }
+
+        typedef ConsumerPool<MessageBuffer, Writer> LoadPool;
+        std::unique_ptr<LoadPool> pool;
+        std::unique_ptr<FanOutConsumer<MessageBuffer> > fan_out;
+        NullWriter alerts;
+        if (config.fan_out) {
+            fan_out.reset(new FanOutConsumer<MessageBuffer>(buffer));
+            fan_out->add_sink(writer);
+            fan_out->add_sink(alerts, SinkOptions::lossy().with_min_level(LogLevel::ERROR));
+            fan_out->start();
+        } else {
+            pool.reset(new LoadPool(buffer, writer, PoolOptions::fixed(config.consumers),
+                                    static_cast<int>(config.producers + 1), &metrics));
+            pool->start();
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < producers.size(); ++i) {
+            producers[i]->start();
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(config.duration_seconds));
+        for (size_t i = 0; i < producers.size(); ++i) {
+            producers[i]->stop();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        DrainReport report = DrainReport();
+        if (pool) {
+            std::vector<LoadPool*> pools(1, pool.get());
+            report = drain_pipeline(buffer, pools, writer, std::chrono::seconds(5));
+        } else {
+            // O FanOutConsumer entrega tudo o que ficou no buffer antes de parar
+            buffer.shutdown();
+            fan_out->stop();
+            writer.flush();
+            report.records_left = buffer.size();
+        }
+
+        uint64_t sent = 0;
+        uint64_t rejected = 0;
+        std::chrono::nanoseconds worst(0);
+        for (size_t i = 0; i < producers.size(); ++i) {
+            sent += producers[i]->records_sent();
+            rejected += producers[i]->records_rejected();
+            if (producers[i]->max_send_latency() > worst) {
+                worst = producers[i]->max_send_latency();
+            }
+        }
+
+        MetricsSnapshot snapshot = metrics.snapshot();
+        const HistogramSummary& send = snapshot.latency(MetricLatency::SEND);
+        std::printf("\n=== Carga ===\n");
+        std::printf("producers                %zu\n", config.producers);
+        std::printf("oferecido (registros/s)  %.0f\n", profile.mean_rate() * static_cast<double>(config.producers));
+        std::printf("enviado (registros/s)    %.0f\n", static_cast<double>(sent) / elapsed);
+        std::printf("recusados                %llu\n", static_cast<unsigned long long>(rejected));
+        if (pool) {
+            // O FanOutConsumer não registra métricas
+            std::printf("gravados                 %llu\n", static_cast<unsigned long long>(snapshot.counter(MetricCounter::RECORDS_WRITTEN)));
+        }
+        std::printf("latência de envio (us)   p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+                    send.p50 / 1e3, send.p99 / 1e3, send.p999 / 1e3, worst.count() / 1e3);
+        std::printf("fila (maior / capacidade) %llu / %zu\n",
+                    static_cast<unsigned long long>(snapshot.queue_high_water), config.buffer_capacity);
+        std::printf("restantes na drenagem    %zu\n", report.records_left);
+        if (fan_out) {
+            std::printf("alertas (registros / lotes pulados) %llu / %llu\n",
+                        static_cast<unsigned long long>(alerts.records_received()),
+                        static_cast<unsigned long long>(fan_out->dropped_batches(1)));
+        }
+        if (memory) {
+            std::printf("memória (pico / limite)  %zu / %zu bytes, %llu vezes acima da marca alta\n",
+                        memory->peak(), memory->limit(), static_cast<unsigned long long>(memory->pressure_events()));
+        }
+        std::printf("\n=== Métricas ===\n%s", metrics::prometheus_text(snapshot).c_str());
+        if (memory) {
+            std::printf("%s", metrics::prometheus_text(*memory).c_str());
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    LoadConfig config;
+    config.producers = 8;
+    config.rate = 1000.0;
+    config.duration_seconds = 5.0;
+    config.buffer_capacity = 4096;
+    config.overflow = "block";
+    config.consumers = 2;
+    config.staging = 1;
+    config.writer = "null";
+    config.output = "spd_load.jsonl";
+    config.budget_bytes = 0;
+    config.fan_out = false;
+
+    try {
+        LoadProfile profile = LoadProfile::open_loop(config.rate);
+        bool poisson = false;
+        std::vector<double> burst;
+        std::vector<double> mix;
+        MessageSizeDistribution sizes = MessageSizeDistribution::canned();
+
+        for (int i = 1; i < argc; ++i) {
+            std::string argument = argv[i];
+            std::string value = i + 1 < argc ? argv[i + 1] : "";
+            bool has_value = true;
+            if (argument == "--producers") {
+                config.producers = static_cast<size_t>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (argument == "--rate") {
+                config.rate = std::strtod(value.c_str(), nullptr);
+            } else if (argument == "--duration") {
+                config.duration_seconds = std::strtod(value.c_str(), nullptr);
+            } else if (argument == "--burst") {
+                if (!split_numbers(value, burst) || burst.size() != 3) {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else if (argument == "--size") {
+                if (!parse_size(value, sizes)) {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else if (argument == "--mix") {
+                if (!split_numbers(value, mix) || mix.size() != 3) {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else if (argument == "--buffer") {
+                config.buffer_capacity = static_cast<size_t>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (argument == "--overflow") {
+                config.overflow = value;
+            } else if (argument == "--consumers") {
+                config.consumers = static_cast<size_t>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (argument == "--staging") {
+                config.staging = static_cast<size_t>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (argument == "--writer") {
+                config.writer = value;
+            } else if (argument == "--output") {
+                config.output = value;
+            } else if (argument == "--budget") {
+                config.budget_bytes = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+            } else if (argument == "--poisson") {
+                poisson = true;
+                has_value = false;
+            } else if (argument == "--fan-out") {
+                config.fan_out = true;
+                has_value = false;
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+            if (has_value && ++i >= argc) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        std::string transport;
+        std::string host;
+        uint16_t port = 0;
+        bool network = parse_collector(config.writer, transport, host, port);
+        if (config.producers == 0 || config.consumers == 0 || config.duration_seconds <= 0 ||
+            (config.writer != "null" && config.writer != "file" && config.writer != "rotating" &&
+             config.writer != "commit" && !network)) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        profile = LoadProfile::open_loop(config.rate).with_message_size(sizes);
+        if (poisson) {
+            profile = profile.with_poisson_arrivals();
+        }
+        if (!burst.empty()) {
+            profile = profile.with_burst(burst[0], std::chrono::milliseconds(static_cast<long>(burst[1])),
+                                         std::chrono::milliseconds(static_cast<long>(burst[2])));
+        }
+        if (!mix.empty()) {
+            profile = profile.with_level_mix(static_cast<unsigned>(mix[0]), static_cast<unsigned>(mix[1]),
+                                             static_cast<unsigned>(mix[2]));
+        }
+
+        if (config.writer == "file") {
+            FileWriter writer(config.output, FlushPolicy::every_bytes(1024 * 1024));
+            return run(config, profile, writer);
+        }
+        if (config.writer == "rotating") {
+            RotatingFileWriter writer(config.output, RotationPolicy::by_size(64 * 1024 * 1024),
+                                      FlushPolicy::every_bytes(1024 * 1024));
+            return run(config, profile, writer);
+        }
+        if (config.writer == "commit") {
+            CommitFileWriter writer(config.output);
+            return run(config, profile, writer);
+        }
+        if (network) {
+#if !defined(_WIN32)
+            NetworkWriter writer(transport == "tcp" ? NetworkOptions::tcp(host, port) : NetworkOptions::udp(host, port));
+            int status = run(config, profile, writer);
+            writer.close();
+            std::printf("rede (frames / descartados / reconexões) %llu / %llu / %llu\n",
+                        static_cast<unsigned long long>(writer.frames_sent()),
+                        static_cast<unsigned long long>(writer.dropped_records()),
+                        static_cast<unsigned long long>(writer.reconnects()));
+            return status;
+#else
+            std::fprintf(stderr, "Erro: NetworkWriter disponível apenas em sistemas POSIX\n");
+            return 1;
+#endif
+        }
+        NullWriter writer;
+        return run(config, profile, writer);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Erro: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,148 @@
+// Consulta logs gravados pelo IndexedFileWriter usando o índice "<arquivo>.lidx".
+//
+// Uso: spd_query <arquivo> [--level INFO|WARNING|ERROR] [--producer N]
+//                [--last 30s|5m|2h|1d] [--since INSTANTE] [--until INSTANTE]
+//                [--count] [--stats]
+//
+// INSTANTE no formato dos registros, em UTC: 2025-08-31T16:32:01.123Z
+// (os milissegundos podem ser omitidos). Os registros encontrados são
+// impressos como estão no arquivo; --count imprime apenas a quantidade e
+// --stats mostra, em stderr, quantos blocos e bytes a consulta precisou ler.
+//
+// Ex: erros do producer 3 nos últimos 5 minutos:
+//     spd_query logs.jsonl --level ERROR --producer 3 --last 5m
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+#include "indexed_log_reader.hpp"
+
+namespace {
+    void print_usage(const char* program) {
+        std::fprintf(stderr,
+                     "uso: %s <arquivo> [--level INFO|WARNING|ERROR] [--producer N] [--last 30s|5m|2h|1d]\n"
+                     "       [--since INSTANTE] [--until INSTANTE] [--count] [--stats]\n",
+                     program);
+    }
+
+    bool parse_level(const std::string& text, LogLevel& level) {
+        if (text == "INFO") {
+            level = LogLevel::INFO;
+        } else if (text == "WARNING") {
+            level = LogLevel::WARNING;
+        } else if (text == "ERROR") {
+            level = LogLevel::ERROR;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /// "30s", "5m", "2h", "1d" ou apenas segundos
+    bool parse_period(const std::string& text, std::chrono::seconds& period) {
+        char* rest = nullptr;
+        long value = std::strtol(text.c_str(), &rest, 10);
+        if (rest == text.c_str() || value < 0) {
+            return false;
+        }
+        long scale = 1;
+        if (*rest == 'm') {
+            scale = 60;
+        } else if (*rest == 'h') {
+            scale = 3600;
+        } else if (*rest == 'd') {
+            scale = 86400;
+        } else if (*rest != 's' && *rest != '\0') {
+            return false;
+        }
+        if (*rest != '\0' && rest[1] != '\0') {
+            return false;
+        }
+        period = std::chrono::seconds(value * scale);
+        return true;
+    }
+
+    /// Instante no formato dos registros, com ou sem milissegundos
+    bool parse_instant(std::string text, std::chrono::system_clock::time_point& time) {
+        if (text.size() == TimestampCache::SIZE - 4 && text[text.size() - 1] == 'Z') {
+            text.insert(text.size() - 1, ".000");
+        }
+        return time_from_text("ts=" + text, time);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    LogQuery filter = LogQuery::all();
+    bool count_only = false;
+    bool show_stats = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string option = argv[i];
+        bool has_value = i + 1 < argc;
+        std::string value = has_value ? argv[i + 1] : "";
+
+        if (option == "--count") {
+            count_only = true;
+            continue;
+        }
+        if (option == "--stats") {
+            show_stats = true;
+            continue;
+        }
+        if (!has_value) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        ++i;
+
+        LogLevel level;
+        std::chrono::seconds period;
+        std::chrono::system_clock::time_point time;
+        if (option == "--level" && parse_level(value, level)) {
+            filter = filter.with_min_level(level);
+        } else if (option == "--producer") {
+            filter = filter.with_producer(std::atoi(value.c_str()));
+        } else if (option == "--last" && parse_period(value, period)) {
+            filter = filter.with_last(period);
+        } else if (option == "--since" && parse_instant(value, time)) {
+            filter = filter.with_since(time);
+        } else if (option == "--until" && parse_instant(value, time)) {
+            filter = filter.with_until(time);
+        } else {
+            std::fprintf(stderr, "opção inválida: %s %s\n", option.c_str(), value.c_str());
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        IndexedLogReader reader(argv[1]);
+        QueryStats stats = reader.query(filter, [count_only](const char* record, size_t size) {
+            if (!count_only) {
+                std::fwrite(record, 1, size, stdout);
+            }
+        });
+
+        if (count_only) {
+            std::printf("%llu\n", static_cast<unsigned long long>(stats.records_matched));
+        }
+        if (show_stats) {
+            std::fprintf(stderr, "%llu registros; %zu de %zu blocos lidos; %llu de %zu bytes examinados\n",
+                         static_cast<unsigned long long>(stats.records_matched), stats.blocks_read,
+                         stats.blocks_total, static_cast<unsigned long long>(stats.bytes_read), reader.file_size());
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
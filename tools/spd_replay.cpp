@@ -0,0 +1,111 @@
+// Converte um log binário do BinaryFileWriter de volta para texto.
+//
+// Uso: spd_replay <arquivo.spdb> [saida] [--format jsonl|pretty|logfmt]
+//
+// Sem saída, escreve em stdout. O padrão é JSON Lines, igual ao que o
+// JsonLinesFormatter gravaria. Um frame truncado no final do arquivo
+// (processo interrompido durante a escrita) é avisado em stderr; os
+// registros anteriores a ele são convertidos normalmente.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "binary_log.hpp"
+#include "formatter.hpp"
+
+namespace {
+    static const size_t IO_BUFFER_SIZE = 1024 * 1024;  ///< Buffer de leitura e de cada escrita
+
+    void print_usage(const char* program) {
+        std::fprintf(stderr, "uso: %s <arquivo.spdb> [saida] [--format jsonl|pretty|logfmt]\n", program);
+    }
+
+    /// Formata todos os registros; a saída é gravada em blocos de IO_BUFFER_SIZE
+    template<typename Formatter>
+    unsigned long long replay(binary_log::Reader& reader, std::FILE* output) {
+        std::string text;
+        text.reserve(IO_BUFFER_SIZE + 4096);
+
+        unsigned long long records = 0;
+        binary_log::RawRecord record;
+        while (reader.next(record)) {
+            Formatter::format(text, binary_log::from_nanos(record.time), record.level, record.producer_id,
+                              record.message, record.message_size);
+            ++records;
+            if (text.size() >= IO_BUFFER_SIZE) {
+                std::fwrite(text.data(), 1, text.size(), output);
+                text.clear();
+            }
+        }
+        std::fwrite(text.data(), 1, text.size(), output);
+        return records;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string input_path;
+    std::string output_path;
+    std::string format = "jsonl";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (input_path.empty()) {
+            input_path = argument;
+        } else if (output_path.empty()) {
+            output_path = argument;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (input_path.empty() || (format != "jsonl" && format != "pretty" && format != "logfmt")) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<char> input_buffer(IO_BUFFER_SIZE);
+    std::ifstream input;
+    input.rdbuf()->pubsetbuf(input_buffer.data(), static_cast<std::streamsize>(input_buffer.size()));
+    input.open(input_path, std::ios::binary);
+    if (!input.is_open()) {
+        std::fprintf(stderr, "Não foi possível abrir o arquivo de log: %s\n", input_path.c_str());
+        return 1;
+    }
+
+    binary_log::Reader reader(input);
+    if (!reader.is_valid()) {
+        std::fprintf(stderr, "Arquivo não está no formato binário: %s\n", input_path.c_str());
+        return 1;
+    }
+
+    std::FILE* output = stdout;
+    if (!output_path.empty()) {
+        output = std::fopen(output_path.c_str(), "wb");
+        if (output == nullptr) {
+            std::fprintf(stderr, "Não foi possível criar a saída: %s\n", output_path.c_str());
+            return 1;
+        }
+    }
+
+    unsigned long long records = 0;
+    if (format == "pretty") {
+        records = replay<PrettyJsonFormatter>(reader, output);
+    } else if (format == "logfmt") {
+        records = replay<LogfmtFormatter>(reader, output);
+    } else {
+        records = replay<JsonLinesFormatter>(reader, output);
+    }
+
+    if (output != stdout) {
+        std::fclose(output);
+    }
+    if (reader.truncated()) {
+        std::fprintf(stderr, "Aviso: último frame incompleto; %llu registros convertidos\n", records);
+    }
+    return 0;
+}